@@ -371,6 +371,13 @@ void FileItemWidget::setData(const QModelIndex &index, const QStyleOptionViewIte
     }
 }
 
+QVector<int> FileItemWidget::dataRoles() const
+{
+    // roles that setData() reads - delegate cache is addressed by them
+    return QVector<int>() << Qt::DisplayRole << Qt::DecorationRole << QtFileListModel::FileStatusRole
+                          << QtFileListModel::FileSizeRole << QtFileListModel::FileTypeRole;
+}
+
 void FileItemWidget::updateProgress()
 {
     previewLabel->updateProgress();
@@ -51,6 +51,7 @@ public:
     explicit FileItemWidget(bool isStatic, QWidget* parent = Q_NULLPTR);
 
     void setData(const QModelIndex& index, const QStyleOptionViewItem &option) Q_DECL_OVERRIDE;
+    QVector<int> dataRoles() const Q_DECL_OVERRIDE;
 
     void updateProgress();
 
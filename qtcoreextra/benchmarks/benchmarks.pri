@@ -0,0 +1,31 @@
+# Common settings of QtCoreExtra benchmarks, TARGET
+# must be specified before including this file
+
+QT       += core testlib
+QT       -= gui
+
+TEMPLATE = app
+CONFIG += debug_and_release
+CONFIG += c++14 console
+CONFIG -= app_bundle
+
+CONFIG(debug, debug|release) {
+        TARGET = $${TARGET}d
+        MOC_DIR	    = tmp/debug_shared/moc
+        OBJECTS_DIR = tmp/debug_shared/obj
+        LIBS += -L$$PWD/../../libs -lqtcoreextrad
+} else {
+        MOC_DIR	    = tmp/release_shared/moc
+        OBJECTS_DIR = tmp/release_shared/obj
+        LIBS += -L$$PWD/../../libs -lqtcoreextra
+}
+
+DEFINES += QT_DEPRECATED_WARNINGS QTCOREEXTRA_DLL
+
+INCLUDEPATH += \
+    $$PWD/../include \
+    $$PWD/shared
+
+DEPENDPATH += \
+    $$PWD/../include \
+    $$PWD/shared
@@ -0,0 +1,22 @@
+#####################################################################
+# QtCoreExtra benchmarks
+#
+# Every benchmark is a QTest application, measured with QBENCHMARK.
+# Results may be written in machine-readable form using QTest
+# output options, e.g.:
+#
+#   bench_memorypool -o memorypool.csv,csv
+#   bench_objectmapper -o objectmapper.xml,xml
+#
+# Use -tickcounter or -perf (Linux) for more precise measurements
+# and -minimumvalue / -iterations to control number of runs.
+#####################################################################
+
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    memorypool \
+    objectmapper \
+    methodinvoker \
+    jsonsettings \
+    jsonstream
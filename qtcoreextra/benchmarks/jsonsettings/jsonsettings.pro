@@ -0,0 +1,6 @@
+TARGET = bench_jsonsettings
+
+include(../benchmarks.pri)
+
+SOURCES += \
+    tst_bench_jsonsettings.cpp
@@ -0,0 +1,133 @@
+#include <QtTest>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <QtJsonSettingsFormat>
+
+namespace
+{
+
+/*
+ * Settings map with \a count keys spread over groups
+ * of 10 keys and values of mixed types
+ */
+QSettings::SettingsMap createMap(int count)
+{
+    QSettings::SettingsMap map;
+    for (int i = 0; i < count; i++)
+    {
+        const QString key = QString("group%1/key%2").arg(i / 10).arg(i % 10);
+        switch (i % 3) {
+        case 0:
+            map.insert(key, i);
+            break;
+        case 1:
+            map.insert(key, QString::number(i));
+            break;
+        default:
+            map.insert(key, (i & 1) != 0);
+            break;
+        }
+    }
+    return map;
+}
+
+}
+
+class tst_BenchJsonSettings : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanup();
+
+    void read_data();
+    void read();
+    void write_data();
+    void write();
+
+private:
+    void keyCounts();
+
+    QTemporaryDir tempDir;
+};
+
+void tst_BenchJsonSettings::initTestCase()
+{
+    QVERIFY(tempDir.isValid());
+}
+
+void tst_BenchJsonSettings::cleanup()
+{
+    QtJsonSettingsFormat::setCachingEnabled(false);
+}
+
+void tst_BenchJsonSettings::keyCounts()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<bool>("cached");
+
+    static const int counts[] = { 10, 100, 1000 };
+    for (int count : counts) {
+        const QByteArray tag = QByteArray::number(count);
+        QTest::newRow(tag + " uncached") << count << false;
+        QTest::newRow(tag + " cached") << count << true;
+    }
+}
+
+void tst_BenchJsonSettings::read_data()
+{
+    keyCounts();
+}
+
+void tst_BenchJsonSettings::read()
+{
+    QFETCH(int, count);
+    QFETCH(bool, cached);
+
+    // cache is keyed by file name, so real file is used
+    QFile file(tempDir.path() + QString("/read%1.json").arg(count));
+    QVERIFY(file.open(QIODevice::ReadWrite | QIODevice::Truncate));
+    QVERIFY(QtJsonSettingsFormat::write(file, createMap(count)));
+
+    QtJsonSettingsFormat::setCachingEnabled(cached);
+    QSettings::SettingsMap map;
+    QBENCHMARK {
+        map.clear();
+        file.seek(0);
+        QtJsonSettingsFormat::read(file, map);
+    }
+    QCOMPARE(map.size(), count);
+}
+
+void tst_BenchJsonSettings::write_data()
+{
+    keyCounts();
+}
+
+void tst_BenchJsonSettings::write()
+{
+    QFETCH(int, count);
+    QFETCH(bool, cached);
+
+    QFile file(tempDir.path() + QString("/write%1.json").arg(count));
+    QVERIFY(file.open(QIODevice::ReadWrite | QIODevice::Truncate));
+
+    QtJsonSettingsFormat::setCachingEnabled(cached);
+    QSettings::SettingsMap map = createMap(count);
+    const QString key = map.firstKey();
+    int value = 0;
+    QBENCHMARK {
+        // typical QSettings::sync(): single value was changed
+        map[key] = ++value;
+        file.seek(0);
+        file.resize(0);
+        QtJsonSettingsFormat::write(file, map);
+    }
+    QVERIFY(file.size() > 0);
+}
+
+QTEST_GUILESS_MAIN(tst_BenchJsonSettings)
+
+#include "tst_bench_jsonsettings.moc"
@@ -0,0 +1,11 @@
+TARGET = bench_jsonstream
+
+include(../benchmarks.pri)
+
+win32: LIBS += -lpsapi
+
+SOURCES += \
+    tst_bench_jsonstream.cpp
+
+HEADERS += \
+    ../shared/properties.h
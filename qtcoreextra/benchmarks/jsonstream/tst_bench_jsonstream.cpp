@@ -0,0 +1,281 @@
+#include <QtTest>
+#include <QFile>
+#include <QProcess>
+#include <QTemporaryDir>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonDocument>
+
+#include <QtJsonMapper>
+#include <QtJsonStream>
+
+#include <cstdio>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#endif
+
+#include "properties.h"
+
+namespace
+{
+
+enum { MemoryObjectCount = 20000 };
+
+QList<QObject*> createObjects(int count, QObject* parent)
+{
+    QList<QObject*> objects;
+    objects.reserve(count);
+    for (int i = 0; i < count; i++) {
+        Properties50* object = new Properties50(parent);
+        object->fill(i);
+        objects << object;
+    }
+    return objects;
+}
+
+bool writeDom(const QList<QObject*>& objects, QIODevice* device)
+{
+    QtJsonMapper mapper;
+    QJsonArray array;
+    for (auto it = objects.cbegin(); it != objects.cend(); ++it) {
+        QJsonObject json;
+        if (!mapper.serialize(json, *it))
+            return false;
+        array.append(json);
+    }
+    return (device->write(QJsonDocument(array).toJson(QJsonDocument::Compact)) >= 0);
+}
+
+bool writeStream(const QList<QObject*>& objects, QIODevice* device)
+{
+    QtJsonMapper mapper;
+    QtJsonStreamWriter writer(&mapper, device);
+    writer.write(objects.cbegin(), objects.cend());
+    return writer.finish();
+}
+
+qint64 readDom(QIODevice* device, QObject* object)
+{
+    QtJsonMapper mapper;
+    const QJsonArray array = QJsonDocument::fromJson(device->readAll()).array();
+    qint64 n = 0;
+    for (auto it = array.constBegin(); it != array.constEnd(); ++it, ++n) {
+        if (!mapper.unserialize((*it).toObject(), object))
+            return -1;
+    }
+    return n;
+}
+
+qint64 readStream(QIODevice* device, QObject* object)
+{
+    QtJsonMapper mapper;
+    QtJsonStreamReader reader(&mapper, device);
+    qint64 n = 0;
+    while (reader.readNext(object))
+        ++n;
+    return (reader.hasError() ? -1 : n);
+}
+
+/*
+ * Peak resident set size of current process in bytes
+ */
+qint64 peakResidentSize()
+{
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return -1;
+    return static_cast<qint64>(counters.PeakWorkingSetSize);
+#elif defined(Q_OS_UNIX)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return -1;
+#if defined(Q_OS_MAC)
+    return static_cast<qint64>(usage.ru_maxrss); // bytes
+#else
+    return static_cast<qint64>(usage.ru_maxrss) * 1024; // kilobytes
+#endif
+#else
+    return -1;
+#endif
+}
+
+const char* const memoryModeVariable = "BENCH_JSONSTREAM_MODE";
+const char* const memoryFileVariable = "BENCH_JSONSTREAM_FILE";
+
+/*
+ * Peak memory is never decreased within process, so every
+ * mode is measured in separate child process that prints
+ * growth of peak RSS caused by single operation
+ */
+int measureMemory(const QByteArray& mode, const QString& fileName)
+{
+    QObject parent;
+    QList<QObject*> objects;
+    if (mode.endsWith("write"))
+        objects = createObjects(MemoryObjectCount, &parent);
+    Properties50 target;
+
+    QFile file(fileName);
+    if (!file.open(mode.endsWith("write") ? QIODevice::WriteOnly : QIODevice::ReadOnly))
+        return 1;
+
+    const qint64 base = peakResidentSize();
+    bool ok = false;
+    if (mode == "dom-write")
+        ok = writeDom(objects, &file);
+    else if (mode == "stream-write")
+        ok = writeStream(objects, &file);
+    else if (mode == "dom-read")
+        ok = (readDom(&file, &target) == MemoryObjectCount);
+    else if (mode == "stream-read")
+        ok = (readStream(&file, &target) == MemoryObjectCount);
+
+    if (!ok || base < 0)
+        return 1;
+    std::printf("%lld\n", static_cast<long long>(peakResidentSize() - base));
+    return 0;
+}
+
+}
+
+class tst_BenchJsonStream : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void write_data();
+    void write();
+    void read_data();
+    void read();
+    void peakMemory_data();
+    void peakMemory();
+
+private:
+    void modes();
+    QString inputFile(int count) const;
+
+    QTemporaryDir tempDir;
+};
+
+void tst_BenchJsonStream::initTestCase()
+{
+    QVERIFY(tempDir.isValid());
+
+    // input of read benchmarks
+    static const int counts[] = { 1000, 10000, MemoryObjectCount };
+    for (int count : counts) {
+        QObject parent;
+        QFile file(inputFile(count));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QVERIFY(writeStream(createObjects(count, &parent), &file));
+    }
+}
+
+QString tst_BenchJsonStream::inputFile(int count) const
+{
+    return tempDir.path() + QString("/input%1.json").arg(count);
+}
+
+void tst_BenchJsonStream::modes()
+{
+    QTest::addColumn<bool>("streaming");
+    QTest::addColumn<int>("count");
+
+    static const int counts[] = { 1000, 10000 };
+    for (int count : counts) {
+        const QByteArray tag = QByteArray::number(count);
+        QTest::newRow("dom " + tag) << false << count;
+        QTest::newRow("stream " + tag) << true << count;
+    }
+}
+
+void tst_BenchJsonStream::write_data()
+{
+    modes();
+}
+
+void tst_BenchJsonStream::write()
+{
+    QFETCH(bool, streaming);
+    QFETCH(int, count);
+
+    QObject parent;
+    const QList<QObject*> objects = createObjects(count, &parent);
+    QFile file(tempDir.path() + "/output.json");
+    QBENCHMARK {
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        QVERIFY(streaming ? writeStream(objects, &file) : writeDom(objects, &file));
+        file.close();
+    }
+}
+
+void tst_BenchJsonStream::read_data()
+{
+    modes();
+}
+
+void tst_BenchJsonStream::read()
+{
+    QFETCH(bool, streaming);
+    QFETCH(int, count);
+
+    Properties50 target;
+    QFile file(inputFile(count));
+    qint64 n = 0;
+    QBENCHMARK {
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        n = (streaming ? readStream(&file, &target) : readDom(&file, &target));
+        file.close();
+    }
+    QCOMPARE(n, qint64(count));
+}
+
+void tst_BenchJsonStream::peakMemory_data()
+{
+    QTest::addColumn<QString>("mode");
+    QTest::newRow("dom write") << "dom-write";
+    QTest::newRow("stream write") << "stream-write";
+    QTest::newRow("dom read") << "dom-read";
+    QTest::newRow("stream read") << "stream-read";
+}
+
+void tst_BenchJsonStream::peakMemory()
+{
+    QFETCH(QString, mode);
+
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    env.insert(memoryModeVariable, mode);
+    env.insert(memoryFileVariable, mode.endsWith("write") ? tempDir.path() + "/output.json" : inputFile(MemoryObjectCount));
+
+    QProcess process;
+    process.setProcessEnvironment(env);
+    process.start(QCoreApplication::applicationFilePath(), QStringList());
+    QVERIFY(process.waitForFinished(-1));
+    if (process.exitCode() != 0)
+        QSKIP("peak memory is not available on this platform");
+
+    bool ok = false;
+    const qint64 bytes = process.readAllStandardOutput().trimmed().toLongLong(&ok);
+    QVERIFY(ok);
+    QTest::setBenchmarkResult(bytes, QTest::BytesAllocated);
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const QByteArray mode = qgetenv(memoryModeVariable);
+    if (!mode.isEmpty())
+        return measureMemory(mode, QString::fromLocal8Bit(qgetenv(memoryFileVariable)));
+
+    tst_BenchJsonStream test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "tst_bench_jsonstream.moc"
@@ -0,0 +1,6 @@
+TARGET = bench_memorypool
+
+include(../benchmarks.pri)
+
+SOURCES += \
+    tst_bench_memorypool.cpp
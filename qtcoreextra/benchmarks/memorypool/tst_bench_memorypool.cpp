@@ -0,0 +1,319 @@
+#include <QtTest>
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QMutex>
+
+#include <QtMemoryPool>
+
+namespace
+{
+
+struct Block
+{
+    char data[64];
+};
+
+enum {
+    BatchSize = 1024,       // blocks held at once
+    ThreadIterations = 64,  // batches per thread
+    ContentionOps = 100000  // pop/push pairs per thread
+};
+
+enum Policy {
+    HeapPolicy,
+    NoLockPolicy,
+    SpinLockPolicy,
+    MutexPolicy,
+    LockFreePolicy,
+    MagazinePolicy,
+    SlabPolicy
+};
+
+/*
+ * Baseline: every block is allocated and freed by global heap
+ */
+struct HeapPool
+{
+    inline Block* pop() { return Q_NULLPTR; }
+    inline void push(Block* block) { delete block; }
+};
+
+/*
+ * QtSlabPool adapted to push()/pop() interface of free lists
+ */
+template<class _Mutex>
+struct SlabPool
+{
+    inline Block* pop() { return pool.allocate(); }
+    inline void push(Block* block) { pool.deallocate(block); }
+
+    QtSlabPool<Block, _Mutex> pool;
+};
+
+/*
+ * Allocate batch of blocks from pool (or heap if pool is empty)
+ * and return them back
+ */
+template<class _Pool>
+inline void allocateBatch(_Pool& pool, Block** blocks)
+{
+    for (int i = 0; i < BatchSize; i++) {
+        Block* block = pool.pop();
+        blocks[i] = (block != Q_NULLPTR ? block : new Block);
+        blocks[i]->data[0] = char(i);
+    }
+    for (int i = 0; i < BatchSize; i++)
+        pool.push(blocks[i]);
+}
+
+template<class _Pool>
+void runSingle()
+{
+    _Pool pool;
+    QVector<Block*> blocks(BatchSize);
+    allocateBatch(pool, blocks.data()); // warm up free list
+    QBENCHMARK {
+        allocateBatch(pool, blocks.data());
+    }
+}
+
+template<class _Pool, class _Cache>
+class BatchRunnable :
+        public QRunnable
+{
+public:
+    explicit BatchRunnable(_Pool& p) : pool(p) {}
+
+    void run() Q_DECL_OVERRIDE {
+        _Cache cache(pool);
+        QVector<Block*> blocks(BatchSize);
+        for (int i = 0; i < ThreadIterations; i++)
+            allocateBatch(cache, blocks.data());
+    }
+
+private:
+    _Pool& pool;
+};
+
+/*
+ * Shared pool accessed directly by worker
+ */
+template<class _Pool>
+struct DirectAccess
+{
+    explicit DirectAccess(_Pool& p) : pool(p) {}
+    inline Block* pop() { return pool.pop(); }
+    inline void push(Block* block) { pool.push(block); }
+    _Pool& pool;
+};
+
+/*
+ * Worst case for shared free list: every operation takes
+ * single block and returns it back immediately, so all
+ * threads fight for the head of the list all the time
+ */
+template<class _Pool, class _Cache>
+class ContentionRunnable :
+        public QRunnable
+{
+public:
+    ContentionRunnable(_Pool& p, QAtomicInt& s) : pool(p), started(s) {}
+
+    void run() Q_DECL_OVERRIDE {
+        _Cache cache(pool);
+        // start all threads at once
+        started.deref();
+        while (started.load() > 0)
+            QThread::yieldCurrentThread();
+        for (int i = 0; i < ContentionOps; i++) {
+            Block* block = cache.pop();
+            if (block == Q_NULLPTR)
+                block = new Block;
+            block->data[0] = char(i);
+            cache.push(block);
+        }
+    }
+
+private:
+    _Pool& pool;
+    QAtomicInt& started;
+};
+
+template<class _Pool, class _Cache>
+void runContention(int threadCount)
+{
+    _Pool pool;
+    QThreadPool threads;
+    threads.setMaxThreadCount(threadCount);
+    QAtomicInt started;
+    QBENCHMARK {
+        started.store(threadCount);
+        for (int i = 0; i < threadCount; i++)
+            threads.start(new ContentionRunnable<_Pool, _Cache>(pool, started));
+        threads.waitForDone();
+    }
+}
+
+template<class _Pool, class _Cache>
+void runMulti(int threadCount)
+{
+    _Pool pool;
+    QThreadPool threads;
+    threads.setMaxThreadCount(threadCount);
+    QBENCHMARK {
+        for (int i = 0; i < threadCount; i++)
+            threads.start(new BatchRunnable<_Pool, _Cache>(pool));
+        threads.waitForDone();
+    }
+}
+
+}
+
+Q_DECLARE_METATYPE(Policy)
+
+class tst_BenchMemoryPool : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void singleThreaded_data();
+    void singleThreaded();
+    void multiThreaded_data();
+    void multiThreaded();
+    void contention_data();
+    void contention();
+};
+
+void tst_BenchMemoryPool::singleThreaded_data()
+{
+    QTest::addColumn<Policy>("policy");
+    QTest::newRow("new/delete") << HeapPolicy;
+    QTest::newRow("QtMemoryPool<void>") << NoLockPolicy;
+    QTest::newRow("QtMemoryPool<QtSpinLock>") << SpinLockPolicy;
+    QTest::newRow("QtMemoryPool<QMutex>") << MutexPolicy;
+    QTest::newRow("QtMemoryPool<QtLockFree>") << LockFreePolicy;
+    QTest::newRow("QtSlabPool<void>") << SlabPolicy;
+}
+
+void tst_BenchMemoryPool::singleThreaded()
+{
+    QFETCH(Policy, policy);
+    switch (policy) {
+    case HeapPolicy:
+        runSingle<HeapPool>();
+        break;
+    case NoLockPolicy:
+        runSingle< QtMemoryPool<Block> >();
+        break;
+    case SpinLockPolicy:
+        runSingle< QtMemoryPool<Block, QtSpinLock> >();
+        break;
+    case MutexPolicy:
+        runSingle< QtMemoryPool<Block, QMutex> >();
+        break;
+    case LockFreePolicy:
+        runSingle< QtMemoryPool<Block, QtLockFree> >();
+        break;
+    case SlabPolicy:
+        runSingle< SlabPool<void> >();
+        break;
+    default:
+        QSKIP("policy is not supported in single thread");
+    }
+}
+
+void tst_BenchMemoryPool::multiThreaded_data()
+{
+    QTest::addColumn<Policy>("policy");
+    QTest::addColumn<int>("threads");
+
+    static const int threadCounts[] = { 1, 2, 4, 8 };
+    for (int threads : threadCounts) {
+        const QByteArray suffix = " x" + QByteArray::number(threads);
+        QTest::newRow("new/delete" + suffix) << HeapPolicy << threads;
+        QTest::newRow("QtMemoryPool<QtSpinLock>" + suffix) << SpinLockPolicy << threads;
+        QTest::newRow("QtMemoryPool<QMutex>" + suffix) << MutexPolicy << threads;
+        QTest::newRow("QtMemoryPool<QtLockFree>" + suffix) << LockFreePolicy << threads;
+        QTest::newRow("QtMemoryPoolMagazine" + suffix) << MagazinePolicy << threads;
+        QTest::newRow("QtSlabPool<QMutex>" + suffix) << SlabPolicy << threads;
+    }
+}
+
+void tst_BenchMemoryPool::multiThreaded()
+{
+    QFETCH(Policy, policy);
+    QFETCH(int, threads);
+
+    typedef QtMemoryPool<Block, QtSpinLock> SpinLockPool;
+    typedef QtMemoryPool<Block, QMutex> MutexPool;
+    typedef QtMemoryPool<Block, QtLockFree> LockFreePool;
+
+    switch (policy) {
+    case HeapPolicy:
+        runMulti< HeapPool, DirectAccess<HeapPool> >(threads);
+        break;
+    case SpinLockPolicy:
+        runMulti< SpinLockPool, DirectAccess<SpinLockPool> >(threads);
+        break;
+    case MutexPolicy:
+        runMulti< MutexPool, DirectAccess<MutexPool> >(threads);
+        break;
+    case LockFreePolicy:
+        runMulti< LockFreePool, DirectAccess<LockFreePool> >(threads);
+        break;
+    case MagazinePolicy:
+        runMulti< LockFreePool, QtMemoryPoolMagazine<Block> >(threads);
+        break;
+    case SlabPolicy:
+        runMulti< SlabPool<QMutex>, DirectAccess< SlabPool<QMutex> > >(threads);
+        break;
+    default:
+        QSKIP("policy is not supported in multiple threads");
+    }
+}
+
+void tst_BenchMemoryPool::contention_data()
+{
+    QTest::addColumn<Policy>("policy");
+    QTest::addColumn<int>("threads");
+
+    for (int threads = 1; threads <= 64; threads *= 2) {
+        const QByteArray suffix = " x" + QByteArray::number(threads);
+        QTest::newRow("QtMemoryPool<QtSpinLock>" + suffix) << SpinLockPolicy << threads;
+        QTest::newRow("QtMemoryPool<QMutex>" + suffix) << MutexPolicy << threads;
+        QTest::newRow("QtMemoryPool<QtLockFree>" + suffix) << LockFreePolicy << threads;
+        QTest::newRow("QtMemoryPoolMagazine" + suffix) << MagazinePolicy << threads;
+    }
+}
+
+void tst_BenchMemoryPool::contention()
+{
+    QFETCH(Policy, policy);
+    QFETCH(int, threads);
+
+    typedef QtMemoryPool<Block, QtSpinLock> SpinLockPool;
+    typedef QtMemoryPool<Block, QMutex> MutexPool;
+    typedef QtMemoryPool<Block, QtLockFree> LockFreePool;
+
+    switch (policy) {
+    case SpinLockPolicy:
+        runContention< SpinLockPool, DirectAccess<SpinLockPool> >(threads);
+        break;
+    case MutexPolicy:
+        runContention< MutexPool, DirectAccess<MutexPool> >(threads);
+        break;
+    case LockFreePolicy:
+        runContention< LockFreePool, DirectAccess<LockFreePool> >(threads);
+        break;
+    case MagazinePolicy:
+        runContention< LockFreePool, QtMemoryPoolMagazine<Block> >(threads);
+        break;
+    default:
+        QSKIP("policy is not compared under contention");
+    }
+}
+
+QTEST_GUILESS_MAIN(tst_BenchMemoryPool)
+
+#include "tst_bench_memorypool.moc"
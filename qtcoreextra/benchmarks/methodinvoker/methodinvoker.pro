@@ -0,0 +1,6 @@
+TARGET = bench_methodinvoker
+
+include(../benchmarks.pri)
+
+SOURCES += \
+    tst_bench_methodinvoker.cpp
@@ -0,0 +1,129 @@
+#include <QtTest>
+
+#include <QtMethodInvoker>
+
+class Calculator : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("sum", "sum")
+    Q_CLASSINFO("concat", "concat")
+    Q_CLASSINFO("touch", "touch")
+
+public:
+    explicit Calculator(QObject* parent = Q_NULLPTR) :
+        QObject(parent), touched(0) {
+    }
+
+    Q_INVOKABLE int sum(int a, int b) { return a + b; }
+    Q_INVOKABLE QString concat(const QString& a, const QString& b) { return a + b; }
+    Q_INVOKABLE void touch() { ++touched; }
+
+    int touched;
+};
+
+class tst_BenchMethodInvoker : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void metaObjectInvoke();
+    void variantInvoke_data();
+    void variantInvoke();
+    void genericInvoke();
+    void handleInvoke_data();
+    void handleInvoke();
+    void handleArgvInvoke();
+};
+
+void tst_BenchMethodInvoker::metaObjectInvoke()
+{
+    // baseline: method is found by name on every call
+    Calculator calculator;
+    int result = 0;
+    QBENCHMARK {
+        QMetaObject::invokeMethod(&calculator, "sum", Qt::DirectConnection,
+                                  Q_RETURN_ARG(int, result), Q_ARG(int, 1), Q_ARG(int, 2));
+    }
+    QCOMPARE(result, 3);
+}
+
+void tst_BenchMethodInvoker::variantInvoke_data()
+{
+    QTest::addColumn<QString>("key");
+    QTest::addColumn<QVariantList>("args");
+    QTest::addColumn<QVariant>("expected");
+
+    QTest::newRow("sum") << "sum" << (QVariantList() << 1 << 2) << QVariant(3);
+    QTest::newRow("concat") << "concat" << (QVariantList() << QString("a") << QString("b")) << QVariant(QString("ab"));
+    QTest::newRow("touch") << "touch" << QVariantList() << QVariant();
+}
+
+void tst_BenchMethodInvoker::variantInvoke()
+{
+    QFETCH(QString, key);
+    QFETCH(QVariantList, args);
+    QFETCH(QVariant, expected);
+
+    Calculator calculator;
+    QtMethodInvoker invoker(&Calculator::staticMetaObject);
+    QVariant result;
+    QBENCHMARK {
+        invoker.invoke(&calculator, key, args, result);
+    }
+    if (expected.isValid())
+        QCOMPARE(result, expected);
+}
+
+void tst_BenchMethodInvoker::genericInvoke()
+{
+    Calculator calculator;
+    QtMethodInvoker invoker(&Calculator::staticMetaObject);
+    int result = 0;
+    QBENCHMARK {
+        invoker.invoke(&calculator, "sum", Q_RETURN_ARG(int, result), Q_ARG(int, 1), Q_ARG(int, 2));
+    }
+    QCOMPARE(result, 3);
+}
+
+void tst_BenchMethodInvoker::handleInvoke_data()
+{
+    variantInvoke_data();
+}
+
+void tst_BenchMethodInvoker::handleInvoke()
+{
+    QFETCH(QString, key);
+    QFETCH(QVariantList, args);
+    QFETCH(QVariant, expected);
+
+    // same calls as variantInvoke, but key is resolved once
+    Calculator calculator;
+    QtMethodInvoker invoker(&Calculator::staticMetaObject);
+    const QtMethodInvoker::Handle handle = invoker.handle(key);
+    QVERIFY(handle.isValid());
+    QVariant result;
+    QBENCHMARK {
+        handle.invoke(&calculator, args, result);
+    }
+    if (expected.isValid())
+        QCOMPARE(result, expected);
+}
+
+void tst_BenchMethodInvoker::handleArgvInvoke()
+{
+    // pre-typed arguments: no QVariant checks at all
+    Calculator calculator;
+    QtMethodInvoker invoker(&Calculator::staticMetaObject);
+    const QtMethodInvoker::Handle handle = invoker.handle("sum");
+    QVERIFY(handle.isValid());
+    int a = 1, b = 2, result = 0;
+    void* argv[] = { &result, &a, &b };
+    QBENCHMARK {
+        handle.invoke(&calculator, argv);
+    }
+    QCOMPARE(result, 3);
+}
+
+QTEST_GUILESS_MAIN(tst_BenchMethodInvoker)
+
+#include "tst_bench_methodinvoker.moc"
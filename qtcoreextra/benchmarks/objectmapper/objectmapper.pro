@@ -0,0 +1,9 @@
+TARGET = bench_objectmapper
+
+include(../benchmarks.pri)
+
+SOURCES += \
+    tst_bench_objectmapper.cpp
+
+HEADERS += \
+    ../shared/properties.h
@@ -0,0 +1,273 @@
+#include <QtTest>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QXmlStreamWriter>
+#include <QXmlStreamReader>
+#include <QSettings>
+#include <QTemporaryDir>
+
+#include <QtJsonMapper>
+#include <QtXmlMapper>
+#include <QtSettingsMapper>
+#include <QtCborMapper>
+
+#include "properties.h"
+
+namespace
+{
+
+template<class T>
+QObject* createFilled(int seed)
+{
+    T* object = new T;
+    object->fill(seed);
+    return object;
+}
+
+/*
+ * Create object with \a count properties (plus objectName),
+ * if \a seed is zero object holds default values
+ */
+QObject* createObject(int count, int seed)
+{
+    switch (count) {
+    case 10:
+        return createFilled<Properties10>(seed);
+    case 50:
+        return createFilled<Properties50>(seed);
+    case 100:
+        return createFilled<Properties100>(seed);
+    case 200:
+        return createFilled<Properties200>(seed);
+    default:
+        break;
+    }
+    return Q_NULLPTR;
+}
+
+template<class _Mapper>
+void benchmarkJson(int count)
+{
+    QScopedPointer<QObject> source(createObject(count, 1));
+    QScopedPointer<QObject> target(createObject(count, 0));
+
+    _Mapper mapper;
+    QBENCHMARK {
+        QJsonObject json;
+        mapper.serialize(json, source.data());
+        const QByteArray data = QJsonDocument(json).toJson(QJsonDocument::Compact);
+        mapper.unserialize(QJsonDocument::fromJson(data).object(), target.data());
+    }
+    QCOMPARE(target->property("p000"), source->property("p000"));
+}
+
+QByteArray encodeJson(const QObject* object, bool typed)
+{
+    QJsonObject json;
+    if (typed)
+        QtTypedJsonMapper().serialize(json, object);
+    else
+        QtJsonMapper().serialize(json, object);
+    return QJsonDocument(json).toJson(QJsonDocument::Compact);
+}
+
+QByteArray encodeXml(const QObject* object)
+{
+    QByteArray data;
+    QXmlStreamWriter writer(&data);
+    writer.writeStartDocument();
+    QtXmlMapper().write(writer, object);
+    writer.writeEndDocument();
+    return data;
+}
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+QByteArray encodeCbor(const QObject* object)
+{
+    QByteArray data;
+    QtCborWriter writer(&data);
+    QtCborMapper().serialize(writer, object);
+    return data;
+}
+#endif
+
+}
+
+class tst_BenchObjectMapper : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void jsonRoundTrip_data();
+    void jsonRoundTrip();
+    void typedJsonRoundTrip_data();
+    void typedJsonRoundTrip();
+    void xmlRoundTrip_data();
+    void xmlRoundTrip();
+    void settingsRoundTrip_data();
+    void settingsRoundTrip();
+    void cborRoundTrip_data();
+    void cborRoundTrip();
+    void encodedSize_data();
+    void encodedSize();
+
+private:
+    void propertyCounts();
+
+    QTemporaryDir tempDir;
+};
+
+void tst_BenchObjectMapper::initTestCase()
+{
+    QVERIFY(tempDir.isValid());
+}
+
+void tst_BenchObjectMapper::propertyCounts()
+{
+    QTest::addColumn<int>("count");
+    QTest::newRow("10") << 10;
+    QTest::newRow("50") << 50;
+    QTest::newRow("100") << 100;
+    QTest::newRow("200") << 200;
+}
+
+void tst_BenchObjectMapper::jsonRoundTrip_data()
+{
+    propertyCounts();
+}
+
+void tst_BenchObjectMapper::jsonRoundTrip()
+{
+    QFETCH(int, count);
+    benchmarkJson<QtJsonMapper>(count);
+}
+
+void tst_BenchObjectMapper::typedJsonRoundTrip_data()
+{
+    propertyCounts();
+}
+
+void tst_BenchObjectMapper::typedJsonRoundTrip()
+{
+    QFETCH(int, count);
+    benchmarkJson<QtTypedJsonMapper>(count);
+}
+
+void tst_BenchObjectMapper::xmlRoundTrip_data()
+{
+    propertyCounts();
+}
+
+void tst_BenchObjectMapper::xmlRoundTrip()
+{
+    QFETCH(int, count);
+    QScopedPointer<QObject> source(createObject(count, 1));
+    QScopedPointer<QObject> target(createObject(count, 0));
+
+    QtXmlMapper mapper;
+    QBENCHMARK {
+        QByteArray data;
+        QXmlStreamWriter writer(&data);
+        writer.writeStartDocument();
+        mapper.write(writer, source.data());
+        writer.writeEndDocument();
+
+        QXmlStreamReader reader(data);
+        mapper.read(reader, target.data());
+    }
+    QCOMPARE(target->property("p000"), source->property("p000"));
+}
+
+void tst_BenchObjectMapper::settingsRoundTrip_data()
+{
+    propertyCounts();
+}
+
+void tst_BenchObjectMapper::settingsRoundTrip()
+{
+    QFETCH(int, count);
+    QScopedPointer<QObject> source(createObject(count, 1));
+    QScopedPointer<QObject> target(createObject(count, 0));
+
+    // settings are not synced inside of the loop:
+    // only mapping itself is measured, not file I/O
+    QSettings settings(tempDir.path() + QString("/settings%1.ini").arg(count), QSettings::IniFormat);
+    QtSettingsMapper mapper;
+    QBENCHMARK {
+        mapper.serialize(settings, source.data());
+        mapper.unserialize(settings, target.data());
+    }
+    QCOMPARE(target->property("p000"), source->property("p000"));
+}
+
+void tst_BenchObjectMapper::cborRoundTrip_data()
+{
+    propertyCounts();
+}
+
+void tst_BenchObjectMapper::cborRoundTrip()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+    QFETCH(int, count);
+    QScopedPointer<QObject> source(createObject(count, 1));
+    QScopedPointer<QObject> target(createObject(count, 0));
+
+    QtCborMapper mapper;
+    QBENCHMARK {
+        QByteArray data;
+        {
+            QtCborWriter writer(&data);
+            mapper.serialize(writer, source.data());
+        }
+        QtCborReader reader(data);
+        mapper.unserialize(reader, target.data());
+    }
+    QCOMPARE(target->property("p000"), source->property("p000"));
+#else
+    QSKIP("QtCborMapper requires Qt 5.12");
+#endif
+}
+
+void tst_BenchObjectMapper::encodedSize_data()
+{
+    QTest::addColumn<QString>("format");
+    QTest::addColumn<int>("count");
+
+    static const char* const formats[] = { "json", "typed json", "xml", "cbor" };
+    static const int counts[] = { 10, 50, 100, 200 };
+    for (const char* format : formats) {
+        for (int count : counts)
+            QTest::newRow(QByteArray(format) + ' ' + QByteArray::number(count)) << QString(format) << count;
+    }
+}
+
+void tst_BenchObjectMapper::encodedSize()
+{
+    QFETCH(QString, format);
+    QFETCH(int, count);
+    QScopedPointer<QObject> source(createObject(count, 1));
+
+    QByteArray data;
+    if (format == "json") {
+        data = encodeJson(source.data(), false);
+    } else if (format == "typed json") {
+        data = encodeJson(source.data(), true);
+    } else if (format == "xml") {
+        data = encodeXml(source.data());
+    } else {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+        data = encodeCbor(source.data());
+#else
+        QSKIP("QtCborMapper requires Qt 5.12");
+#endif
+    }
+    QVERIFY(!data.isEmpty());
+    // size of encoded object in bytes, not a timing
+    QTest::setBenchmarkResult(data.size(), QTest::BytesAllocated);
+}
+
+QTEST_GUILESS_MAIN(tst_BenchObjectMapper)
+
+#include "tst_bench_objectmapper.moc"
@@ -0,0 +1,704 @@
+#ifndef BENCHMARK_PROPERTIES_H
+#define BENCHMARK_PROPERTIES_H
+
+#include <QObject>
+#include <QString>
+
+/*
+ * Objects with 10, 50, 100 and 200 properties of mixed
+ * types (int, double, QString, bool) for mapper benchmarks.
+ * Every class adds properties to its base class, so mapper
+ * walks whole class hierarchy as it does for real objects.
+ */
+
+class Properties10 :
+        public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int p000 MEMBER p000)
+    Q_PROPERTY(double p001 MEMBER p001)
+    Q_PROPERTY(QString p002 MEMBER p002)
+    Q_PROPERTY(bool p003 MEMBER p003)
+    Q_PROPERTY(int p004 MEMBER p004)
+    Q_PROPERTY(double p005 MEMBER p005)
+    Q_PROPERTY(QString p006 MEMBER p006)
+    Q_PROPERTY(bool p007 MEMBER p007)
+    Q_PROPERTY(int p008 MEMBER p008)
+    Q_PROPERTY(double p009 MEMBER p009)
+
+public:
+    explicit Properties10(QObject* parent = Q_NULLPTR) :
+        QObject(parent),
+        p000(0), p001(0.0), p003(false), p004(0), p005(0.0), p007(false),
+        p008(0), p009(0.0) {
+    }
+
+    void fill(int seed) {
+        p000 = seed + 0;
+        p001 = (seed + 1) * 0.5;
+        p002 = QString::number(seed + 2);
+        p003 = ((seed + 3) & 1) != 0;
+        p004 = seed + 4;
+        p005 = (seed + 5) * 0.5;
+        p006 = QString::number(seed + 6);
+        p007 = ((seed + 7) & 1) != 0;
+        p008 = seed + 8;
+        p009 = (seed + 9) * 0.5;
+    }
+
+    int p000;
+    double p001;
+    QString p002;
+    bool p003;
+    int p004;
+    double p005;
+    QString p006;
+    bool p007;
+    int p008;
+    double p009;
+};
+
+class Properties50 :
+        public Properties10
+{
+    Q_OBJECT
+    Q_PROPERTY(QString p010 MEMBER p010)
+    Q_PROPERTY(bool p011 MEMBER p011)
+    Q_PROPERTY(int p012 MEMBER p012)
+    Q_PROPERTY(double p013 MEMBER p013)
+    Q_PROPERTY(QString p014 MEMBER p014)
+    Q_PROPERTY(bool p015 MEMBER p015)
+    Q_PROPERTY(int p016 MEMBER p016)
+    Q_PROPERTY(double p017 MEMBER p017)
+    Q_PROPERTY(QString p018 MEMBER p018)
+    Q_PROPERTY(bool p019 MEMBER p019)
+    Q_PROPERTY(int p020 MEMBER p020)
+    Q_PROPERTY(double p021 MEMBER p021)
+    Q_PROPERTY(QString p022 MEMBER p022)
+    Q_PROPERTY(bool p023 MEMBER p023)
+    Q_PROPERTY(int p024 MEMBER p024)
+    Q_PROPERTY(double p025 MEMBER p025)
+    Q_PROPERTY(QString p026 MEMBER p026)
+    Q_PROPERTY(bool p027 MEMBER p027)
+    Q_PROPERTY(int p028 MEMBER p028)
+    Q_PROPERTY(double p029 MEMBER p029)
+    Q_PROPERTY(QString p030 MEMBER p030)
+    Q_PROPERTY(bool p031 MEMBER p031)
+    Q_PROPERTY(int p032 MEMBER p032)
+    Q_PROPERTY(double p033 MEMBER p033)
+    Q_PROPERTY(QString p034 MEMBER p034)
+    Q_PROPERTY(bool p035 MEMBER p035)
+    Q_PROPERTY(int p036 MEMBER p036)
+    Q_PROPERTY(double p037 MEMBER p037)
+    Q_PROPERTY(QString p038 MEMBER p038)
+    Q_PROPERTY(bool p039 MEMBER p039)
+    Q_PROPERTY(int p040 MEMBER p040)
+    Q_PROPERTY(double p041 MEMBER p041)
+    Q_PROPERTY(QString p042 MEMBER p042)
+    Q_PROPERTY(bool p043 MEMBER p043)
+    Q_PROPERTY(int p044 MEMBER p044)
+    Q_PROPERTY(double p045 MEMBER p045)
+    Q_PROPERTY(QString p046 MEMBER p046)
+    Q_PROPERTY(bool p047 MEMBER p047)
+    Q_PROPERTY(int p048 MEMBER p048)
+    Q_PROPERTY(double p049 MEMBER p049)
+
+public:
+    explicit Properties50(QObject* parent = Q_NULLPTR) :
+        Properties10(parent),
+        p011(false), p012(0), p013(0.0), p015(false), p016(0), p017(0.0),
+        p019(false), p020(0), p021(0.0), p023(false), p024(0), p025(0.0),
+        p027(false), p028(0), p029(0.0), p031(false), p032(0), p033(0.0),
+        p035(false), p036(0), p037(0.0), p039(false), p040(0), p041(0.0),
+        p043(false), p044(0), p045(0.0), p047(false), p048(0), p049(0.0) {
+    }
+
+    void fill(int seed) {
+        Properties10::fill(seed);
+        p010 = QString::number(seed + 10);
+        p011 = ((seed + 11) & 1) != 0;
+        p012 = seed + 12;
+        p013 = (seed + 13) * 0.5;
+        p014 = QString::number(seed + 14);
+        p015 = ((seed + 15) & 1) != 0;
+        p016 = seed + 16;
+        p017 = (seed + 17) * 0.5;
+        p018 = QString::number(seed + 18);
+        p019 = ((seed + 19) & 1) != 0;
+        p020 = seed + 20;
+        p021 = (seed + 21) * 0.5;
+        p022 = QString::number(seed + 22);
+        p023 = ((seed + 23) & 1) != 0;
+        p024 = seed + 24;
+        p025 = (seed + 25) * 0.5;
+        p026 = QString::number(seed + 26);
+        p027 = ((seed + 27) & 1) != 0;
+        p028 = seed + 28;
+        p029 = (seed + 29) * 0.5;
+        p030 = QString::number(seed + 30);
+        p031 = ((seed + 31) & 1) != 0;
+        p032 = seed + 32;
+        p033 = (seed + 33) * 0.5;
+        p034 = QString::number(seed + 34);
+        p035 = ((seed + 35) & 1) != 0;
+        p036 = seed + 36;
+        p037 = (seed + 37) * 0.5;
+        p038 = QString::number(seed + 38);
+        p039 = ((seed + 39) & 1) != 0;
+        p040 = seed + 40;
+        p041 = (seed + 41) * 0.5;
+        p042 = QString::number(seed + 42);
+        p043 = ((seed + 43) & 1) != 0;
+        p044 = seed + 44;
+        p045 = (seed + 45) * 0.5;
+        p046 = QString::number(seed + 46);
+        p047 = ((seed + 47) & 1) != 0;
+        p048 = seed + 48;
+        p049 = (seed + 49) * 0.5;
+    }
+
+    QString p010;
+    bool p011;
+    int p012;
+    double p013;
+    QString p014;
+    bool p015;
+    int p016;
+    double p017;
+    QString p018;
+    bool p019;
+    int p020;
+    double p021;
+    QString p022;
+    bool p023;
+    int p024;
+    double p025;
+    QString p026;
+    bool p027;
+    int p028;
+    double p029;
+    QString p030;
+    bool p031;
+    int p032;
+    double p033;
+    QString p034;
+    bool p035;
+    int p036;
+    double p037;
+    QString p038;
+    bool p039;
+    int p040;
+    double p041;
+    QString p042;
+    bool p043;
+    int p044;
+    double p045;
+    QString p046;
+    bool p047;
+    int p048;
+    double p049;
+};
+
+class Properties100 :
+        public Properties50
+{
+    Q_OBJECT
+    Q_PROPERTY(QString p050 MEMBER p050)
+    Q_PROPERTY(bool p051 MEMBER p051)
+    Q_PROPERTY(int p052 MEMBER p052)
+    Q_PROPERTY(double p053 MEMBER p053)
+    Q_PROPERTY(QString p054 MEMBER p054)
+    Q_PROPERTY(bool p055 MEMBER p055)
+    Q_PROPERTY(int p056 MEMBER p056)
+    Q_PROPERTY(double p057 MEMBER p057)
+    Q_PROPERTY(QString p058 MEMBER p058)
+    Q_PROPERTY(bool p059 MEMBER p059)
+    Q_PROPERTY(int p060 MEMBER p060)
+    Q_PROPERTY(double p061 MEMBER p061)
+    Q_PROPERTY(QString p062 MEMBER p062)
+    Q_PROPERTY(bool p063 MEMBER p063)
+    Q_PROPERTY(int p064 MEMBER p064)
+    Q_PROPERTY(double p065 MEMBER p065)
+    Q_PROPERTY(QString p066 MEMBER p066)
+    Q_PROPERTY(bool p067 MEMBER p067)
+    Q_PROPERTY(int p068 MEMBER p068)
+    Q_PROPERTY(double p069 MEMBER p069)
+    Q_PROPERTY(QString p070 MEMBER p070)
+    Q_PROPERTY(bool p071 MEMBER p071)
+    Q_PROPERTY(int p072 MEMBER p072)
+    Q_PROPERTY(double p073 MEMBER p073)
+    Q_PROPERTY(QString p074 MEMBER p074)
+    Q_PROPERTY(bool p075 MEMBER p075)
+    Q_PROPERTY(int p076 MEMBER p076)
+    Q_PROPERTY(double p077 MEMBER p077)
+    Q_PROPERTY(QString p078 MEMBER p078)
+    Q_PROPERTY(bool p079 MEMBER p079)
+    Q_PROPERTY(int p080 MEMBER p080)
+    Q_PROPERTY(double p081 MEMBER p081)
+    Q_PROPERTY(QString p082 MEMBER p082)
+    Q_PROPERTY(bool p083 MEMBER p083)
+    Q_PROPERTY(int p084 MEMBER p084)
+    Q_PROPERTY(double p085 MEMBER p085)
+    Q_PROPERTY(QString p086 MEMBER p086)
+    Q_PROPERTY(bool p087 MEMBER p087)
+    Q_PROPERTY(int p088 MEMBER p088)
+    Q_PROPERTY(double p089 MEMBER p089)
+    Q_PROPERTY(QString p090 MEMBER p090)
+    Q_PROPERTY(bool p091 MEMBER p091)
+    Q_PROPERTY(int p092 MEMBER p092)
+    Q_PROPERTY(double p093 MEMBER p093)
+    Q_PROPERTY(QString p094 MEMBER p094)
+    Q_PROPERTY(bool p095 MEMBER p095)
+    Q_PROPERTY(int p096 MEMBER p096)
+    Q_PROPERTY(double p097 MEMBER p097)
+    Q_PROPERTY(QString p098 MEMBER p098)
+    Q_PROPERTY(bool p099 MEMBER p099)
+
+public:
+    explicit Properties100(QObject* parent = Q_NULLPTR) :
+        Properties50(parent),
+        p051(false), p052(0), p053(0.0), p055(false), p056(0), p057(0.0),
+        p059(false), p060(0), p061(0.0), p063(false), p064(0), p065(0.0),
+        p067(false), p068(0), p069(0.0), p071(false), p072(0), p073(0.0),
+        p075(false), p076(0), p077(0.0), p079(false), p080(0), p081(0.0),
+        p083(false), p084(0), p085(0.0), p087(false), p088(0), p089(0.0),
+        p091(false), p092(0), p093(0.0), p095(false), p096(0), p097(0.0),
+        p099(false) {
+    }
+
+    void fill(int seed) {
+        Properties50::fill(seed);
+        p050 = QString::number(seed + 50);
+        p051 = ((seed + 51) & 1) != 0;
+        p052 = seed + 52;
+        p053 = (seed + 53) * 0.5;
+        p054 = QString::number(seed + 54);
+        p055 = ((seed + 55) & 1) != 0;
+        p056 = seed + 56;
+        p057 = (seed + 57) * 0.5;
+        p058 = QString::number(seed + 58);
+        p059 = ((seed + 59) & 1) != 0;
+        p060 = seed + 60;
+        p061 = (seed + 61) * 0.5;
+        p062 = QString::number(seed + 62);
+        p063 = ((seed + 63) & 1) != 0;
+        p064 = seed + 64;
+        p065 = (seed + 65) * 0.5;
+        p066 = QString::number(seed + 66);
+        p067 = ((seed + 67) & 1) != 0;
+        p068 = seed + 68;
+        p069 = (seed + 69) * 0.5;
+        p070 = QString::number(seed + 70);
+        p071 = ((seed + 71) & 1) != 0;
+        p072 = seed + 72;
+        p073 = (seed + 73) * 0.5;
+        p074 = QString::number(seed + 74);
+        p075 = ((seed + 75) & 1) != 0;
+        p076 = seed + 76;
+        p077 = (seed + 77) * 0.5;
+        p078 = QString::number(seed + 78);
+        p079 = ((seed + 79) & 1) != 0;
+        p080 = seed + 80;
+        p081 = (seed + 81) * 0.5;
+        p082 = QString::number(seed + 82);
+        p083 = ((seed + 83) & 1) != 0;
+        p084 = seed + 84;
+        p085 = (seed + 85) * 0.5;
+        p086 = QString::number(seed + 86);
+        p087 = ((seed + 87) & 1) != 0;
+        p088 = seed + 88;
+        p089 = (seed + 89) * 0.5;
+        p090 = QString::number(seed + 90);
+        p091 = ((seed + 91) & 1) != 0;
+        p092 = seed + 92;
+        p093 = (seed + 93) * 0.5;
+        p094 = QString::number(seed + 94);
+        p095 = ((seed + 95) & 1) != 0;
+        p096 = seed + 96;
+        p097 = (seed + 97) * 0.5;
+        p098 = QString::number(seed + 98);
+        p099 = ((seed + 99) & 1) != 0;
+    }
+
+    QString p050;
+    bool p051;
+    int p052;
+    double p053;
+    QString p054;
+    bool p055;
+    int p056;
+    double p057;
+    QString p058;
+    bool p059;
+    int p060;
+    double p061;
+    QString p062;
+    bool p063;
+    int p064;
+    double p065;
+    QString p066;
+    bool p067;
+    int p068;
+    double p069;
+    QString p070;
+    bool p071;
+    int p072;
+    double p073;
+    QString p074;
+    bool p075;
+    int p076;
+    double p077;
+    QString p078;
+    bool p079;
+    int p080;
+    double p081;
+    QString p082;
+    bool p083;
+    int p084;
+    double p085;
+    QString p086;
+    bool p087;
+    int p088;
+    double p089;
+    QString p090;
+    bool p091;
+    int p092;
+    double p093;
+    QString p094;
+    bool p095;
+    int p096;
+    double p097;
+    QString p098;
+    bool p099;
+};
+
+class Properties200 :
+        public Properties100
+{
+    Q_OBJECT
+    Q_PROPERTY(int p100 MEMBER p100)
+    Q_PROPERTY(double p101 MEMBER p101)
+    Q_PROPERTY(QString p102 MEMBER p102)
+    Q_PROPERTY(bool p103 MEMBER p103)
+    Q_PROPERTY(int p104 MEMBER p104)
+    Q_PROPERTY(double p105 MEMBER p105)
+    Q_PROPERTY(QString p106 MEMBER p106)
+    Q_PROPERTY(bool p107 MEMBER p107)
+    Q_PROPERTY(int p108 MEMBER p108)
+    Q_PROPERTY(double p109 MEMBER p109)
+    Q_PROPERTY(QString p110 MEMBER p110)
+    Q_PROPERTY(bool p111 MEMBER p111)
+    Q_PROPERTY(int p112 MEMBER p112)
+    Q_PROPERTY(double p113 MEMBER p113)
+    Q_PROPERTY(QString p114 MEMBER p114)
+    Q_PROPERTY(bool p115 MEMBER p115)
+    Q_PROPERTY(int p116 MEMBER p116)
+    Q_PROPERTY(double p117 MEMBER p117)
+    Q_PROPERTY(QString p118 MEMBER p118)
+    Q_PROPERTY(bool p119 MEMBER p119)
+    Q_PROPERTY(int p120 MEMBER p120)
+    Q_PROPERTY(double p121 MEMBER p121)
+    Q_PROPERTY(QString p122 MEMBER p122)
+    Q_PROPERTY(bool p123 MEMBER p123)
+    Q_PROPERTY(int p124 MEMBER p124)
+    Q_PROPERTY(double p125 MEMBER p125)
+    Q_PROPERTY(QString p126 MEMBER p126)
+    Q_PROPERTY(bool p127 MEMBER p127)
+    Q_PROPERTY(int p128 MEMBER p128)
+    Q_PROPERTY(double p129 MEMBER p129)
+    Q_PROPERTY(QString p130 MEMBER p130)
+    Q_PROPERTY(bool p131 MEMBER p131)
+    Q_PROPERTY(int p132 MEMBER p132)
+    Q_PROPERTY(double p133 MEMBER p133)
+    Q_PROPERTY(QString p134 MEMBER p134)
+    Q_PROPERTY(bool p135 MEMBER p135)
+    Q_PROPERTY(int p136 MEMBER p136)
+    Q_PROPERTY(double p137 MEMBER p137)
+    Q_PROPERTY(QString p138 MEMBER p138)
+    Q_PROPERTY(bool p139 MEMBER p139)
+    Q_PROPERTY(int p140 MEMBER p140)
+    Q_PROPERTY(double p141 MEMBER p141)
+    Q_PROPERTY(QString p142 MEMBER p142)
+    Q_PROPERTY(bool p143 MEMBER p143)
+    Q_PROPERTY(int p144 MEMBER p144)
+    Q_PROPERTY(double p145 MEMBER p145)
+    Q_PROPERTY(QString p146 MEMBER p146)
+    Q_PROPERTY(bool p147 MEMBER p147)
+    Q_PROPERTY(int p148 MEMBER p148)
+    Q_PROPERTY(double p149 MEMBER p149)
+    Q_PROPERTY(QString p150 MEMBER p150)
+    Q_PROPERTY(bool p151 MEMBER p151)
+    Q_PROPERTY(int p152 MEMBER p152)
+    Q_PROPERTY(double p153 MEMBER p153)
+    Q_PROPERTY(QString p154 MEMBER p154)
+    Q_PROPERTY(bool p155 MEMBER p155)
+    Q_PROPERTY(int p156 MEMBER p156)
+    Q_PROPERTY(double p157 MEMBER p157)
+    Q_PROPERTY(QString p158 MEMBER p158)
+    Q_PROPERTY(bool p159 MEMBER p159)
+    Q_PROPERTY(int p160 MEMBER p160)
+    Q_PROPERTY(double p161 MEMBER p161)
+    Q_PROPERTY(QString p162 MEMBER p162)
+    Q_PROPERTY(bool p163 MEMBER p163)
+    Q_PROPERTY(int p164 MEMBER p164)
+    Q_PROPERTY(double p165 MEMBER p165)
+    Q_PROPERTY(QString p166 MEMBER p166)
+    Q_PROPERTY(bool p167 MEMBER p167)
+    Q_PROPERTY(int p168 MEMBER p168)
+    Q_PROPERTY(double p169 MEMBER p169)
+    Q_PROPERTY(QString p170 MEMBER p170)
+    Q_PROPERTY(bool p171 MEMBER p171)
+    Q_PROPERTY(int p172 MEMBER p172)
+    Q_PROPERTY(double p173 MEMBER p173)
+    Q_PROPERTY(QString p174 MEMBER p174)
+    Q_PROPERTY(bool p175 MEMBER p175)
+    Q_PROPERTY(int p176 MEMBER p176)
+    Q_PROPERTY(double p177 MEMBER p177)
+    Q_PROPERTY(QString p178 MEMBER p178)
+    Q_PROPERTY(bool p179 MEMBER p179)
+    Q_PROPERTY(int p180 MEMBER p180)
+    Q_PROPERTY(double p181 MEMBER p181)
+    Q_PROPERTY(QString p182 MEMBER p182)
+    Q_PROPERTY(bool p183 MEMBER p183)
+    Q_PROPERTY(int p184 MEMBER p184)
+    Q_PROPERTY(double p185 MEMBER p185)
+    Q_PROPERTY(QString p186 MEMBER p186)
+    Q_PROPERTY(bool p187 MEMBER p187)
+    Q_PROPERTY(int p188 MEMBER p188)
+    Q_PROPERTY(double p189 MEMBER p189)
+    Q_PROPERTY(QString p190 MEMBER p190)
+    Q_PROPERTY(bool p191 MEMBER p191)
+    Q_PROPERTY(int p192 MEMBER p192)
+    Q_PROPERTY(double p193 MEMBER p193)
+    Q_PROPERTY(QString p194 MEMBER p194)
+    Q_PROPERTY(bool p195 MEMBER p195)
+    Q_PROPERTY(int p196 MEMBER p196)
+    Q_PROPERTY(double p197 MEMBER p197)
+    Q_PROPERTY(QString p198 MEMBER p198)
+    Q_PROPERTY(bool p199 MEMBER p199)
+
+public:
+    explicit Properties200(QObject* parent = Q_NULLPTR) :
+        Properties100(parent),
+        p100(0), p101(0.0), p103(false), p104(0), p105(0.0), p107(false),
+        p108(0), p109(0.0), p111(false), p112(0), p113(0.0), p115(false),
+        p116(0), p117(0.0), p119(false), p120(0), p121(0.0), p123(false),
+        p124(0), p125(0.0), p127(false), p128(0), p129(0.0), p131(false),
+        p132(0), p133(0.0), p135(false), p136(0), p137(0.0), p139(false),
+        p140(0), p141(0.0), p143(false), p144(0), p145(0.0), p147(false),
+        p148(0), p149(0.0), p151(false), p152(0), p153(0.0), p155(false),
+        p156(0), p157(0.0), p159(false), p160(0), p161(0.0), p163(false),
+        p164(0), p165(0.0), p167(false), p168(0), p169(0.0), p171(false),
+        p172(0), p173(0.0), p175(false), p176(0), p177(0.0), p179(false),
+        p180(0), p181(0.0), p183(false), p184(0), p185(0.0), p187(false),
+        p188(0), p189(0.0), p191(false), p192(0), p193(0.0), p195(false),
+        p196(0), p197(0.0), p199(false) {
+    }
+
+    void fill(int seed) {
+        Properties100::fill(seed);
+        p100 = seed + 100;
+        p101 = (seed + 101) * 0.5;
+        p102 = QString::number(seed + 102);
+        p103 = ((seed + 103) & 1) != 0;
+        p104 = seed + 104;
+        p105 = (seed + 105) * 0.5;
+        p106 = QString::number(seed + 106);
+        p107 = ((seed + 107) & 1) != 0;
+        p108 = seed + 108;
+        p109 = (seed + 109) * 0.5;
+        p110 = QString::number(seed + 110);
+        p111 = ((seed + 111) & 1) != 0;
+        p112 = seed + 112;
+        p113 = (seed + 113) * 0.5;
+        p114 = QString::number(seed + 114);
+        p115 = ((seed + 115) & 1) != 0;
+        p116 = seed + 116;
+        p117 = (seed + 117) * 0.5;
+        p118 = QString::number(seed + 118);
+        p119 = ((seed + 119) & 1) != 0;
+        p120 = seed + 120;
+        p121 = (seed + 121) * 0.5;
+        p122 = QString::number(seed + 122);
+        p123 = ((seed + 123) & 1) != 0;
+        p124 = seed + 124;
+        p125 = (seed + 125) * 0.5;
+        p126 = QString::number(seed + 126);
+        p127 = ((seed + 127) & 1) != 0;
+        p128 = seed + 128;
+        p129 = (seed + 129) * 0.5;
+        p130 = QString::number(seed + 130);
+        p131 = ((seed + 131) & 1) != 0;
+        p132 = seed + 132;
+        p133 = (seed + 133) * 0.5;
+        p134 = QString::number(seed + 134);
+        p135 = ((seed + 135) & 1) != 0;
+        p136 = seed + 136;
+        p137 = (seed + 137) * 0.5;
+        p138 = QString::number(seed + 138);
+        p139 = ((seed + 139) & 1) != 0;
+        p140 = seed + 140;
+        p141 = (seed + 141) * 0.5;
+        p142 = QString::number(seed + 142);
+        p143 = ((seed + 143) & 1) != 0;
+        p144 = seed + 144;
+        p145 = (seed + 145) * 0.5;
+        p146 = QString::number(seed + 146);
+        p147 = ((seed + 147) & 1) != 0;
+        p148 = seed + 148;
+        p149 = (seed + 149) * 0.5;
+        p150 = QString::number(seed + 150);
+        p151 = ((seed + 151) & 1) != 0;
+        p152 = seed + 152;
+        p153 = (seed + 153) * 0.5;
+        p154 = QString::number(seed + 154);
+        p155 = ((seed + 155) & 1) != 0;
+        p156 = seed + 156;
+        p157 = (seed + 157) * 0.5;
+        p158 = QString::number(seed + 158);
+        p159 = ((seed + 159) & 1) != 0;
+        p160 = seed + 160;
+        p161 = (seed + 161) * 0.5;
+        p162 = QString::number(seed + 162);
+        p163 = ((seed + 163) & 1) != 0;
+        p164 = seed + 164;
+        p165 = (seed + 165) * 0.5;
+        p166 = QString::number(seed + 166);
+        p167 = ((seed + 167) & 1) != 0;
+        p168 = seed + 168;
+        p169 = (seed + 169) * 0.5;
+        p170 = QString::number(seed + 170);
+        p171 = ((seed + 171) & 1) != 0;
+        p172 = seed + 172;
+        p173 = (seed + 173) * 0.5;
+        p174 = QString::number(seed + 174);
+        p175 = ((seed + 175) & 1) != 0;
+        p176 = seed + 176;
+        p177 = (seed + 177) * 0.5;
+        p178 = QString::number(seed + 178);
+        p179 = ((seed + 179) & 1) != 0;
+        p180 = seed + 180;
+        p181 = (seed + 181) * 0.5;
+        p182 = QString::number(seed + 182);
+        p183 = ((seed + 183) & 1) != 0;
+        p184 = seed + 184;
+        p185 = (seed + 185) * 0.5;
+        p186 = QString::number(seed + 186);
+        p187 = ((seed + 187) & 1) != 0;
+        p188 = seed + 188;
+        p189 = (seed + 189) * 0.5;
+        p190 = QString::number(seed + 190);
+        p191 = ((seed + 191) & 1) != 0;
+        p192 = seed + 192;
+        p193 = (seed + 193) * 0.5;
+        p194 = QString::number(seed + 194);
+        p195 = ((seed + 195) & 1) != 0;
+        p196 = seed + 196;
+        p197 = (seed + 197) * 0.5;
+        p198 = QString::number(seed + 198);
+        p199 = ((seed + 199) & 1) != 0;
+    }
+
+    int p100;
+    double p101;
+    QString p102;
+    bool p103;
+    int p104;
+    double p105;
+    QString p106;
+    bool p107;
+    int p108;
+    double p109;
+    QString p110;
+    bool p111;
+    int p112;
+    double p113;
+    QString p114;
+    bool p115;
+    int p116;
+    double p117;
+    QString p118;
+    bool p119;
+    int p120;
+    double p121;
+    QString p122;
+    bool p123;
+    int p124;
+    double p125;
+    QString p126;
+    bool p127;
+    int p128;
+    double p129;
+    QString p130;
+    bool p131;
+    int p132;
+    double p133;
+    QString p134;
+    bool p135;
+    int p136;
+    double p137;
+    QString p138;
+    bool p139;
+    int p140;
+    double p141;
+    QString p142;
+    bool p143;
+    int p144;
+    double p145;
+    QString p146;
+    bool p147;
+    int p148;
+    double p149;
+    QString p150;
+    bool p151;
+    int p152;
+    double p153;
+    QString p154;
+    bool p155;
+    int p156;
+    double p157;
+    QString p158;
+    bool p159;
+    int p160;
+    double p161;
+    QString p162;
+    bool p163;
+    int p164;
+    double p165;
+    QString p166;
+    bool p167;
+    int p168;
+    double p169;
+    QString p170;
+    bool p171;
+    int p172;
+    double p173;
+    QString p174;
+    bool p175;
+    int p176;
+    double p177;
+    QString p178;
+    bool p179;
+    int p180;
+    double p181;
+    QString p182;
+    bool p183;
+    int p184;
+    double p185;
+    QString p186;
+    bool p187;
+    int p188;
+    double p189;
+    QString p190;
+    bool p191;
+    int p192;
+    double p193;
+    QString p194;
+    bool p195;
+    int p196;
+    double p197;
+    QString p198;
+    bool p199;
+};
+
+#endif // BENCHMARK_PROPERTIES_H
@@ -3,6 +3,8 @@ HEADERS += \
     $$PWD/src/qtsettingsmapper.h \
     $$PWD/src/qtxmlmapper.h \
     $$PWD/src/qtjsonmapper.h \
+    $$PWD/src/qtjsonstream.h \
+    $$PWD/src/qtcbormapper.h \
     $$PWD/src/qtresource.h \
     $$PWD/src/qtobjectmapper.h \
     $$PWD/src/qtmemorypool.h \
@@ -16,6 +18,8 @@ SOURCES += \
     $$PWD/src/qtsettingsmapper.cpp \
     $$PWD/src/qtxmlmapper.cpp \
     $$PWD/src/qtjsonmapper.cpp \
+    $$PWD/src/qtjsonstream.cpp \
+    $$PWD/src/qtcbormapper.cpp \
     $$PWD/src/qtresource.cpp \
     $$PWD/src/qtobjectmapper.cpp \
     $$PWD/src/qtmethodinvoker.cpp \
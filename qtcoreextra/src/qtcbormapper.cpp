@@ -0,0 +1,330 @@
+#include "qtcbormapper.h"
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+#include <QMetaProperty>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDate>
+#include <QTime>
+
+namespace
+{
+// RFC 8943: days since 1970-01-01
+static Q_DECL_CONSTEXPR quint64 qtCborDateDaysTag = 100;
+// private tags (first-come-first-served range)
+static Q_DECL_CONSTEXPR quint64 qtCborTimeTag = 0x51740001;    // msecs since start of day
+static Q_DECL_CONSTEXPR quint64 qtCborVariantTag = 0x51740002; // QDataStream-serialized QVariant
+
+inline QString cborReadString(QCborStreamReader& reader)
+{
+    QString result;
+    auto r = reader.readString();
+    while (r.status == QCborStreamReader::Ok) {
+        result += r.data;
+        r = reader.readString();
+    }
+    return (r.status == QCborStreamReader::Error ? QString() : result);
+}
+
+inline QVariant cborToVariant(const QCborValue& value)
+{
+    if (value.isDateTime())
+        return value.toDateTime();
+
+    if (!value.isTag())
+        return value.toVariant();
+
+    const QCborValue inner = value.taggedValue();
+    switch (quint64(value.tag()))
+    {
+    case quint64(QCborKnownTags::DateTimeString):
+        return QDateTime::fromString(inner.toString(), Qt::ISODateWithMs);
+    case quint64(QCborKnownTags::UnixTime_t):
+        return QDateTime::fromMSecsSinceEpoch(qRound64(inner.toDouble() * 1000), Qt::UTC);
+    case qtCborDateDaysTag:
+        return QDate(1970, 1, 1).addDays(inner.toInteger());
+    case qtCborTimeTag:
+        return QTime::fromMSecsSinceStartOfDay(static_cast<int>(inner.toInteger()));
+    case qtCborVariantTag:
+    {
+        QVariant result;
+        QDataStream stream(inner.toByteArray());
+        stream >> result;
+        return result;
+    }
+    default:
+        break;
+    }
+    return value.toVariant();
+}
+
+}
+
+
+
+QtCborWriter::QtCborWriter(QIODevice *device) :
+    writer(device)
+{
+}
+
+QtCborWriter::QtCborWriter(QByteArray *data) :
+    writer(data)
+{
+}
+
+QtCborWriter::~QtCborWriter()
+{
+}
+
+QCborStreamWriter &QtCborWriter::stream()
+{
+    return writer;
+}
+
+void QtCborWriter::writeKey(const char *name)
+{
+    const QByteArray key = QByteArray::fromRawData(name, qstrlen(name));
+    auto it = keys.constFind(key);
+    if (it != keys.cend()) {
+        writer.append(it.value()); // interned key
+        return;
+    }
+    keys.insert(QByteArray(name), static_cast<quint64>(keys.size()));
+    writer.append(QLatin1String(name));
+}
+
+void QtCborWriter::writeValue(const QVariant &value)
+{
+    switch (value.userType())
+    {
+    case QMetaType::UnknownType:
+        writer.appendNull();
+        break;
+    case QMetaType::Bool:
+        writer.append(value.toBool());
+        break;
+    case QMetaType::Char:
+    case QMetaType::SChar:
+    case QMetaType::Short:
+    case QMetaType::Int:
+    case QMetaType::Long:
+    case QMetaType::LongLong:
+        writer.append(static_cast<qint64>(value.toLongLong()));
+        break;
+    case QMetaType::UChar:
+    case QMetaType::UShort:
+    case QMetaType::UInt:
+    case QMetaType::ULong:
+    case QMetaType::ULongLong:
+        writer.append(static_cast<quint64>(value.toULongLong()));
+        break;
+    case QMetaType::Float:
+        writer.append(value.toFloat());
+        break;
+    case QMetaType::Double:
+        writer.append(value.toDouble());
+        break;
+    case QMetaType::QString:
+        writer.append(value.toString());
+        break;
+    case QMetaType::QByteArray:
+        writer.append(value.toByteArray());
+        break;
+    case QMetaType::QDateTime:
+    {
+        // ISO string keeps time spec and offset from UTC
+        const QDateTime dateTime = value.toDateTime();
+        if (!dateTime.isValid()) {
+            writer.appendNull();
+            break;
+        }
+        writer.append(QCborKnownTags::DateTimeString);
+        writer.append(dateTime.toString(Qt::ISODateWithMs));
+        break;
+    }
+    case QMetaType::QDate:
+    {
+        const QDate date = value.toDate();
+        if (!date.isValid()) {
+            writer.appendNull();
+            break;
+        }
+        writer.append(QCborTag(qtCborDateDaysTag));
+        writer.append(QDate(1970, 1, 1).daysTo(date));
+        break;
+    }
+    case QMetaType::QTime:
+    {
+        const QTime time = value.toTime();
+        if (!time.isValid()) {
+            writer.appendNull();
+            break;
+        }
+        writer.append(QCborTag(qtCborTimeTag));
+        writer.append(static_cast<qint64>(time.msecsSinceStartOfDay()));
+        break;
+    }
+    case QMetaType::QStringList:
+    case QMetaType::QVariantList:
+    case QMetaType::QVariantMap:
+    case QMetaType::QVariantHash:
+    case QMetaType::QUrl:
+    case QMetaType::QUuid:
+        QCborValue::fromVariant(value).toCbor(writer);
+        break;
+    default:
+    {
+        QByteArray data;
+        QDataStream stream(&data, QIODevice::WriteOnly);
+        stream << value;
+        writer.append(QCborTag(qtCborVariantTag));
+        writer.append(data);
+        break;
+    }
+    }
+}
+
+
+
+QtCborReader::QtCborReader(QIODevice *device) :
+    reader(device), loaded(false)
+{
+}
+
+QtCborReader::QtCborReader(const QByteArray &data) :
+    reader(data), loaded(false)
+{
+}
+
+QtCborReader::~QtCborReader()
+{
+}
+
+QCborStreamReader &QtCborReader::stream()
+{
+    return reader;
+}
+
+bool QtCborReader::readKey(QByteArray &key)
+{
+    if (reader.isUnsignedInteger()) {
+        const quint64 id = reader.toUnsignedInteger();
+        if (id >= static_cast<quint64>(keys.size()))
+            return false; // unknown key
+        key = keys[static_cast<int>(id)];
+        return reader.next();
+    }
+    if (reader.isString()) {
+        key = cborReadString(reader).toLatin1();
+        keys.push_back(key);
+        return !key.isEmpty();
+    }
+    return false;
+}
+
+bool QtCborReader::readObject()
+{
+    values.clear();
+    loaded = false;
+    if (!reader.isMap() || !reader.enterContainer())
+        return false;
+
+    QByteArray key;
+    while (reader.hasNext())
+    {
+        if (!readKey(key))
+            return false;
+        values.insert(key, QCborValue::fromCbor(reader));
+        if (reader.lastError() != QCborError::NoError)
+            return false;
+    }
+    loaded = reader.leaveContainer();
+    return loaded;
+}
+
+// Object was read by readObject() and was not
+// yet consumed by QtCborMapper::unserialize()
+bool QtCborReader::hasObject() const
+{
+    return loaded;
+}
+
+void QtCborReader::releaseObject()
+{
+    values.clear();
+    loaded = false;
+}
+
+bool QtCborReader::contains(const char *name) const
+{
+    return values.contains(QByteArray::fromRawData(name, qstrlen(name)));
+}
+
+QVariant QtCborReader::value(const char *name, int type) const
+{
+    auto it = values.constFind(QByteArray::fromRawData(name, qstrlen(name)));
+    if (it == values.cend())
+        return QVariant();
+
+    QVariant result = cborToVariant(it.value());
+    if (result.userType() != type)
+        result.convert(type);
+    return result;
+}
+
+
+
+QtCborMapper::QtCborMapper()
+{
+}
+
+QtCborMapper::~QtCborMapper()
+{
+}
+
+bool QtCborMapper::serialize(QtCborWriter &w, const QObject *obj) const
+{
+    if (!obj)
+        return false;
+
+    w.stream().startMap();
+    const bool result = QtObjectMapper<QtCborWriter, QtCborReader>::serialize(w, obj);
+    w.stream().endMap();
+    return result;
+}
+
+bool QtCborMapper::unserialize(QtCborReader &r, QObject *obj) const
+{
+    if (!obj)
+        return false;
+
+    // object may be already read by validateObject()
+    if (!r.hasObject() && !r.readObject())
+        return false;
+    const bool result = QtObjectMapper<QtCborWriter, QtCborReader>::unserialize(r, obj);
+    r.releaseObject();
+    return result;
+}
+
+bool QtCborMapper::write(QtCborWriter &w, const QObject *obj, const QMetaProperty &p) const
+{
+    w.writeKey(p.name());
+    w.writeValue(p.read(obj));
+    return true;
+}
+
+bool QtCborMapper::read(QtCborReader &r, QObject *obj, const QMetaProperty &p) const
+{
+    const char* name = p.name();
+    if (!r.contains(name))
+        return true; // property was not stored
+
+    return p.write(obj, r.value(name, p.userType()));
+}
+
+bool QtCborMapper::validate(QtCborReader &r, const QMetaProperty &p) const
+{
+    return r.contains(p.name());
+}
+
+#endif
@@ -0,0 +1,136 @@
+#pragma once
+#include <QtCoreExtra>
+#include <QtObjectMapper>
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+#include <QCborStreamWriter>
+#include <QCborStreamReader>
+#include <QCborValue>
+#include <QHash>
+#include <QVector>
+
+class QIODevice;
+
+/*!
+ * \brief The QtCborWriter class
+ *
+ * Output stream for QtCborMapper.
+ *
+ * Wraps QCborStreamWriter and keeps table of interned
+ * property keys: the first occurrence of key in stream is
+ * written as text string, all subsequent occurrences are
+ * written as small integer index into that table. Thus
+ * repeated class layouts cost only a few bytes per property.
+ *
+ * Single writer may be used to serialize many objects,
+ * e.g. inside of array started with stream().startArray().
+ */
+class QTCOREEXTRA_EXPORT QtCborWriter
+{
+    Q_DISABLE_COPY(QtCborWriter)
+public:
+    explicit QtCborWriter(QIODevice* device);
+    explicit QtCborWriter(QByteArray* data);
+    ~QtCborWriter();
+
+    QCborStreamWriter& stream();
+
+    void writeKey(const char* name);
+    void writeValue(const QVariant& value);
+
+private:
+    QCborStreamWriter writer;
+    QHash<QByteArray, quint64> keys;
+};
+
+
+
+/*!
+ * \brief The QtCborReader class
+ *
+ * Input stream for QtCborMapper.
+ *
+ * Decodes objects written by QtCborWriter and resolves
+ * interned property keys.
+ */
+class QTCOREEXTRA_EXPORT QtCborReader
+{
+    Q_DISABLE_COPY(QtCborReader)
+public:
+    explicit QtCborReader(QIODevice* device);
+    explicit QtCborReader(const QByteArray& data);
+    ~QtCborReader();
+
+    QCborStreamReader& stream();
+
+    bool readObject();
+    bool hasObject() const;
+    void releaseObject();
+
+    bool contains(const char* name) const;
+    QVariant value(const char* name, int type) const;
+
+private:
+    bool readKey(QByteArray& key);
+
+    QCborStreamReader reader;
+    QVector<QByteArray> keys;
+    QHash<QByteArray, QCborValue> values;
+    bool loaded;
+};
+
+
+
+/*!
+ * \brief The QtCborMapper class
+ *
+ * Binary (CBOR) object mapper.
+ *
+ * Object is encoded as CBOR map of property keys to
+ * property values. Numeric, boolean, string, byte-array
+ * and date/time values are stored natively without
+ * conversion to string, other types are stored as
+ * QDataStream-serialized blobs.
+ *
+ * validateObject() reads the next object from stream,
+ * if it was not read yet; the following unserialize()
+ * maps that object and does not read another one.
+ *
+ * \code
+ * QByteArray data;
+ * QtCborMapper mapper;
+ * QtCborWriter writer(&data);
+ * mapper.serialize(writer, object);
+ * ...
+ * QtCborReader reader(data);
+ * mapper.unserialize(reader, object);
+ * \endcode
+ *
+ * \note this class is supported for Qt 5.12.0 and higher
+ */
+class QTCOREEXTRA_EXPORT QtCborMapper :
+        public QtObjectMapper<QtCborWriter, QtCborReader>
+{
+    Q_DISABLE_COPY(QtCborMapper)
+public:
+    QtCborMapper();
+    ~QtCborMapper();
+
+    bool serialize(QtCborWriter& w, const QObject *obj) const;
+    bool unserialize(QtCborReader& r, QObject *obj) const;
+
+    template<class _Object>
+    inline bool validateObject(QtCborReader &r) const {
+        if (!r.hasObject() && !r.readObject())
+            return false;
+        return QtObjectMapper<QtCborWriter, QtCborReader>::validateObject<_Object>(r);
+    }
+
+    // QtObjectMapper interface
+protected:
+    bool write(QtCborWriter& w, const QObject *obj, const QMetaProperty &p) const Q_DECL_OVERRIDE;
+    bool read(QtCborReader& r, QObject *obj, const QMetaProperty &p) const Q_DECL_OVERRIDE;
+    bool validate(QtCborReader& r, const QMetaProperty &p) const Q_DECL_OVERRIDE;
+};
+
+#endif
@@ -26,9 +26,6 @@ QtJsonMapper::~QtJsonMapper(){
 
 bool QtJsonMapper::write(QJsonObject& json, const QObject *obj, const QMetaProperty &p) const
 {
-    if (!p.isReadable())
-        return false;
-
     const QVariant value = p.read(obj);
     const int type = value.type();
     if (type < 0 || type >= qtJsonVariantMappingSize)
@@ -41,9 +38,6 @@ bool QtJsonMapper::write(QJsonObject& json, const QObject *obj, const QMetaPrope
 
 bool QtJsonMapper::read(const QJsonObject& json, QObject *obj, const QMetaProperty &p) const
 {
-    if (!p.isWritable())
-        return true;
-
     const char* name = p.name();
     QVariant value = json[QLatin1String(name)].toVariant();
     if (!value.convert(p.type()))
@@ -91,9 +85,6 @@ bool QtTypedJsonMapper::validate(const QJsonObject &jsonObject, const QMetaPrope
 
 bool QtTypedJsonMapper::write(QJsonObject &jsonObject, const QObject *obj, const QMetaProperty &p) const
 {
-    if (!p.isReadable())
-        return true;
-
     QJsonObject json;
     json["type"] = p.typeName();
     json["value"] = p.read(obj).toString();
@@ -104,9 +95,6 @@ bool QtTypedJsonMapper::write(QJsonObject &jsonObject, const QObject *obj, const
 
 bool QtTypedJsonMapper::read(const QJsonObject& json, QObject *obj, const QMetaProperty &p) const
 {
-    if (!p.isWritable())
-        return true;
-
     const QJsonObject jsonObject = json[p.name()].toObject();
     const QString typeName = jsonObject["type"].toString();
     QVariant value(jsonObject["value"].toString());
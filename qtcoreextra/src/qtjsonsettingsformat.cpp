@@ -5,6 +5,14 @@
 #include <QJsonArray>
 #include <QJsonValue>
 #include <QIODevice>
+#include <QFileDevice>
+#include <QSaveFile>
+#include <QFile>
+#include <QBasicTimer>
+#include <QTimerEvent>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QHash>
 
 #include <QVector>
 #include <QQueue>
@@ -37,6 +45,30 @@ void writePath(QJsonObject& root, const QString& path, const QJsonValue& value)
     root[key] = json;
 }
 
+void removePath(QJsonObject& root, const QString& path)
+{
+    if (path.isEmpty())
+        return;
+
+    const int index = path.indexOf('/', 0);
+    const QString key = path.mid(0, index);
+    if (index < 0) {
+        root.remove(key);
+        return;
+    }
+
+    auto it = root.find(key);
+    if (it == root.end())
+        return;
+
+    QJsonObject json = (*it).toObject();
+    removePath(json, path.mid(index + 1));
+    if (json.isEmpty())
+        root.erase(it); // drop empty groups
+    else
+        *it = json;
+}
+
 
 void readPath(const QJsonObject& root, QString& path, QSettings::SettingsMap &map)
 {
@@ -78,51 +110,165 @@ void readPath(const QJsonObject& root, QString& path, QSettings::SettingsMap &ma
     }
 }
 
+QJsonObject jsonValue(const QVariant& value)
+{
+    QJsonObject valueObject;
+    switch (value.type()) {
+    case QVariant::Bool:
+    case QVariant::UInt:
+    case QVariant::Int:
+    case QVariant::ULongLong:
+    case QVariant::LongLong:
+    case QVariant::Double:
+    case QVariant::String:
+        valueObject["value"] = QJsonValue::fromVariant(value);
+        break;
+    case QVariant::ByteArray:
+        valueObject["value"] = QString(value.toByteArray().toBase64());
+        break;
+    default:
+        valueObject["value"] = value.toString();
+        break;
+    }
+    valueObject["type"] = value.typeName();
+    return valueObject;
 }
 
-bool QtJsonSettingsFormat::read(QIODevice &device, QSettings::SettingsMap &map)
+bool parseDocument(const QByteArray& data, QJsonObject& root)
 {
     QJsonParseError jsonError;
-    QJsonDocument document = QJsonDocument::fromJson(device.readAll(), &jsonError);
+    QJsonDocument document = QJsonDocument::fromJson(data, &jsonError);
     if (jsonError.error != QJsonParseError::NoError) {
         qCritical() << "failed to read settings: " << jsonError.errorString() << "at" << jsonError.offset;
         return false;
     }
-    const QJsonObject rootObject = document.object();
+    root = document.object();
+    return true;
+}
+
+/*
+ * QVariant::operator== converts between types, so true == 1
+ * and "1" == 1; settings must be rewritten when type changes
+ */
+inline bool sameValue(const QVariant& lhs, const QVariant& rhs)
+{
+    return (lhs.userType() == rhs.userType() && lhs == rhs);
+}
+
+bool sameMap(const QSettings::SettingsMap& lhs, const QSettings::SettingsMap& rhs)
+{
+    if (lhs.size() != rhs.size())
+        return false;
+    for (auto l = lhs.cbegin(), r = rhs.cbegin(); l != lhs.cend(); ++l, ++r) {
+        if (l.key() != r.key() || !sameValue(l.value(), r.value()))
+            return false;
+    }
+    return true;
+}
+
+/*
+ * Patch \a root so that it reflects \a map, touching
+ * only entries that differ from \a previous
+ */
+void updateTree(QJsonObject& root, const QSettings::SettingsMap& previous, const QSettings::SettingsMap& map)
+{
+    for (auto it = previous.cbegin(); it != previous.cend(); ++it) {
+        if (!map.contains(it.key()))
+            removePath(root, it.key());
+    }
+    for (auto it = map.cbegin(); it != map.cend(); ++it) {
+        auto prev = previous.constFind(it.key());
+        if (prev == previous.cend() || !sameValue(prev.value(), it.value()))
+            writePath(root, it.key(), jsonValue(it.value()));
+    }
+}
+
+
+/*
+ * Cached state of settings file: last parsed/written
+ * content, settings map and JSON tree.
+ */
+struct JsonSettingsEntry
+{
+    QByteArray data;
+    QSettings::SettingsMap map;
+    QJsonObject root;
+};
+
+class JsonSettingsCache
+{
+public:
+    JsonSettingsCache() : enabled(false) {}
+
+    QMutex mutex;
+    QHash<QString, JsonSettingsEntry> entries;
+    bool enabled;
+};
+
+Q_GLOBAL_STATIC(JsonSettingsCache, settingsCache)
+
+inline QString deviceFileName(QIODevice& device)
+{
+    QFileDevice* file = qobject_cast<QFileDevice*>(&device);
+    return (file != Q_NULLPTR ? file->fileName() : QString());
+}
+
+}
+
+bool QtJsonSettingsFormat::read(QIODevice &device, QSettings::SettingsMap &map)
+{
+    const QByteArray data = device.readAll();
+
+    JsonSettingsCache* cache = settingsCache();
+    QMutexLocker locker(&cache->mutex);
+    const QString fileName = cache->enabled ? deviceFileName(device) : QString();
+    if (!fileName.isEmpty())
+    {
+        auto it = cache->entries.constFind(fileName);
+        if (it != cache->entries.cend() && it->data == data) {
+            map = it->map; // file was not changed since last access
+            return true;
+        }
+    }
+
+    QJsonObject rootObject;
+    if (!parseDocument(data, rootObject))
+        return false;
     QString path;
     readPath(rootObject, path, map);
+
+    if (!fileName.isEmpty())
+    {
+        JsonSettingsEntry& entry = cache->entries[fileName];
+        entry.data = data;
+        entry.map = map;
+        entry.root = rootObject;
+    }
     return true;
 }
 
 bool QtJsonSettingsFormat::write(QIODevice &device, const QSettings::SettingsMap &map)
 {
-    QJsonObject root;
-    for (auto it = map.cbegin(); it != map.cend(); ++it)
+    JsonSettingsCache* cache = settingsCache();
+    QMutexLocker locker(&cache->mutex);
+    const QString fileName = cache->enabled ? deviceFileName(device) : QString();
+    if (fileName.isEmpty())
     {
-         QJsonObject valueObject;
-         const QVariant value = it.value();
-         switch (value.type()) {
-         case QVariant::Bool:
-         case QVariant::UInt:
-         case QVariant::Int:
-         case QVariant::ULongLong:
-         case QVariant::LongLong:
-         case QVariant::Double:
-         case QVariant::String:
-             valueObject["value"] = QJsonValue::fromVariant(value);
-             break;
-         case QVariant::ByteArray:
-             valueObject["value"] = QString(value.toByteArray().toBase64());
-             break;
-         default:
-             valueObject["value"] = value.toString();
-             break;
-         }
-         valueObject["type"] = value.typeName();
-         writePath(root, it.key(), valueObject);
-    }
-    device.write(QJsonDocument(root).toJson());
-    return true;
+        locker.unlock();
+        QJsonObject root;
+        updateTree(root, QSettings::SettingsMap(), map);
+        return (device.write(QJsonDocument(root).toJson()) >= 0);
+    }
+
+    JsonSettingsEntry& entry = cache->entries[fileName];
+    if (entry.data.isEmpty() || !sameMap(entry.map, map))
+    {
+        // patch only changed values instead of rebuilding whole tree
+        updateTree(entry.root, entry.map, map);
+        entry.map = map;
+        entry.data = QJsonDocument(entry.root).toJson();
+    }
+    return (device.write(entry.data) == entry.data.size());
 }
 
 void QtJsonSettingsFormat::registrateDefault(const QString& ext)
@@ -131,3 +277,167 @@ void QtJsonSettingsFormat::registrateDefault(const QString& ext)
     QSettings::setDefaultFormat(format);
 }
 
+void QtJsonSettingsFormat::setCachingEnabled(bool on)
+{
+    JsonSettingsCache* cache = settingsCache();
+    QMutexLocker locker(&cache->mutex);
+    cache->enabled = on;
+    if (!on)
+        cache->entries.clear();
+}
+
+bool QtJsonSettingsFormat::isCachingEnabled()
+{
+    JsonSettingsCache* cache = settingsCache();
+    QMutexLocker locker(&cache->mutex);
+    return cache->enabled;
+}
+
+void QtJsonSettingsFormat::clearCache()
+{
+    JsonSettingsCache* cache = settingsCache();
+    QMutexLocker locker(&cache->mutex);
+    cache->entries.clear();
+}
+
+
+
+
+class QtJsonSettingsFilePrivate
+{
+public:
+    QString fileName;
+    QSettings::SettingsMap map;
+    QJsonObject root;
+    QBasicTimer timer;
+    int delay;
+    bool dirty;
+};
+
+QtJsonSettingsFile::QtJsonSettingsFile(const QString &fileName, QObject *parent) :
+    QObject(parent),
+    d(new QtJsonSettingsFilePrivate)
+{
+    d->fileName = fileName;
+    d->delay = 1000;
+    d->dirty = false;
+    reload();
+}
+
+QtJsonSettingsFile::~QtJsonSettingsFile()
+{
+    sync();
+}
+
+QString QtJsonSettingsFile::fileName() const
+{
+    return d->fileName;
+}
+
+void QtJsonSettingsFile::setWriteDelay(int msec)
+{
+    d->delay = qMax(msec, 0);
+    if (d->timer.isActive())
+        d->timer.start(d->delay, this);
+}
+
+int QtJsonSettingsFile::writeDelay() const
+{
+    return d->delay;
+}
+
+bool QtJsonSettingsFile::contains(const QString &key) const
+{
+    return d->map.contains(key);
+}
+
+QVariant QtJsonSettingsFile::value(const QString &key, const QVariant &defaultValue) const
+{
+    return d->map.value(key, defaultValue);
+}
+
+void QtJsonSettingsFile::setValue(const QString &key, const QVariant &value)
+{
+    auto it = d->map.find(key);
+    if (it != d->map.end() && sameValue(it.value(), value))
+        return; // nothing changed
+
+    d->map.insert(key, value);
+    writePath(d->root, key, jsonValue(value));
+    scheduleSync();
+}
+
+void QtJsonSettingsFile::remove(const QString &key)
+{
+    if (d->map.remove(key) == 0)
+        return;
+
+    removePath(d->root, key);
+    scheduleSync();
+}
+
+QStringList QtJsonSettingsFile::allKeys() const
+{
+    return d->map.keys();
+}
+
+bool QtJsonSettingsFile::isDirty() const
+{
+    return d->dirty;
+}
+
+bool QtJsonSettingsFile::reload()
+{
+    d->timer.stop();
+    d->dirty = false;
+    d->map.clear();
+    d->root = QJsonObject();
+
+    QFile file(d->fileName);
+    if (!file.exists())
+        return true; // empty settings
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    if (!parseDocument(file.readAll(), d->root))
+        return false;
+
+    QString path;
+    readPath(d->root, path, d->map);
+    return true;
+}
+
+bool QtJsonSettingsFile::sync()
+{
+    d->timer.stop();
+    if (!d->dirty)
+        return true;
+
+    QSaveFile file(d->fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCritical() << "failed to write settings: " << file.errorString();
+        return false;
+    }
+    file.write(QJsonDocument(d->root).toJson());
+    if (!file.commit()) {
+        qCritical() << "failed to write settings: " << file.errorString();
+        return false;
+    }
+    d->dirty = false;
+    return true;
+}
+
+void QtJsonSettingsFile::scheduleSync()
+{
+    d->dirty = true;
+    if (!d->timer.isActive()) // coalesce changes within time window
+        d->timer.start(d->delay, this);
+}
+
+void QtJsonSettingsFile::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() == d->timer.timerId()) {
+        sync();
+        return;
+    }
+    QObject::timerEvent(event);
+}
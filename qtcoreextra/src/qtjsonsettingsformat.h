@@ -4,7 +4,20 @@
 #include <QtCoreExtra>
 
 #include <QSettings>
+#include <QObject>
+#include <QStringList>
 
+/*!
+ * \brief The QtJsonSettingsFormat class
+ *
+ * JSON storage format for QSettings.
+ *
+ * When caching is enabled format keeps parsed tree,
+ * settings map and serialized content of each settings
+ * file in memory: read() skips parsing if file content was
+ * not changed since last access and write() patches only
+ * changed values instead of rebuilding the whole document.
+ */
 class QTCOREEXTRA_EXPORT QtJsonSettingsFormat
 {
     Q_DISABLE_COPY(QtJsonSettingsFormat)
@@ -16,6 +29,60 @@ public:
     static bool read(QIODevice &device, QSettings::SettingsMap &map);
     static bool write(QIODevice &device, const QSettings::SettingsMap &map);
     static void registrateDefault(const QString &ext = "json");
+
+    static void setCachingEnabled(bool on = true);
+    static bool isCachingEnabled();
+    static void clearCache();
+};
+
+
+/*!
+ * \brief The QtJsonSettingsFile class
+ *
+ * In-memory JSON settings file with coalescing write-back.
+ *
+ * Settings are parsed once on construction and then kept
+ * in memory. setValue() and remove() update the tree in
+ * place and only mark file as dirty if value was really
+ * changed. All changes made within writeDelay() milliseconds
+ * are written with single write, file is replaced atomically
+ * with QSaveFile.
+ *
+ * File uses the same layout as QtJsonSettingsFormat.
+ */
+class QTCOREEXTRA_EXPORT QtJsonSettingsFile :
+        public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(QtJsonSettingsFile)
+public:
+    explicit QtJsonSettingsFile(const QString& fileName, QObject* parent = Q_NULLPTR);
+    ~QtJsonSettingsFile();
+
+    QString fileName() const;
+
+    void setWriteDelay(int msec);
+    int writeDelay() const;
+
+    bool contains(const QString& key) const;
+    QVariant value(const QString& key, const QVariant& defaultValue = QVariant()) const;
+    void setValue(const QString& key, const QVariant& value);
+    void remove(const QString& key);
+    QStringList allKeys() const;
+
+    bool isDirty() const;
+
+public Q_SLOTS:
+    bool reload();
+    bool sync();
+
+protected:
+    void timerEvent(QTimerEvent* event) Q_DECL_OVERRIDE;
+
+private:
+    void scheduleSync();
+
+    QScopedPointer<class QtJsonSettingsFilePrivate> d;
 };
 
 
@@ -0,0 +1,335 @@
+#include "qtjsonstream.h"
+#include "qtjsonmapper.h"
+
+#include <QIODevice>
+#include <QJsonParseError>
+#include <QCoreApplication>
+
+
+class QtJsonStreamWriterPrivate
+{
+public:
+    const QtJsonMapper* mapper;
+    QIODevice* device;
+    QJsonDocument::JsonFormat format;
+    QString errorString;
+    qint64 count;
+    bool finished;
+
+    bool put(const QByteArray& data)
+    {
+        if (device->write(data) == data.size())
+            return true;
+        errorString = device->errorString();
+        return false;
+    }
+};
+
+QtJsonStreamWriter::QtJsonStreamWriter(const QtJsonMapper *mapper, QIODevice *device,
+                                       QJsonDocument::JsonFormat format) :
+    d(new QtJsonStreamWriterPrivate)
+{
+    Q_ASSERT(mapper != Q_NULLPTR);
+    Q_ASSERT(device != Q_NULLPTR);
+    d->mapper = mapper;
+    d->device = device;
+    d->format = format;
+    d->count = 0;
+    d->finished = false;
+}
+
+QtJsonStreamWriter::~QtJsonStreamWriter()
+{
+    finish();
+}
+
+bool QtJsonStreamWriter::write(const QObject *object)
+{
+    if (d->finished || hasError())
+        return false;
+
+    QJsonObject json;
+    if (!d->mapper->serialize(json, object)) {
+        d->errorString = QCoreApplication::translate("QtJsonStreamWriter", "failed to serialize object");
+        return false;
+    }
+
+    QByteArray data = QJsonDocument(json).toJson(d->format);
+    if (d->format == QJsonDocument::Indented)
+        data.chop(1); // strip trailing newline
+    if (!d->put(d->count == 0 ? QByteArrayLiteral("[") : QByteArrayLiteral(",")))
+        return false;
+    if (!d->put(data))
+        return false;
+    ++d->count;
+    return true;
+}
+
+bool QtJsonStreamWriter::finish()
+{
+    if (d->finished)
+        return !hasError();
+
+    d->finished = true;
+    if (hasError())
+        return false;
+    return d->put(d->count == 0 ? QByteArrayLiteral("[]") : QByteArrayLiteral("]"));
+}
+
+qint64 QtJsonStreamWriter::count() const
+{
+    return d->count;
+}
+
+bool QtJsonStreamWriter::hasError() const
+{
+    return !d->errorString.isEmpty();
+}
+
+QString QtJsonStreamWriter::errorString() const
+{
+    return d->errorString;
+}
+
+
+
+
+class QtJsonStreamReaderPrivate
+{
+public:
+    enum State
+    {
+        Start,
+        BeforeElement,
+        InElement,
+        AfterElement,
+        Finished,
+        Failed
+    };
+
+    const QtJsonMapper* mapper;
+    QIODevice* device;
+    QByteArray buffer;
+    QString errorString;
+    qint64 count;
+    int chunkSize;
+    int pos;   // current scan position in buffer
+    int start; // start of current element in buffer
+    int depth;
+    bool quoted;
+    bool escaped;
+    bool waiting; // sequential device has no data yet
+    State state;
+
+    inline void fail(const char* message)
+    {
+        state = Failed;
+        errorString = QCoreApplication::translate("QtJsonStreamReader", message);
+    }
+
+    enum FillResult
+    {
+        Filled,
+        NoData,   // sequential device may receive data later
+        EndOfData
+    };
+
+    FillResult fill()
+    {
+        // drop consumed data, keep only unfinished element
+        if (state == InElement) {
+            buffer.remove(0, start);
+            pos -= start;
+            start = 0;
+        } else {
+            buffer.clear();
+            pos = start = 0;
+        }
+        const QByteArray chunk = device->read(chunkSize);
+        if (chunk.isEmpty())
+            return (device->isSequential() && device->isOpen() ? NoData : EndOfData);
+        buffer.append(chunk);
+        return Filled;
+    }
+
+    static inline bool isSpace(char c) {
+        return (c == ' ' || c == '\t' || c == '\n' || c == '\r');
+    }
+
+    bool next(QByteArray& element)
+    {
+        waiting = false;
+        if (state == Finished || state == Failed)
+            return false;
+
+        for (;;)
+        {
+            if (pos == buffer.size()) {
+                const FillResult result = fill();
+                if (result == NoData) {
+                    waiting = true; // try again on readyRead()
+                    return false;
+                }
+                if (result == EndOfData) {
+                    fail("unexpected end of data");
+                    return false;
+                }
+            }
+
+            const char* data = buffer.constData();
+            const int size = buffer.size();
+            for (; pos < size; ++pos)
+            {
+                const char c = data[pos];
+                switch (state)
+                {
+                case Start:
+                    if (isSpace(c))
+                        break;
+                    if (c != '[') {
+                        fail("top-level array expected");
+                        return false;
+                    }
+                    state = BeforeElement;
+                    break;
+                case BeforeElement:
+                    if (isSpace(c))
+                        break;
+                    if (c == ']' && count == 0) {
+                        state = Finished;
+                        return false;
+                    }
+                    if (c != '{') {
+                        fail("object expected");
+                        return false;
+                    }
+                    state = InElement;
+                    start = pos;
+                    depth = 1;
+                    quoted = escaped = false;
+                    break;
+                case InElement:
+                    if (quoted) {
+                        if (escaped)
+                            escaped = false;
+                        else if (c == '\\')
+                            escaped = true;
+                        else if (c == '"')
+                            quoted = false;
+                        break;
+                    }
+                    if (c == '"') {
+                        quoted = true;
+                    } else if (c == '{' || c == '[') {
+                        ++depth;
+                    } else if ((c == '}' || c == ']') && --depth == 0) {
+                        ++pos;
+                        element = QByteArray::fromRawData(data + start, pos - start);
+                        state = AfterElement;
+                        ++count;
+                        return true;
+                    }
+                    break;
+                case AfterElement:
+                    if (isSpace(c))
+                        break;
+                    if (c == ',') {
+                        state = BeforeElement;
+                    } else if (c == ']') {
+                        state = Finished;
+                        ++pos;
+                        return false;
+                    } else {
+                        fail("',' or ']' expected");
+                        return false;
+                    }
+                    break;
+                case Finished:
+                case Failed:
+                    return false;
+                }
+            }
+        }
+    }
+};
+
+QtJsonStreamReader::QtJsonStreamReader(const QtJsonMapper *mapper, QIODevice *device, int chunkSize) :
+    d(new QtJsonStreamReaderPrivate)
+{
+    Q_ASSERT(mapper != Q_NULLPTR);
+    Q_ASSERT(device != Q_NULLPTR);
+    d->mapper = mapper;
+    d->device = device;
+    d->count = 0;
+    d->chunkSize = qMax(chunkSize, 1024);
+    d->pos = d->start = d->depth = 0;
+    d->quoted = d->escaped = d->waiting = false;
+    d->state = QtJsonStreamReaderPrivate::Start;
+}
+
+QtJsonStreamReader::~QtJsonStreamReader()
+{
+}
+
+bool QtJsonStreamReader::readNext(QJsonObject &json)
+{
+    QByteArray element;
+    if (!d->next(element))
+        return false;
+
+    QJsonParseError error;
+    const QJsonDocument document = QJsonDocument::fromJson(element, &error);
+    if (error.error != QJsonParseError::NoError) {
+        d->state = QtJsonStreamReaderPrivate::Failed;
+        d->errorString = error.errorString();
+        return false;
+    }
+    json = document.object();
+    return true;
+}
+
+bool QtJsonStreamReader::readNext(QObject *object)
+{
+    QJsonObject json;
+    if (!readNext(json))
+        return false;
+    return unserialize(json, object);
+}
+
+bool QtJsonStreamReader::unserialize(const QJsonObject &json, QObject *object)
+{
+    if (d->mapper->unserialize(json, object))
+        return true;
+    d->state = QtJsonStreamReaderPrivate::Failed;
+    d->errorString = QCoreApplication::translate("QtJsonStreamReader", "failed to unserialize object");
+    return false;
+}
+
+bool QtJsonStreamReader::atEnd() const
+{
+    return (d->state == QtJsonStreamReaderPrivate::Finished ||
+            d->state == QtJsonStreamReaderPrivate::Failed);
+}
+
+// Sequential device (socket, pipe) had no data available
+// on last read: reading may be continued when more data
+// arrives, e.g. on QIODevice::readyRead()
+bool QtJsonStreamReader::isWaitingForData() const
+{
+    return d->waiting;
+}
+
+qint64 QtJsonStreamReader::count() const
+{
+    return d->count;
+}
+
+bool QtJsonStreamReader::hasError() const
+{
+    return (d->state == QtJsonStreamReaderPrivate::Failed);
+}
+
+QString QtJsonStreamReader::errorString() const
+{
+    return d->errorString;
+}
@@ -0,0 +1,137 @@
+#ifndef QTJSONSTREAM_H
+#define QTJSONSTREAM_H
+
+#include <QtCoreExtra>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QObject>
+
+class QIODevice;
+class QtJsonMapper;
+
+/*!
+ * \brief The QtJsonStreamWriter class
+ *
+ * Streaming serializer of object collections.
+ *
+ * QtJsonStreamWriter writes objects as elements of top-level
+ * JSON array directly into QIODevice. Every object is mapped
+ * with QtJsonMapper into small JSON object that is flushed
+ * into device immediately, so memory consumption is bounded
+ * by the size of single object, not by the size of collection.
+ *
+ * \code
+ * QFile file("snapshot.json");
+ * file.open(QIODevice::WriteOnly);
+ *
+ * QtJsonMapper mapper;
+ * QtJsonStreamWriter writer(&mapper, &file);
+ * writer.write(objects.begin(), objects.end());
+ * writer.finish();
+ * \endcode
+ */
+class QTCOREEXTRA_EXPORT QtJsonStreamWriter
+{
+    Q_DISABLE_COPY(QtJsonStreamWriter)
+public:
+    QtJsonStreamWriter(const QtJsonMapper* mapper, QIODevice* device,
+                       QJsonDocument::JsonFormat format = QJsonDocument::Compact);
+    ~QtJsonStreamWriter();
+
+    bool write(const QObject* object);
+
+    template<class _InIt>
+    int write(_InIt first, _InIt last);
+
+    bool finish();
+
+    qint64 count() const;
+    bool hasError() const;
+    QString errorString() const;
+
+private:
+    QScopedPointer<class QtJsonStreamWriterPrivate> d;
+};
+
+template<class _InIt>
+int QtJsonStreamWriter::write(_InIt first, _InIt last)
+{
+    int n = 0;
+    for (; first != last; ++first, ++n) {
+        if (!write(*first))
+            break;
+    }
+    return n;
+}
+
+
+
+/*!
+ * \brief The QtJsonStreamReader class
+ *
+ * Incremental reader of object collections written by
+ * QtJsonStreamWriter (or any top-level JSON array of objects).
+ *
+ * Input device is read in fixed-size chunks and split
+ * into array elements on the fly; only the element that
+ * is currently being parsed is kept in memory. Every element
+ * is then mapped onto object with QtJsonMapper.
+ *
+ * When sequential device (socket, pipe) has no data yet,
+ * readNext() returns false without error and
+ * isWaitingForData() is true; reading is continued by
+ * calling readNext() again when more data is available.
+ * If such device is closed before the array is complete,
+ * the rest of data is reported as unexpected end of data.
+ *
+ * \code
+ * QtJsonMapper mapper;
+ * QtJsonStreamReader reader(&mapper, &file);
+ * reader.readAll([this](qint64) { return new Item(this); });
+ * if (reader.hasError())
+ *     qWarning() << reader.errorString();
+ * \endcode
+ */
+class QTCOREEXTRA_EXPORT QtJsonStreamReader
+{
+    Q_DISABLE_COPY(QtJsonStreamReader)
+public:
+    QtJsonStreamReader(const QtJsonMapper* mapper, QIODevice* device, int chunkSize = 64 * 1024);
+    ~QtJsonStreamReader();
+
+    bool readNext(QJsonObject& json);
+    bool readNext(QObject* object);
+
+    template<class _Factory>
+    qint64 readAll(_Factory create);
+
+    bool atEnd() const;
+    bool isWaitingForData() const;
+    qint64 count() const;
+    bool hasError() const;
+    QString errorString() const;
+
+private:
+    bool unserialize(const QJsonObject& json, QObject* object);
+
+    QScopedPointer<class QtJsonStreamReaderPrivate> d;
+};
+
+template<class _Factory>
+qint64 QtJsonStreamReader::readAll(_Factory create)
+{
+    QJsonObject json;
+    qint64 n = 0;
+    while (readNext(json))
+    {
+        QObject* object = create(count() - 1);
+        if (object == Q_NULLPTR)
+            break;
+        if (!unserialize(json, object))
+            break;
+        ++n;
+    }
+    return n;
+}
+
+#endif // QTJSONSTREAM_H
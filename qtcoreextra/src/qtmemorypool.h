@@ -2,6 +2,9 @@
 #define QTMEMORYPOOL_H
 
 #include <atomic>
+#include <new>
+#include <utility>
+#include <cstddef>
 
 #include <QtGlobal>
 
@@ -28,6 +31,15 @@ private:
 };
 
 
+/*!
+ * \brief The QtLockFree struct
+ *
+ * Tag type used as \a _Mutex argument of QtMemoryPool
+ * to select lock-free implementation of free list.
+ */
+struct QtLockFree {};
+
+
 
 
 /*!
@@ -49,12 +61,11 @@ public:
     }
 
     inline ~QtMemoryPool() {
-        mtx.lock();
+        // pop() acquires the lock by itself
         T* _Ptr = pop();
         for(;_Ptr != Q_NULLPTR; _Ptr = pop()) {
             delete _Ptr;
         }
-        mtx.unlock();
     }
 
     inline void push(T *_Ptr)
@@ -130,4 +141,644 @@ private:
 };
 
 
+/*!
+ * \brief The QtMemoryPool<T, QtLockFree> class
+ *
+ * Lock-free implementation of free list based on Treiber stack.
+ *
+ * Head of the list is stored as tagged pointer: the upper
+ * bits of 64-bit word holds modification counter, that is
+ * incremented on each successfull update, so the ABA problem
+ * is avoided without double-width CAS. On 64-bit platforms
+ * 48 bits are used for pointer and 16 bits for tag, on
+ * 32-bit platforms 32 bits are used for both. Pool aborts
+ * with qFatal() if node address does not fit into pointer
+ * bits (e.g. with 5-level paging).
+ *
+ * The tag wraps around after 65536 (2^32 on 32-bit platforms)
+ * updates of the head: ABA is still possible if pop() is
+ * suspended between reading the head and CAS, while other
+ * threads perform exactly multiple of that number of updates
+ * and the same node is on top again.
+ *
+ * \note nodes pushed into the pool must stay in addressable
+ * memory while pool is in use, since concurrent pop() may
+ * read the link of node that has just been taken by other
+ * thread (the CAS will fail in that case). The link is an
+ * atomic, so such read is not a data race.
+ */
+template<class T>
+class QtMemoryPool<T, QtLockFree>
+{
+    Q_STATIC_ASSERT_X(sizeof(T) >= sizeof(void*),
+                  "size of T must be greater of equal than size of pointer");
+    Q_DISABLE_COPY(QtMemoryPool)
+
+#if QT_POINTER_SIZE == 8
+    enum { _TagShift = 48 };
+#else
+    enum { _TagShift = 32 };
+#endif
+    static const quint64 _PtrMask = (Q_UINT64_C(1) << _TagShift) - 1;
+
+public:
+    QtMemoryPool()
+        : _Head(0)
+    {	// construct with empty list
+    }
+
+    inline ~QtMemoryPool() {
+        // no concurrent access is allowed at this point
+        Node *_Ptr = _Unpack(_Head.load(std::memory_order_acquire));
+        while (_Ptr != Q_NULLPTR) {
+            Node *_Next = _Ptr->_Next.load(std::memory_order_relaxed);
+            delete reinterpret_cast<T*>(_Ptr);
+            _Ptr = _Next;
+        }
+    }
+
+    inline void push(T *_Ptr)
+    {	// push single node onto free list
+        push(_Ptr, _Ptr);
+    }
+
+    inline void push(T *_First, T *_Last)
+    {	// push already linked chain [_First, _Last] onto free list with single CAS
+        Node *_Front = reinterpret_cast<Node*>(_First);
+        Node *_Back = reinterpret_cast<Node*>(_Last);
+        quint64 _Old = _Head.load(std::memory_order_relaxed);
+        do {
+            _Back->_Next.store(_Unpack(_Old), std::memory_order_relaxed);
+        } while (!_Head.compare_exchange_weak(_Old, _Pack(_Front, _Old),
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed));
+    }
+
+    inline T *pop()
+    {	// pop node from free list
+        quint64 _Old = _Head.load(std::memory_order_acquire);
+        Node *_Ptr;
+        do {
+            _Ptr = _Unpack(_Old);
+            if (_Ptr == Q_NULLPTR)
+                break;
+            // node may be popped and reused by other thread right now:
+            // the value read is discarded by failed CAS in that case
+        } while (!_Head.compare_exchange_weak(_Old, _Pack(_Ptr->_Next.load(std::memory_order_relaxed), _Old),
+                                              std::memory_order_acquire,
+                                              std::memory_order_acquire));
+        return reinterpret_cast<T*>(_Ptr);
+    }
+
+    /*!
+     * \brief Link nodes into chain suitable for push(T*, T*)
+     */
+    static inline void link(T *_Ptr, T *_Next) {
+        reinterpret_cast<Node*>(_Ptr)->_Next.store(reinterpret_cast<Node*>(_Next), std::memory_order_relaxed);
+    }
+
+    /*!
+     * \brief Return node that follows \a _Ptr in chain
+     */
+    static inline T *next(T *_Ptr) {
+        return reinterpret_cast<T*>(reinterpret_cast<Node*>(_Ptr)->_Next.load(std::memory_order_relaxed));
+    }
+
+private:
+    struct Node
+    {	// list node
+        std::atomic<Node*> _Next;
+    };
+    Q_STATIC_ASSERT_X(sizeof(Node) == sizeof(void*),
+                      "atomic pointer must have the size of pointer");
+
+    static inline Node *_Unpack(quint64 _Value) {
+        return reinterpret_cast<Node*>(quintptr(_Value & _PtrMask));
+    }
+
+    static inline quint64 _Pack(Node *_Ptr, quint64 _Prev) {
+        // increment tag of previous head value
+        const quint64 _Tag = ((_Prev >> _TagShift) + 1) << _TagShift;
+        if (Q_UNLIKELY((quint64(quintptr(_Ptr)) & ~_PtrMask) != 0))
+            qFatal("QtMemoryPool: node address does not fit into %d bits", int(_TagShift));
+        return (quint64(quintptr(_Ptr)) & _PtrMask) | _Tag;
+    }
+
+    alignas(64) std::atomic<quint64> _Head;
+    char _Padding[64 - sizeof(std::atomic<quint64>)]; // avoid false sharing with neighbours
+};
+
+
+
+/*!
+ * \brief The QtMemoryPoolMagazine class
+ *
+ * Thread-local cache (magazine) for lock-free QtMemoryPool.
+ *
+ * Magazine must be owned by a single thread: push() and pop()
+ * operate on private list and does not touch shared memory
+ * until magazine becomes full or empty. When capacity is
+ * exceeded the whole batch is handed back to the global list
+ * with single CAS, when magazine is empty it is refilled with
+ * up to half of capacity nodes from the global list.
+ *
+ * Magazine returns all cached nodes back into the pool on
+ * destruction.
+ *
+ * \code
+ * QtMemoryPool<Item, QtLockFree> pool; // shared between threads
+ * ...
+ * // in worker thread
+ * QtMemoryPoolMagazine<Item> cache(pool);
+ * Item* item = cache.pop();
+ * ...
+ * cache.push(item);
+ * \endcode
+ */
+template<class T>
+class QtMemoryPoolMagazine
+{
+    Q_DISABLE_COPY(QtMemoryPoolMagazine)
+public:
+    typedef QtMemoryPool<T, QtLockFree> pool_type;
+
+    explicit QtMemoryPoolMagazine(pool_type& pool, int capacity = 64)
+        : _Pool(pool), _First(Q_NULLPTR), _Last(Q_NULLPTR),
+          _Count(0), _Capacity(capacity > 1 ? capacity : 2)
+    {
+    }
+
+    inline ~QtMemoryPoolMagazine() {
+        flush();
+    }
+
+    inline void push(T *_Ptr)
+    {	// push onto local list, return batch to pool when full
+        if (_Count == _Capacity)
+            flush();
+        pool_type::link(_Ptr, _First);
+        if (_First == Q_NULLPTR)
+            _Last = _Ptr;
+        _First = _Ptr;
+        ++_Count;
+    }
+
+    inline T *pop()
+    {	// pop from local list, refill from pool when empty
+        if (_First == Q_NULLPTR && !refill())
+            return Q_NULLPTR;
+        T *_Ptr = _First;
+        _First = pool_type::next(_Ptr);
+        if (_First == Q_NULLPTR)
+            _Last = Q_NULLPTR;
+        --_Count;
+        return _Ptr;
+    }
+
+    inline void flush()
+    {	// hand all cached nodes back to pool
+        if (_First == Q_NULLPTR)
+            return;
+        _Pool.push(_First, _Last);
+        _First = _Last = Q_NULLPTR;
+        _Count = 0;
+    }
+
+    inline int count() const { return _Count; }
+    inline int capacity() const { return _Capacity; }
+
+private:
+    inline bool refill()
+    {
+        for (int i = 0, n = _Capacity / 2; i < n; i++) {
+            T *_Ptr = _Pool.pop();
+            if (_Ptr == Q_NULLPTR)
+                break;
+            pool_type::link(_Ptr, _First);
+            if (_First == Q_NULLPTR)
+                _Last = _Ptr;
+            _First = _Ptr;
+            ++_Count;
+        }
+        return (_First != Q_NULLPTR);
+    }
+
+    pool_type &_Pool;
+    T *_First;
+    T *_Last;
+    int _Count;
+    int _Capacity;
+};
+
+
+/*!
+ * \brief The QtNullMutex class
+ *
+ * Mutex that does nothing, used by single-threaded pools.
+ */
+class QtNullMutex
+{
+public:
+    inline void lock() {}
+    inline void unlock() {}
+};
+
+namespace QtPrivate
+{
+    template<class _Mutex>
+    struct PoolMutex { typedef _Mutex type; };
+
+    template<>
+    struct PoolMutex<void> { typedef QtNullMutex type; };
+
+    template<class _Mutex>
+    class PoolLocker
+    {
+        Q_DISABLE_COPY(PoolLocker)
+    public:
+        explicit PoolLocker(_Mutex& m) : mtx(m) { mtx.lock(); }
+        ~PoolLocker() { mtx.unlock(); }
+    private:
+        _Mutex& mtx;
+    };
+}
+
+
+
+/*!
+ * \brief The QtSlabArena class
+ *
+ * Untyped slab allocator of fixed-size cells.
+ *
+ * Memory is obtained from the heap in large aligned chunks
+ * and is split into cells of equal size. Freed cells are
+ * kept in internal free list and reused by next allocations.
+ * All chunks are released at once in release() or on
+ * destruction, cells are never returned to the heap
+ * one by one.
+ *
+ * \warning QtSlabArena is not thread-safe.
+ */
+class QtSlabArena
+{
+    Q_DISABLE_COPY(QtSlabArena)
+public:
+    enum { DefaultChunkSize = 64 * 1024, ChunkAlignment = 64 };
+
+    explicit QtSlabArena(size_t cellSize, size_t cellAlign = sizeof(void*),
+                         size_t chunkSize = DefaultChunkSize)
+        : _Free(Q_NULLPTR), _Chunks(Q_NULLPTR),
+          _Cursor(Q_NULLPTR), _End(Q_NULLPTR),
+          _ChunkCount(0)
+    {
+        if (cellAlign < sizeof(void*))
+            cellAlign = sizeof(void*);
+        if (cellSize < sizeof(void*))
+            cellSize = sizeof(void*);
+        _CellSize = (cellSize + cellAlign - 1) & ~(cellAlign - 1);
+        _CellAlign = cellAlign;
+        _HeaderSize = (sizeof(Chunk) + cellAlign - 1) & ~(cellAlign - 1);
+        _ChunkSize = chunkSize;
+        if (_ChunkSize < _HeaderSize + _CellSize)
+            _ChunkSize = _HeaderSize + _CellSize;
+    }
+
+    inline ~QtSlabArena() {
+        release();
+    }
+
+    inline void *allocate()
+    {
+        if (_Free != Q_NULLPTR) { // reuse freed cell
+            Cell *_Ptr = _Free;
+            _Free = _Free->_Next;
+            return _Ptr;
+        }
+        if (_Cursor == _End)
+            grow();
+        void *_Ptr = _Cursor;
+        _Cursor += _CellSize;
+        return _Ptr;
+    }
+
+    inline void deallocate(void *_Ptr)
+    {
+        if (_Ptr == Q_NULLPTR)
+            return;
+        Cell *_Node = static_cast<Cell*>(_Ptr);
+        _Node->_Next = _Free;
+        _Free = _Node;
+    }
+
+    /*!
+     * \brief release all chunks at once.
+     * \warning all cells allocated from arena
+     * became invalid after this call
+     */
+    inline void release()
+    {
+        while (_Chunks != Q_NULLPTR) {
+            Chunk *_Next = _Chunks->_Next;
+            qFreeAligned(_Chunks);
+            _Chunks = _Next;
+        }
+        _Free = Q_NULLPTR;
+        _Cursor = _End = Q_NULLPTR;
+        _ChunkCount = 0;
+    }
+
+    inline size_t cellSize() const { return _CellSize; }
+    inline size_t chunkSize() const { return _ChunkSize; }
+    inline size_t chunkCount() const { return _ChunkCount; }
+    inline size_t bytesReserved() const { return _ChunkCount * _ChunkSize; }
+
+private:
+    struct Cell { Cell *_Next; };
+    struct Chunk { Chunk *_Next; };
+
+    inline void grow()
+    {
+        const size_t _Align = qMax(_CellAlign, size_t(ChunkAlignment));
+        void *_Mem = qMallocAligned(_ChunkSize, _Align);
+        if (_Mem == Q_NULLPTR)
+            throw std::bad_alloc();
+
+        Chunk *_Chunk = static_cast<Chunk*>(_Mem);
+        _Chunk->_Next = _Chunks;
+        _Chunks = _Chunk;
+        ++_ChunkCount;
+
+        char *_Begin = static_cast<char*>(_Mem) + _HeaderSize;
+        _Cursor = _Begin;
+        _End = _Begin + ((_ChunkSize - _HeaderSize) / _CellSize) * _CellSize;
+    }
+
+    Cell *_Free;
+    Chunk *_Chunks;
+    char *_Cursor;
+    char *_End;
+    size_t _CellSize;
+    size_t _CellAlign;
+    size_t _HeaderSize;
+    size_t _ChunkSize;
+    size_t _ChunkCount;
+};
+
+
+
+/*!
+ * \brief The QtSlabPool class
+ *
+ * Typed slab pool of objects of type T.
+ *
+ * Unlike QtMemoryPool, which keeps only a free list
+ * of objects allocated by caller, QtSlabPool owns the
+ * memory: cells are carved from large aligned chunks
+ * and all chunks are freed at once when pool is destroyed.
+ *
+ * \tparam T type of objects
+ * \tparam _Mutex locking policy (void - no locking, QtSpinLock,
+ * QMutex or any class with lock()/unlock() methods)
+ *
+ * \code
+ * QtSlabPool<Node> pool;
+ * Node* node = pool.create(key, value);
+ * ...
+ * pool.destroy(node);
+ * \endcode
+ *
+ * \warning destructors of objects that are still alive
+ * when pool is destroyed are not called.
+ */
+template<class T, class _Mutex = void>
+class QtSlabPool
+{
+    Q_DISABLE_COPY(QtSlabPool)
+    typedef typename QtPrivate::PoolMutex<_Mutex>::type mutex_type;
+    typedef QtPrivate::PoolLocker<mutex_type> locker_type;
+public:
+    explicit QtSlabPool(size_t chunkSize = QtSlabArena::DefaultChunkSize)
+        : _Arena(sizeof(T), Q_ALIGNOF(T), chunkSize)
+    {
+    }
+
+    inline T *allocate()
+    {	// allocate uninitialized cell
+        locker_type _Lock(mtx);
+        return static_cast<T*>(_Arena.allocate());
+    }
+
+    inline void deallocate(T *_Ptr)
+    {	// return uninitialized cell
+        locker_type _Lock(mtx);
+        _Arena.deallocate(_Ptr);
+    }
+
+    template<class... _Args>
+    inline T *create(_Args&&... _Vals)
+    {	// allocate and construct object
+        T *_Ptr = allocate();
+        try {
+            return ::new (static_cast<void*>(_Ptr)) T(std::forward<_Args>(_Vals)...);
+        } catch (...) {
+            deallocate(_Ptr);
+            throw;
+        }
+    }
+
+    inline void destroy(T *_Ptr)
+    {	// destruct and deallocate object
+        if (_Ptr == Q_NULLPTR)
+            return;
+        _Ptr->~T();
+        deallocate(_Ptr);
+    }
+
+    inline void release()
+    {	// free all chunks at once
+        locker_type _Lock(mtx);
+        _Arena.release();
+    }
+
+    inline size_t chunkCount() const { return _Arena.chunkCount(); }
+    inline size_t bytesReserved() const { return _Arena.bytesReserved(); }
+
+private:
+    QtSlabArena _Arena;
+    mutex_type mtx;
+};
+
+
+
+/*!
+ * \brief The QtSlabResource class
+ *
+ * Set of slab arenas for different size classes,
+ * shared by all QtSlabAllocator instances that
+ * was created from this resource (including rebound ones).
+ *
+ * Requests up to MaxCellSize bytes are served from arena
+ * of corresponding size class, larger requests are
+ * forwarded to global operator new. Requests aligned
+ * stricter than Granularity are served by qMallocAligned().
+ *
+ * \warning QtSlabResource is not thread-safe unless
+ * mutex type is specified.
+ */
+template<class _Mutex = void>
+class QtSlabResource
+{
+    Q_DISABLE_COPY(QtSlabResource)
+    typedef typename QtPrivate::PoolMutex<_Mutex>::type mutex_type;
+    typedef QtPrivate::PoolLocker<mutex_type> locker_type;
+public:
+    enum {
+        Granularity = 16,
+        MaxCellSize = 512,
+        ClassCount = MaxCellSize / Granularity
+    };
+
+    explicit QtSlabResource(size_t chunkSize = QtSlabArena::DefaultChunkSize)
+        : _ChunkSize(chunkSize)
+    {
+        for (int i = 0; i < ClassCount; i++)
+            _Arenas[i] = Q_NULLPTR;
+    }
+
+    inline ~QtSlabResource() {
+        for (int i = 0; i < ClassCount; i++)
+            delete _Arenas[i];
+    }
+
+    inline void *allocate(size_t size, size_t align)
+    {
+        if (align > Granularity) {
+            void *_Ptr = qMallocAligned(size, align);
+            if (_Ptr == Q_NULLPTR)
+                throw std::bad_alloc();
+            return _Ptr;
+        }
+        if (size > MaxCellSize)
+            return ::operator new(size);
+
+        locker_type _Lock(mtx);
+        return arena(size).allocate();
+    }
+
+    inline void deallocate(void *_Ptr, size_t size, size_t align)
+    {
+        if (align > Granularity) {
+            qFreeAligned(_Ptr);
+            return;
+        }
+        if (size > MaxCellSize) {
+            ::operator delete(_Ptr);
+            return;
+        }
+        locker_type _Lock(mtx);
+        arena(size).deallocate(_Ptr);
+    }
+
+    inline size_t bytesReserved() const
+    {
+        size_t _Total = 0;
+        for (int i = 0; i < ClassCount; i++)
+            if (_Arenas[i] != Q_NULLPTR)
+                _Total += _Arenas[i]->bytesReserved();
+        return _Total;
+    }
+
+private:
+    inline QtSlabArena &arena(size_t size)
+    {
+        const size_t _Index = size == 0 ? 0 : (size - 1) / Granularity;
+        QtSlabArena *&_Arena = _Arenas[_Index];
+        if (_Arena == Q_NULLPTR)
+            _Arena = new QtSlabArena((_Index + 1) * Granularity, Granularity, _ChunkSize);
+        return *_Arena;
+    }
+
+    QtSlabArena *_Arenas[ClassCount];
+    size_t _ChunkSize;
+    mutex_type mtx;
+};
+
+
+
+/*!
+ * \brief The QtSlabAllocator class
+ *
+ * std::allocator-compatible adaptor over QtSlabResource.
+ *
+ * Allows standard containers (std::vector, std::list,
+ * std::unordered_map, etc.) to draw memory from slab
+ * arenas. Node-based containers benefit the most, since
+ * each node allocation turns into a free list pop instead
+ * of heap allocation.
+ *
+ * \code
+ * QtSlabResource<> resource;
+ * typedef QtSlabAllocator<std::pair<const int, QVariant>> Alloc;
+ * std::unordered_map<int, QVariant, std::hash<int>, std::equal_to<int>, Alloc>
+ *         cache(0, std::hash<int>(), std::equal_to<int>(), Alloc(&resource));
+ * \endcode
+ *
+ * \note resource must outlive all containers that use it.
+ */
+template<class T, class _Mutex = void>
+class QtSlabAllocator
+{
+public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+    typedef QtSlabResource<_Mutex> resource_type;
+
+    template<class U>
+    struct rebind { typedef QtSlabAllocator<U, _Mutex> other; };
+
+    explicit QtSlabAllocator(resource_type *resource) Q_DECL_NOTHROW
+        : _Resource(resource)
+    {
+        Q_ASSERT(resource != Q_NULLPTR);
+    }
+
+    template<class U>
+    QtSlabAllocator(const QtSlabAllocator<U, _Mutex>& other) Q_DECL_NOTHROW
+        : _Resource(other.resource())
+    {
+    }
+
+    inline T *allocate(size_t n)
+    {
+        return static_cast<T*>(_Resource->allocate(n * sizeof(T), Q_ALIGNOF(T)));
+    }
+
+    inline void deallocate(T *p, size_t n)
+    {
+        _Resource->deallocate(p, n * sizeof(T), Q_ALIGNOF(T));
+    }
+
+    inline resource_type *resource() const Q_DECL_NOTHROW { return _Resource; }
+
+private:
+    resource_type *_Resource;
+};
+
+template<class T, class U, class _Mutex>
+inline bool operator==(const QtSlabAllocator<T, _Mutex>& lhs, const QtSlabAllocator<U, _Mutex>& rhs)
+{
+    return lhs.resource() == rhs.resource();
+}
+
+template<class T, class U, class _Mutex>
+inline bool operator!=(const QtSlabAllocator<T, _Mutex>& lhs, const QtSlabAllocator<U, _Mutex>& rhs)
+{
+    return lhs.resource() != rhs.resource();
+}
+
 #endif // QTMEMORYPOOL_H
@@ -2,11 +2,306 @@
 #include <QMetaObject>
 #include <QMetaMethod>
 #include <QMetaClassInfo>
+#include <QThread>
+#include <QThreadPool>
+#include <QAbstractEventDispatcher>
+#include <QRunnable>
+#include <QPointer>
+#include <QFutureInterface>
 #include <QDebug>
 
+#include <memory>
+
 #include "qtmethodinvoker.h"
 
 
+namespace
+{
+inline bool isCompatible(const QMetaObject* metaObject, const QMetaObject* base)
+{
+    for (; metaObject != Q_NULLPTR; metaObject = metaObject->superClass())
+        if (metaObject == base)
+            return true;
+    return false;
+}
+
+/*
+ * Check arguments \a args against parameter types of \a handle
+ * and fill \a argv for QMetaObject::metacall(), \a result
+ * storage is reused if it already holds value of return type
+ */
+bool prepareCall(const QtMethodInvoker::Handle& handle, const QVariantList& args, QVariant& result, void** argv)
+{
+    if (!handle.isValid())
+        return false;
+
+    const int n = handle.parameterCount();
+    if (n != args.size()) { // incorrect number of args
+        qWarning() << "incorrect number of arguemnts while invoking" << handle.key();
+        return false;
+    }
+    if (n > 10) {
+        qWarning() << "too many arguments to invoke" << handle.key();
+        return false;
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        const QVariant& arg = args.at(i);
+        if (arg.userType() != handle.parameterType(i)) {
+            qWarning() << "argument [" << i << "] type mismatch: (expected:"
+                       << QMetaType::typeName(handle.parameterType(i))
+                       << "actual:" << arg.typeName()
+                       << ") while invoking" << handle.method().name()
+                       << "method {aka" << handle.key() << "}";
+            return false;
+        }
+        argv[i + 1] = const_cast<void*>(arg.constData());
+    }
+
+    const int type = handle.returnType();
+    if (type == QMetaType::Void || type == QMetaType::UnknownType) {
+        argv[0] = Q_NULLPTR;
+    } else {
+        if (result.userType() != type) // reuse result storage if possible
+            result = QVariant(type, Q_NULLPTR);
+        argv[0] = result.data();
+    }
+    return true;
+}
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+/*
+ * Posted events are delivered only by thread that runs
+ * event dispatcher: finished threads and adopted (non-Qt)
+ * threads never process them. Thread that was not started
+ * yet will process events as soon as it starts.
+ */
+inline bool canPostTo(QThread* thread)
+{
+    if (thread->isFinished())
+        return false;
+    return (!thread->isRunning() || QAbstractEventDispatcher::instance(thread) != Q_NULLPTR);
+}
+
+struct BatchItem
+{
+    int index;
+    QObject* object;           // dereferenced in pool only (DirectOnPool)
+    QPointer<QObject> guard;   // dereferenced in thread of object only
+    QtMethodInvoker::Handle handle;
+    QVariantList args;
+};
+typedef QVector<BatchItem> BatchGroup;
+
+/*
+ * State shared between all parts of single batch
+ */
+class BatchState
+{
+public:
+    QFutureInterface<QVariant> future;
+    QAtomicInt pending;
+
+    /*
+     * Invoke calls of \a group in thread of its objects
+     */
+    void run(const BatchGroup& group)
+    {
+        QVariant result;
+        for (auto it = group.cbegin(); it != group.cend(); ++it)
+        {
+            QObject* object = it->guard.data();
+            if (object == Q_NULLPTR || !it->handle.invoke(object, it->args, result))
+                result = QVariant();
+            future.reportResult(result, it->index);
+        }
+        finishPart();
+    }
+
+    /*
+     * Invoke calls of \a group in current (pool) thread regardless
+     * of objects thread affinity: caller of invokeBatch() guarantees
+     * that methods are thread-safe and objects outlive the batch
+     */
+    void runDirect(const BatchGroup& group)
+    {
+        QVariant result;
+        void* argv[11];
+        for (auto it = group.cbegin(); it != group.cend(); ++it)
+        {
+            QObject* object = it->object;
+            const bool ok = prepareCall(it->handle, it->args, result, argv) &&
+                            isCompatible(object->metaObject(), it->handle.method().enclosingMetaObject()) &&
+                            QMetaObject::metacall(object, QMetaObject::InvokeMetaMethod, it->handle.method().methodIndex(), argv) < 0;
+            if (!ok)
+                result = QVariant();
+            future.reportResult(result, it->index);
+        }
+        finishPart();
+    }
+
+    /*
+     * Report invalid results for all calls of \a group
+     */
+    void fail(const BatchGroup& group)
+    {
+        for (auto it = group.cbegin(); it != group.cend(); ++it)
+            future.reportResult(QVariant(), it->index);
+        finishPart();
+    }
+
+private:
+    void finishPart()
+    {
+        if (!pending.deref())
+            future.reportFinished();
+    }
+};
+
+/*
+ * Group posted into thread of target objects. If posted event
+ * is discarded without being delivered (context object was
+ * destroyed or thread exited before processing events) the
+ * group is reported as failed, so batch future always finishes.
+ */
+class BatchTask
+{
+    Q_DISABLE_COPY(BatchTask)
+public:
+    BatchTask(const std::shared_ptr<BatchState>& s, const BatchGroup& g) :
+        state(s), group(g), done(false) {
+    }
+
+    ~BatchTask() {
+        if (!done)
+            state->fail(group);
+    }
+
+    void run() {
+        done = true;
+        state->run(group);
+    }
+
+private:
+    std::shared_ptr<BatchState> state;
+    BatchGroup group;
+    bool done;
+};
+
+class BatchRunnable :
+        public QRunnable
+{
+public:
+    BatchRunnable(const std::shared_ptr<BatchState>& s, const BatchGroup& g) :
+        state(s), group(g) {
+    }
+
+    void run() Q_DECL_OVERRIDE {
+        state->runDirect(group);
+    }
+
+private:
+    std::shared_ptr<BatchState> state;
+    BatchGroup group;
+};
+#endif
+}
+
+
+QtMethodInvoker::Handle::Handle()
+{
+}
+
+QtMethodInvoker::Handle::Handle(const QByteArray &key, const QMetaMethod &method) :
+    mKey(key), mMethod(method)
+{
+    const int n = method.parameterCount();
+    mTypes.resize(n + 1);
+    mTypes[0] = method.returnType();
+    for (int i = 0; i < n; i++)
+        mTypes[i + 1] = method.parameterType(i);
+}
+
+bool QtMethodInvoker::Handle::isValid() const
+{
+    return mMethod.isValid();
+}
+
+const QMetaMethod &QtMethodInvoker::Handle::method() const
+{
+    return mMethod;
+}
+
+QByteArray QtMethodInvoker::Handle::key() const
+{
+    return mKey;
+}
+
+int QtMethodInvoker::Handle::parameterCount() const
+{
+    return (mTypes.isEmpty() ? 0 : mTypes.size() - 1);
+}
+
+int QtMethodInvoker::Handle::parameterType(int i) const
+{
+    return (i >= 0 && i + 1 < mTypes.size() ? mTypes[i + 1] : QMetaType::UnknownType);
+}
+
+int QtMethodInvoker::Handle::returnType() const
+{
+    return (mTypes.isEmpty() ? QMetaType::UnknownType : mTypes[0]);
+}
+
+bool QtMethodInvoker::Handle::invoke(QObject *object, const QVariantList &args, QVariant &result) const
+{
+    void* argv[11];
+    return (prepareCall(*this, args, result, argv) && invoke(object, argv));
+}
+
+bool QtMethodInvoker::Handle::invoke(QObject *object, const QVariantList &args) const
+{
+    QVariant result;
+    return invoke(object, args, result);
+}
+
+bool QtMethodInvoker::Handle::invoke(QObject *object, void **argv) const
+{
+    if (object == Q_NULLPTR || !isValid())
+        return false;
+
+    if (!isCompatible(object->metaObject(), mMethod.enclosingMetaObject())) {
+        qWarning() << "object" << object << "is incompatible with method {aka" << mKey << "}";
+        return false;
+    }
+
+    if (object->thread() == QThread::currentThread()) {
+        // direct call: no type name normalization or comparison
+        return (QMetaObject::metacall(object, QMetaObject::InvokeMetaMethod, mMethod.methodIndex(), argv) < 0);
+    }
+
+    // cross-thread call goes through the regular path
+    const int n = parameterCount();
+    if (n > 10) {
+        qWarning() << "too many arguments to invoke" << mKey << "across threads";
+        return false;
+    }
+    QGenericArgument ga[10];
+    for (int i = 0; i < n; i++)
+        ga[i] = QGenericArgument(QMetaType::typeName(mTypes[i + 1]), argv[i + 1]);
+
+    if (argv[0] != Q_NULLPTR) {
+        QGenericReturnArgument resultArg(mMethod.typeName(), argv[0]);
+        return mMethod.invoke(object, Qt::AutoConnection, resultArg,
+                              ga[0], ga[1], ga[2], ga[3], ga[4],
+                              ga[5], ga[6], ga[7], ga[8], ga[9]);
+    }
+    return mMethod.invoke(object, Qt::AutoConnection,
+                          ga[0], ga[1], ga[2], ga[3], ga[4],
+                          ga[5], ga[6], ga[7], ga[8], ga[9]);
+}
+
+
 
 QtMethodInvoker::QtMethodInvoker()
 {
@@ -71,7 +366,7 @@ const QMetaObject *QtMethodInvoker::metaObject() const
 
 bool QtMethodInvoker::invoke(QObject* object, const QString &key, const QVariantList &args, QVariant &result) const
 {
-    auto it = lookup(key.toLatin1()); // lookup for a key
+    auto it = lookup(key); // lookup for a key
     if (it == mapping.cend()) {
         qWarning() << "requested method key" << key << "not found";
         return false;
@@ -97,12 +392,10 @@ bool QtMethodInvoker::invoke(QObject* object, const QString &key, const QVariant
         }
         ga[i] = QGenericArgument(argIt->typeName(), argIt->data());
     }
-    int type = QMetaType::type(it->typeName());
-    result = QVariant(type);
+    const int type = it->returnType();
+    if (result.userType() != type)
+        result = QVariant(type, Q_NULLPTR);
     QGenericReturnArgument resultArg( it->typeName(), const_cast<void*>(result.data()) );
-#ifndef QT_NO_DEBUG
-    qDebug() << "INVOKING:" << it->methodSignature();
-#endif
     // do invoke
     return it->invoke(object, Qt::AutoConnection, resultArg,
                       ga[0], ga[1], ga[2], ga[3], ga[4],
@@ -111,7 +404,7 @@ bool QtMethodInvoker::invoke(QObject* object, const QString &key, const QVariant
 
 bool QtMethodInvoker::invoke(QObject* object, const QString &key, const QVariantList &args) const
 {
-    auto it = lookup(key.toLatin1());
+    auto it = lookup(key);
     if (it == mapping.cend()) {
         qWarning() << "requested method key" << key << "not found";
         return false;
@@ -138,9 +431,6 @@ bool QtMethodInvoker::invoke(QObject* object, const QString &key, const QVariant
         ga[i] = QGenericArgument(argIt->typeName(), argIt->data());
     }
 
-#ifndef QT_NO_DEBUG
-    qDebug() << "INVOKING:" << it->methodSignature();
-#endif
     return it->invoke(object, Qt::AutoConnection,
                       ga[0], ga[1], ga[2], ga[3], ga[4],
                       ga[5], ga[6], ga[7], ga[8], ga[9]);
@@ -154,14 +444,11 @@ bool QtMethodInvoker::invoke(QObject *object, const QString &key,
                              QGenericArgument val6, QGenericArgument val7,
                              QGenericArgument val8, QGenericArgument val9) const
 {
-    auto it = lookup(key.toLatin1());
+    auto it = lookup(key);
     if (it == mapping.cend()) {
         qWarning() << "requested method key" << key << "not found";
         return false;
     }
-#ifndef QT_NO_DEBUG
-    qDebug() << "INVOKING:" << it->methodSignature();
-#endif
     return it->invoke(object, Qt::AutoConnection, returnValue,
                       val0, val1, val2, val3, val4,
                       val5, val6, val7, val8, val9);
@@ -174,14 +461,11 @@ bool QtMethodInvoker::invoke(QObject *object, const QString &key,
                              QGenericArgument val6, QGenericArgument val7,
                              QGenericArgument val8, QGenericArgument val9) const
 {
-    auto it = lookup(key.toLatin1());
+    auto it = lookup(key);
     if (it == mapping.cend()) {
         qWarning() << "requested method key" << key << "not found";
         return false;
     }
-#ifndef QT_NO_DEBUG
-    qDebug() << "INVOKING:" << it->methodSignature();
-#endif
     return it->invoke(object, Qt::AutoConnection,
                       val0, val1, val2, val3, val4,
                       val5, val6, val7, val8, val9);
@@ -195,14 +479,11 @@ bool QtMethodInvoker::invokeMethod(void *gadget, const QString &key,
                                    QGenericArgument val6, QGenericArgument val7,
                                    QGenericArgument val8, QGenericArgument val9) const
 {
-    auto it = lookup(key.toLatin1());
+    auto it = lookup(key);
     if (it == mapping.cend()) {
         qWarning() << "requested method key" << key << "not found";
         return false;
     }
-#ifndef QT_NO_DEBUG
-    qDebug() << "INVOKING:" << it->methodSignature();
-#endif
     return it->invokeOnGadget(gadget, returnValue,
                       val0, val1, val2, val3, val4,
                       val5, val6, val7, val8, val9);
@@ -215,14 +496,11 @@ bool QtMethodInvoker::invokeMethod(void *gadget, const QString &key,
                                    QGenericArgument val6, QGenericArgument val7,
                                    QGenericArgument val8, QGenericArgument val9) const
 {
-    auto it = lookup(key.toLatin1());
+    auto it = lookup(key);
     if (it == mapping.cend()) {
         qWarning() << "requested method key" << key << "not found";
         return false;
     }
-#ifndef QT_NO_DEBUG
-    qDebug() << "INVOKING:" << it->methodSignature();
-#endif
     return it->invokeOnGadget(gadget,
                       val0, val1, val2, val3, val4,
                       val5, val6, val7, val8, val9);
@@ -231,7 +509,7 @@ bool QtMethodInvoker::invokeMethod(void *gadget, const QString &key,
 
 bool QtMethodInvoker::createArgs(const QString &key, QVariantList &args) const
 {
-    auto it = lookup(key.toLatin1());
+    auto it = lookup(key);
     if (it == mapping.cend())
         return false;
 
@@ -244,3 +522,97 @@ bool QtMethodInvoker::createArgs(const QString &key, QVariantList &args) const
     return true;
 }
 
+QtMethodInvoker::Handle QtMethodInvoker::handle(const QString &key) const
+{
+    auto it = lookup(key);
+    if (it == mapping.cend())
+        return Handle();
+    return Handle(it.key(), it.value());
+}
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+QFuture<QVariant> QtMethodInvoker::invokeAsync(QObject *object, const QString &key, const QVariantList &args) const
+{
+    QVector<Call> calls;
+    calls.push_back(Call(object, key, args));
+    return invokeBatch(calls);
+}
+
+QFuture<QVariant> QtMethodInvoker::invokeBatch(const QVector<Call> &calls, QThreadPool *pool, BatchMode mode) const
+{
+    std::shared_ptr<BatchState> state = std::make_shared<BatchState>();
+    state->future.reportStarted();
+    QFuture<QVariant> future = state->future.future();
+
+    // resolve keys once and group calls by thread affinity
+    QThread* current = QThread::currentThread();
+    const bool direct = (pool != Q_NULLPTR && mode == DirectOnPool);
+    QHash<QString, Handle> handles;
+    QHash<QThread*, BatchGroup> groups;
+    BatchGroup directGroup;
+    BatchItem item;
+    for (int i = 0, n = calls.size(); i < n; i++)
+    {
+        const Call& call = calls[i];
+        auto it = handles.find(call.key);
+        if (it == handles.end())
+            it = handles.insert(call.key, handle(call.key));
+
+        if (call.object == Q_NULLPTR || !it->isValid()) {
+            qWarning() << "requested method key" << call.key << "not found";
+            state->future.reportResult(QVariant(), i);
+            continue;
+        }
+        item.index = i;
+        item.handle = it.value();
+        item.args = call.args;
+        QThread* thread = call.object->thread();
+        if (direct && thread == current) {
+            item.object = call.object;
+            item.guard.clear();
+            directGroup.push_back(item);
+        } else {
+            item.object = Q_NULLPTR;
+            item.guard = call.object;
+            groups[thread].push_back(item);
+        }
+    }
+
+    // split calling thread group into chunks for pool
+    QVector<BatchGroup> chunks;
+    if (!directGroup.isEmpty())
+    {
+        const int chunkCount = qMax(1, pool->maxThreadCount());
+        const int chunkSize = (directGroup.size() + chunkCount - 1) / chunkCount;
+        for (int i = 0; i < directGroup.size(); i += chunkSize)
+            chunks.push_back(directGroup.mid(i, chunkSize));
+    }
+
+    const int tasks = groups.size() + chunks.size();
+    if (tasks == 0) {
+        state->future.reportFinished();
+        return future;
+    }
+    state->pending.store(tasks);
+
+    for (auto it = chunks.cbegin(); it != chunks.cend(); ++it)
+        pool->start(new BatchRunnable(state, *it));
+
+    for (auto it = groups.cbegin(); it != groups.cend(); ++it)
+    {
+        QObject* context = it->first().guard.data();
+        if (context == Q_NULLPTR || !canPostTo(it.key())) {
+            qWarning() << "thread" << it.key() << "does not process events, batch calls failed";
+            state->fail(it.value());
+            continue;
+        }
+        // post whole group as single event into target thread,
+        // any object of group may serve as context
+        std::shared_ptr<BatchTask> task = std::make_shared<BatchTask>(state, it.value());
+        QMetaObject::invokeMethod(context, [task]() {
+            task->run();
+        }, Qt::QueuedConnection);
+    }
+    return future;
+}
+#endif
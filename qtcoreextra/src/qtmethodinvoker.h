@@ -3,10 +3,14 @@
 
 #include <QObject>
 #include <QHash>
+#include <QMetaMethod>
+#include <QVector>
+#include <QFuture>
 
 #include <QtCoreExtra>
 
 class QVariant;
+class QThreadPool;
 
 /*!
  * \brief The QtMethodInvoker class
@@ -42,6 +46,78 @@ public:
      */
     typedef QHash<QByteArray, QMetaMethod> MethodMap;
 
+    /*!
+     * \brief The Handle class
+     *
+     * Precompiled call handle for a single mapped method.
+     *
+     * Handle is resolved once by key with QtMethodInvoker::handle()
+     * and caches the meta-method, its parameter and return type
+     * ids. Subsequent invocations do not perform any string
+     * conversions, hash lookups or type name comparisons:
+     * argument types are checked by type id and, when target
+     * object lives in the current thread, method is called
+     * directly through QMetaObject::metacall().
+     *
+     * \code
+     * QtMethodInvoker invoker(&Calculator::staticMetaObject);
+     * QtMethodInvoker::Handle sum = invoker.handle("sum");
+     * QVariant result;
+     * for (...)
+     *     sum.invoke(calculator, args, result); // result storage is reused
+     * \endcode
+     */
+    class QTCOREEXTRA_EXPORT Handle
+    {
+    public:
+        Handle();
+
+        bool isValid() const;
+        const QMetaMethod& method() const;
+        QByteArray key() const;
+
+        int parameterCount() const;
+        int parameterType(int i) const;
+        int returnType() const;
+
+        /*!
+         * \brief invoke
+         *
+         * Invoke method on \a object with arguments \a args and
+         * store invocation result in \a result. If \a result already
+         * holds value of method return type its storage is reused.
+         * \return true on successfull invokation, otherwise return false
+         */
+        bool invoke(QObject* object, const QVariantList& args, QVariant& result) const;
+        /*!
+         * \brief invoke
+         *
+         * Invoke method on \a object with arguments \a args,
+         * result of invocation is ignored.
+         * \return true on successfull invokation, otherwise return false
+         */
+        bool invoke(QObject* object, const QVariantList& args) const;
+        /*!
+         * \brief invoke
+         *
+         * Invoke method on \a object with pre-typed arguments
+         * \a argv, where argv[0] points to return value storage
+         * (may be null) and argv[1]...argv[parameterCount()] points
+         * to arguments of exact parameter types.
+         * \warning no type checking is performed.
+         * \return true on successfull invokation, otherwise return false
+         */
+        bool invoke(QObject* object, void** argv) const;
+
+    private:
+        friend class QtMethodInvoker;
+        Handle(const QByteArray& key, const QMetaMethod& method);
+
+        QByteArray mKey;
+        QMetaMethod mMethod;
+        QVector<int> mTypes; // [0] - return type, [1..n] - parameter types
+    };
+
     /*!
      * \brief QtMethodInvoker
      *
@@ -255,6 +331,96 @@ public:
      */
     bool createArgs(const QString& key, QVariantList& args) const;
 
+    /*!
+     * \brief handle
+     *
+     * Resolve method with key \a key into precompiled call handle.
+     * \param key method key
+     * \return call handle, if key was not found invalid
+     * handle is returned
+     */
+    Handle handle(const QString& key) const;
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+    /*!
+     * \brief The BatchMode enum
+     *
+     * Defines how invokeBatch() uses thread pool
+     */
+    enum BatchMode
+    {
+        PostToOwnerThread, //!< every call is made in the thread of its object
+        DirectOnPool       //!< calls on objects of calling thread are made on pool threads
+    };
+
+    /*!
+     * \brief The Call struct
+     *
+     * Single invocation request for invokeBatch()
+     */
+    struct Call
+    {
+        Call() : object(Q_NULLPTR) {}
+        Call(QObject* o, const QString& k, const QVariantList& a = QVariantList()) :
+            object(o), key(k), args(a) {}
+
+        QObject* object;
+        QString key;
+        QVariantList args;
+    };
+
+    /*!
+     * \brief invokeAsync
+     *
+     * Asynchronously invoke method specified by \a key on object
+     * \a object with arguments \a args. Method is called in the
+     * thread of \a object on next event loop iteration.
+     * \return future that holds invokation result, if invokation
+     * failed result is invalid QVariant
+     * \note this function is supported for Qt 5.10.0 and higher
+     */
+    QFuture<QVariant> invokeAsync(QObject* object, const QString& key, const QVariantList& args) const;
+
+    /*!
+     * \brief invokeBatch
+     *
+     * Asynchronously invoke many methods at once.
+     *
+     * Method keys are resolved once in the calling thread, then
+     * calls are grouped by thread affinity of target objects and
+     * every group is posted to its thread as single event instead
+     * of one event per call.
+     *
+     * By default (\a mode is PostToOwnerThread) thread affinity
+     * is always respected: calls on objects of the calling thread
+     * are posted to it as well, and \a pool is not used.
+     *
+     * With DirectOnPool mode calls on objects that live in the
+     * calling thread are executed on \a pool instead, split into
+     * chunks of pool's maximum thread count. These calls are made
+     * directly with QMetaObject::metacall() from pool threads,
+     * ignoring thread affinity of target objects and without
+     * tracking their destruction: caller must guarantee that
+     * invoked methods are thread-safe and that objects outlive
+     * the returned future.
+     *
+     * Posted groups are delivered by event loop of the target
+     * thread. Target thread must be running
+     * QThread::exec() (or not yet started), calls on objects in
+     * finished threads or in threads without event dispatcher
+     * fail immediately. If posted group is discarded before it
+     * is processed (e.g. target thread exits without returning
+     * to event loop) its calls fail as well.
+     *
+     * \return future that holds results in order of \a calls,
+     * failed calls yield invalid QVariant; the future is always
+     * finished once all groups are either invoked or failed
+     * \note this function is supported for Qt 5.10.0 and higher
+     */
+    QFuture<QVariant> invokeBatch(const QVector<Call>& calls, QThreadPool* pool = Q_NULLPTR,
+                                  BatchMode mode = PostToOwnerThread) const;
+#endif
+
     /*!
      * \brief methodMapping
      * \return method binding mapping
@@ -2,12 +2,73 @@
 #include <QRegExp>
 #include <QMetaObject>
 #include <QMetaProperty>
+#include <QReadWriteLock>
+#include <QHash>
+
+class QtPropertyPlanCachePrivate
+{
+public:
+    QHash<const QMetaObject*, QtPropertyPlan> plans;
+    mutable QReadWriteLock lock;
+};
+
+QtPropertyPlanCache::QtPropertyPlanCache() :
+    d(new QtPropertyPlanCachePrivate)
+{
+}
+
+QtPropertyPlanCache::~QtPropertyPlanCache()
+{
+}
+
+bool QtPropertyPlanCache::find(const QMetaObject *metaObject, QtPropertyPlan &plan) const
+{
+    QReadLocker locker(&d->lock);
+    auto it = d->plans.constFind(metaObject);
+    if (it == d->plans.cend())
+        return false;
+    plan = it.value();
+    return true;
+}
+
+void QtPropertyPlanCache::insert(const QMetaObject *metaObject, const QtPropertyPlan &plan)
+{
+    QWriteLocker locker(&d->lock);
+    d->plans.insert(metaObject, plan);
+}
+
+void QtPropertyPlanCache::clear()
+{
+    QWriteLocker locker(&d->lock);
+    d->plans.clear();
+}
+
+int QtPropertyPlanCache::size() const
+{
+    QReadLocker locker(&d->lock);
+    return d->plans.size();
+}
+
+void QtPropertyPlanCache::append(QtPropertyPlan &plan, const QMetaObject *metaClass, bool inherited)
+{
+    QtPropertyPlanEntry entry;
+    for (int i = (inherited ? 0 : metaClass->propertyOffset()), n = metaClass->propertyCount(); i < n; i++)
+    {
+        entry.property = metaClass->property(i);
+        entry.readable = entry.property.isReadable();
+        entry.writable = entry.property.isWritable();
+        plan.push_back(entry);
+    }
+}
+
+
 
 class QtAbstractObjectMapperPrivate
 {
 public:
     QRegExp regExp;
     bool isFinal;
+    QtPropertyPlanCache cache;
 };
 
 QtAbstractObjectMapper::QtAbstractObjectMapper() :
@@ -23,6 +84,7 @@ QtAbstractObjectMapper::~QtAbstractObjectMapper()
 void QtAbstractObjectMapper::setClassFilter(const QString &pattern)
 {
     d->regExp.setPattern(pattern);
+    d->cache.clear();
 }
 
 QString QtAbstractObjectMapper::classFilter() const
@@ -32,7 +94,10 @@ QString QtAbstractObjectMapper::classFilter() const
 
 void QtAbstractObjectMapper::setFinal(bool on)
 {
+    if (d->isFinal == on)
+        return;
     d->isFinal = on;
+    d->cache.clear();
 }
 
 bool QtAbstractObjectMapper::isFinal() const
@@ -40,6 +105,32 @@ bool QtAbstractObjectMapper::isFinal() const
     return d->isFinal;
 }
 
+QtPropertyPlan QtAbstractObjectMapper::propertyPlan(const QMetaObject *metaClass) const
+{
+    QtPropertyPlan plan;
+    if (metaClass == Q_NULLPTR || d->cache.find(metaClass, plan))
+        return plan;
+
+    // walk class hierarchy only once per meta-class
+    for (const QMetaObject* mo = metaClass; mo != Q_NULLPTR; mo = mo->superClass())
+    {
+        if (!accepted(mo->className()))
+            continue;
+
+        QtPropertyPlanCache::append(plan, mo);
+
+        if (isFinal())
+            break;
+    }
+    d->cache.insert(metaClass, plan);
+    return plan;
+}
+
+void QtAbstractObjectMapper::invalidatePlans()
+{
+    d->cache.clear();
+}
+
 bool QtAbstractObjectMapper::accepted(const QString& className) const
 {
     return (d->regExp.isValid() && className.contains(d->regExp));
@@ -48,19 +139,13 @@ bool QtAbstractObjectMapper::accepted(const QString& className) const
 
 bool QtAbstractObjectMapper::write(void *w, const QObject *obj, const QMetaObject *metaClass) const
 {
-    for (; metaClass != Q_NULLPTR; metaClass = metaClass->superClass())
-    {
-        if (!accepted(metaClass->className()))
+    const QtPropertyPlan plan = propertyPlan(metaClass);
+    for (auto it = plan.cbegin(); it != plan.cend(); ++it) {
+        if (!it->readable)
             continue;
-
-        for (int i = metaClass->propertyOffset(), n = metaClass->propertyCount(); i < n; i++) {
-            if (!this->write(w, obj, metaClass->property(i))) {
-                return false;
-            }
+        if (!this->write(w, obj, it->property)) {
+            return false;
         }
-
-        if (isFinal())
-            break;
     }
     return true;
 }
@@ -72,19 +157,13 @@ bool QtAbstractObjectMapper::write(void*, const QObject*, const QMetaProperty&)
 
 bool QtAbstractObjectMapper::read(void *r, QObject *obj, const QMetaObject *metaClass) const
 {
-    for (; metaClass != Q_NULLPTR; metaClass = metaClass->superClass())
-    {
-        if (!accepted(metaClass->className()))
+    const QtPropertyPlan plan = propertyPlan(metaClass);
+    for (auto it = plan.cbegin(); it != plan.cend(); ++it) {
+        if (!it->writable)
             continue;
-
-        for (int i = metaClass->propertyOffset(), n = metaClass->propertyCount(); i < n; i++) {
-            if (!this->read(r, obj, metaClass->property(i))) {
-                return false;
-            }
+        if (!this->read(r, obj, it->property)) {
+            return false;
         }
-
-        if (isFinal())
-            break;
     }
     return true;
 }
@@ -96,19 +175,11 @@ bool QtAbstractObjectMapper::read(void*, QObject*, const QMetaProperty&) const
 
 bool QtAbstractObjectMapper::validate(void *v, const QMetaObject *metaClass) const
 {
-    for (; metaClass != Q_NULLPTR; metaClass = metaClass->superClass())
-    {
-        if (!accepted(metaClass->className()))
-            continue;
-
-        for (int i = metaClass->propertyOffset(), n = metaClass->propertyCount(); i < n; i++) {
-            if (!this->validate(v, metaClass->property(i))) {
-                return false;
-            }
+    const QtPropertyPlan plan = propertyPlan(metaClass);
+    for (auto it = plan.cbegin(); it != plan.cend(); ++it) {
+        if (!this->validate(v, it->property)) {
+            return false;
         }
-
-        if (isFinal())
-            break;
     }
     return true;
 }
@@ -4,12 +4,64 @@
 #include <QtCoreExtra>
 #include <QScopedPointer>
 #include <QObject>
+#include <QMetaProperty>
+#include <QVector>
 
 struct QMetaObject;
-class QMetaProperty;
 
 class QRegExp;
 
+/*!
+ * \brief The QtPropertyPlanEntry struct
+ *
+ * Precompiled information about single property
+ * that takes part in object mapping.
+ */
+struct QtPropertyPlanEntry
+{
+    QMetaProperty property; //!< resolved meta-property
+    bool readable;          //!< property is written by serialize()
+    bool writable;          //!< property is read by unserialize()
+};
+Q_DECLARE_TYPEINFO(QtPropertyPlanEntry, Q_MOVABLE_TYPE);
+
+/*!
+ * \brief QtPropertyPlan
+ *
+ * Ordered list of properties of some meta-class
+ * that should be processed by mapper.
+ */
+typedef QVector<QtPropertyPlanEntry> QtPropertyPlan;
+
+/*!
+ * \brief The QtPropertyPlanCache class
+ *
+ * Thread-safe cache of property plans keyed by meta-object.
+ *
+ * Plans are computed once per meta-class by the owner
+ * of cache and then shared between all subsequent
+ * mapping operations.
+ */
+class QTCOREEXTRA_EXPORT QtPropertyPlanCache
+{
+    Q_DISABLE_COPY(QtPropertyPlanCache)
+public:
+    QtPropertyPlanCache();
+    ~QtPropertyPlanCache();
+
+    bool find(const QMetaObject* metaObject, QtPropertyPlan& plan) const;
+    void insert(const QMetaObject* metaObject, const QtPropertyPlan& plan);
+    void clear();
+    int size() const;
+
+    static void append(QtPropertyPlan& plan, const QMetaObject* metaClass, bool inherited = false);
+
+private:
+    QScopedPointer<class QtPropertyPlanCachePrivate> d;
+};
+
+
+
 class QTCOREEXTRA_EXPORT QtAbstractObjectMapper
 {
     Q_DISABLE_COPY(QtAbstractObjectMapper)
@@ -23,6 +75,9 @@ public:
     void setFinal(bool on = true);
     bool isFinal() const;
 
+    QtPropertyPlan propertyPlan(const QMetaObject* metaClass) const;
+    void invalidatePlans();
+
 protected:
     virtual bool accepted(const QString &className) const;
 
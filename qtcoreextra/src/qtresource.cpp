@@ -1,39 +1,201 @@
 #include "qtresource.h"
 #include <QtCore/QBuffer>
-#include <QtCore/QTextStream>
+#include <QtCore/QFile>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QDebug>
+
+#include <cstring>
+
+namespace
+{
+
+/*
+ * Registry of memory-mapped external resource files
+ */
+class MappedResources
+{
+public:
+    ~MappedResources() {
+        qDeleteAll(files);
+    }
+
+    QMutex mutex;
+    QHash<QString, QFile*> files; // files are kept open while mapped
+    QHash<QString, const uchar*> mappings;
+};
+
+Q_GLOBAL_STATIC(MappedResources, mappedResources)
+
+inline QString mappedResourceKey(const QString &rccFileName, const QString &resourceRoot)
+{
+    return rccFileName + QLatin1Char('\n') + resourceRoot;
+}
+
+}
+
+void QtResource::RecordIterator::scan()
+{
+    if (mRecord.data == Q_NULLPTR) { // past the end
+        mRecord.size = 0;
+        mNext = Q_NULLPTR;
+        return;
+    }
+
+    const char* sep = static_cast<const char*>(
+                std::memchr(mRecord.data, mSeparator, static_cast<size_t>(mEnd - mRecord.data)));
+    const char* last = (sep != Q_NULLPTR ? sep : mEnd);
+    // trailing separator does not start a new record
+    mNext = (sep != Q_NULLPTR && sep + 1 != mEnd ? sep + 1 : Q_NULLPTR);
+
+    if (mTrimCR && last != mRecord.data && *(last - 1) == '\r')
+        --last;
+    mRecord.size = static_cast<int>(last - mRecord.data);
+}
+
+
 
 QtResource::QtResource(const QString &file, const QLocale &locale) :
-    QResource(file, locale)
+    QResource(file, locale),
+    mUncompressedSource(Q_NULLPTR)
+{
+}
+
+QByteArray QtResource::bytes() const
+{
+    if (!isValid()) {
+        mUncompressed.clear();
+        mUncompressedSource = Q_NULLPTR;
+        return QByteArray();
+    }
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 13, 0)
+    const bool compressed = (compressionAlgorithm() != NoCompression);
+#else
+    const bool compressed = isCompressed();
+#endif
+    if (!compressed) {
+        mUncompressed.clear();
+        mUncompressedSource = Q_NULLPTR;
+        return QByteArray::fromRawData(reinterpret_cast<const char*>(data()), static_cast<int>(size()));
+    }
+
+    // file name or locale may be changed since last access,
+    // so cache is bound to resource data it was produced from;
+    // failure is cached too (as null array) and reported once
+    if (mUncompressedSource != data())
+    {
+        // uncompress once and cache
+        mUncompressedSource = data();
+        mUncompressed.clear();
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+        mUncompressed = uncompressedData();
+#elif QT_VERSION >= QT_VERSION_CHECK(5, 13, 0)
+        // qUncompress() understands zlib only
+        if (compressionAlgorithm() == ZstdCompression) {
+            qWarning() << "zstd compressed resource" << fileName() << "requires Qt 5.15";
+            return mUncompressed;
+        }
+        mUncompressed = qUncompress(data(), static_cast<int>(size()));
+#else
+        mUncompressed = qUncompress(data(), static_cast<int>(size()));
+#endif
+        if (mUncompressed.isNull())
+            qWarning() << "failed to uncompress resource" << fileName();
+    }
+    return mUncompressed;
+}
+
+// Both ends come from bytes(): content that failed
+// to uncompress is an empty range, not compressed data
+const char *QtResource::constBegin() const
+{
+    return bytes().constData();
+}
+
+const char *QtResource::constEnd() const
+{
+    const QByteArray content = bytes();
+    return content.constData() + content.size();
+}
+
+QtResource::RecordRange QtResource::records(char separator) const
+{
+    const char* first = constBegin();
+    const char* last = constEnd();
+    return RecordRange(RecordIterator(first, last, separator, false), RecordIterator());
+}
+
+QtResource::RecordRange QtResource::lines() const
 {
+    const char* first = constBegin();
+    const char* last = constEnd();
+    return RecordRange(RecordIterator(first, last, '\n', true), RecordIterator());
 }
 
 QString QtResource::toString() const
 {
-    QBuffer buf;
-    buffer(buf);
-    buf.open(QBuffer::ReadOnly);
-    return buf.readAll();
+    const QByteArray content = bytes();
+    return QString::fromUtf8(content.constData(), content.size());
 }
 
 QStringList QtResource::toStringList() const
 {
     QStringList strings;
-    QBuffer buf;
-    buffer(buf);
-    buf.open(QBuffer::ReadOnly);
-    QTextStream stream(&buf);
-    QString line;
-    while(!stream.atEnd()) {
-        stream.readLineInto(&line);
-        strings << line;
-    }
+    const RecordRange range = lines();
+    for (auto it = range.begin(); it != range.end(); ++it)
+        strings << it->toString();
     return strings;
 }
 
 void QtResource::buffer(QBuffer& buffer) const
 {
-    buffer.setData(reinterpret_cast<const char*>(this->data()), this->size());
+    buffer.setData(bytes());
 }
 
+bool QtResource::registerMappedResource(const QString &rccFileName, const QString &resourceRoot)
+{
+    MappedResources* registry = mappedResources();
+    QMutexLocker locker(&registry->mutex);
 
+    const QString key = mappedResourceKey(rccFileName, resourceRoot);
+    if (registry->files.contains(key))
+        return true; // already registered
 
+    QFile* file = new QFile(rccFileName);
+    if (!file->open(QIODevice::ReadOnly)) {
+        qWarning() << "failed to open resource file" << rccFileName << ":" << file->errorString();
+        delete file;
+        return false;
+    }
+    const uchar* data = file->map(0, file->size());
+    if (data == Q_NULLPTR || !QResource::registerResource(data, resourceRoot)) {
+        qWarning() << "failed to map resource file" << rccFileName;
+        delete file;
+        return false;
+    }
+    registry->files.insert(key, file);
+    registry->mappings.insert(key, data);
+    return true;
+}
+
+bool QtResource::unregisterMappedResource(const QString &rccFileName, const QString &resourceRoot)
+{
+    MappedResources* registry = mappedResources();
+    QMutexLocker locker(&registry->mutex);
+
+    const QString key = mappedResourceKey(rccFileName, resourceRoot);
+    QFile* file = registry->files.take(key);
+    if (file == Q_NULLPTR)
+        return false;
+
+    const uchar* data = registry->mappings.value(key);
+    if (!QResource::unregisterResource(data, resourceRoot)) {
+        registry->files.insert(key, file); // resource is still in use
+        return false;
+    }
+    registry->mappings.remove(key);
+    delete file; // unmaps file
+    return true;
+}
@@ -3,21 +3,140 @@
 #include <QtCore/QResource>
 #include <QtCore/QString>
 #include <QtCore/QStringList>
+#include <QtCore/QByteArray>
 
 #include <QtCoreExtra>
 
 class QBuffer;
 
+/*!
+ * \brief The QtResource class
+ *
+ * Extended QResource with convenient access to resource content.
+ *
+ * Content is exposed without copying: bytes() wraps resource
+ * data directly, and records()/lines() iterate over it
+ * lazily without allocating memory per record. Compressed
+ * resources are transparently uncompressed once on first
+ * access and the result is cached within the QtResource
+ * instance until setFileName() or setLocale() selects
+ * another resource. Content of resources that can not be
+ * uncompressed (e.g. zstd compressed ones before Qt 5.15)
+ * is empty.
+ *
+ * \code
+ * QtResource resource(":/tables/lookup.csv");
+ * for (auto it = resource.lines().begin(); it != resource.lines().end(); ++it)
+ *     process(it->data, it->size);
+ * \endcode
+ */
 class QTCOREEXTRA_EXPORT QtResource :
         public QResource
 {
 public:
+    /*!
+     * \brief The Record struct
+     *
+     * Non-owning view of a single record inside resource data
+     */
+    struct Record
+    {
+        const char* data;
+        int size;
+
+        inline QByteArray toByteArray() const { return QByteArray(data, size); }
+        inline QString toString() const { return QString::fromUtf8(data, size); }
+    };
+
+    /*!
+     * \brief The RecordIterator class
+     *
+     * Forward iterator over records separated by
+     * a single separator character.
+     */
+    class RecordIterator
+    {
+    public:
+        RecordIterator() : mNext(Q_NULLPTR), mEnd(Q_NULLPTR), mSeparator('\n'), mTrimCR(false) {
+            mRecord.data = Q_NULLPTR;
+            mRecord.size = 0;
+        }
+
+        RecordIterator(const char* begin, const char* end, char separator, bool trimCR) :
+            mEnd(end), mSeparator(separator), mTrimCR(trimCR) {
+            mRecord.data = (begin != end ? begin : Q_NULLPTR);
+            mRecord.size = 0;
+            scan();
+        }
+
+        inline const Record& operator*() const { return mRecord; }
+        inline const Record* operator->() const { return &mRecord; }
+
+        inline RecordIterator& operator++() {
+            mRecord.data = mNext;
+            scan();
+            return *this;
+        }
+
+        inline RecordIterator operator++(int) {
+            RecordIterator tmp(*this);
+            ++(*this);
+            return tmp;
+        }
+
+        inline bool operator==(const RecordIterator& other) const { return mRecord.data == other.mRecord.data; }
+        inline bool operator!=(const RecordIterator& other) const { return mRecord.data != other.mRecord.data; }
+
+    private:
+        void scan();
+
+        Record mRecord;
+        const char* mNext; // start of next record or null
+        const char* mEnd;
+        char mSeparator;
+        bool mTrimCR;
+    };
+
+    /*!
+     * \brief The RecordRange class
+     *
+     * Lightweight range of records suitable for range-based for loop
+     */
+    class RecordRange
+    {
+    public:
+        RecordRange(const RecordIterator& first, const RecordIterator& last) :
+            mFirst(first), mLast(last) {}
+
+        inline RecordIterator begin() const { return mFirst; }
+        inline RecordIterator end() const { return mLast; }
+
+    private:
+        RecordIterator mFirst;
+        RecordIterator mLast;
+    };
+
     QtResource(const QString &file = QString(), const QLocale &locale = QLocale());
 
+    QByteArray bytes() const;
+
+    RecordRange records(char separator) const;
+    RecordRange lines() const;
+
     QString toString() const;
     QStringList toStringList() const;
 
     void buffer(QBuffer& buffer) const;
+
+    static bool registerMappedResource(const QString &rccFileName, const QString &resourceRoot = QString());
+    static bool unregisterMappedResource(const QString &rccFileName, const QString &resourceRoot = QString());
+
+private:
+    const char* constBegin() const;
+    const char* constEnd() const;
+
+    mutable QByteArray mUncompressed;
+    mutable const uchar* mUncompressedSource;
 };
 
 #endif // QTRESOURCE_H
@@ -8,13 +8,15 @@
 #include <QDebug>
 
 #include "qtxmlmapper.h"
+#include "qtobjectmapper.h"
 
 namespace
 {
 
-inline bool xmlWriteProperty(QXmlStreamWriter& xml, const char* propertyName, const QObject* object)
+inline bool xmlWriteProperty(QXmlStreamWriter& xml, const QMetaProperty& property, const QObject* object)
 {
-    const QVariant value = object->property(propertyName);
+    const char* propertyName = property.name();
+    const QVariant value = property.read(object);
 
     xml.writeStartElement(propertyName);
     xml.writeAttribute("type", value.typeName());
@@ -36,7 +38,8 @@ inline bool xmlReadProperty(QXmlStreamReader& xml, QObject *object)
 
 }
 
-QtXmlMapper::QtXmlMapper()
+QtXmlMapper::QtXmlMapper() :
+    plans(new QtPropertyPlanCache)
 {
 }
 
@@ -50,9 +53,16 @@ bool QtXmlMapper::write(QXmlStreamWriter &xml, const QObject* o) const
         return false;
 
     const QMetaObject *metaObject = o->metaObject();
+    QtPropertyPlan plan;
+    if (!plans->find(metaObject, plan)) {
+        QtPropertyPlanCache::append(plan, metaObject, true);
+        plans->insert(metaObject, plan);
+    }
+
     xml.writeStartElement("properties");
-    for (int i = 0, n = metaObject->propertyCount(); i < n; i++) {
-        xmlWriteProperty(xml, metaObject->property(i).name(), o);
+    for (auto it = plan.cbegin(); it != plan.cend(); ++it) {
+        if (it->readable)
+            xmlWriteProperty(xml, it->property, o);
     }
     xml.writeEndElement(); // "properties"
 
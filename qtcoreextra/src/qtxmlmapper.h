@@ -14,4 +14,7 @@ public:
 
     virtual bool write(QXmlStreamWriter& xml, const QObject* o) const;
     virtual bool read(QXmlStreamReader &xml, QObject* o);
+
+private:
+    QScopedPointer<class QtPropertyPlanCache> plans;
 };
@@ -0,0 +1,30 @@
+QT       += core testlib
+QT       -= gui
+
+TEMPLATE = app
+CONFIG += debug_and_release
+CONFIG += c++14 console testcase
+CONFIG -= app_bundle
+
+CONFIG(debug, debug|release) {
+        TARGET = tst_qtcbormapperd
+        MOC_DIR	    = tmp/debug_shared/moc
+        OBJECTS_DIR = tmp/debug_shared/obj
+        LIBS += -L../../../libs -lqtcoreextrad
+} else {
+        TARGET = tst_qtcbormapper
+        MOC_DIR	    = tmp/release_shared/moc
+        OBJECTS_DIR = tmp/release_shared/obj
+        LIBS += -L../../../libs -lqtcoreextra
+}
+
+DEFINES += QT_DEPRECATED_WARNINGS QTCOREEXTRA_DLL
+
+INCLUDEPATH += \
+    ../../include
+
+DEPENDPATH += \
+    ../../include
+
+SOURCES += \
+    tst_qtcbormapper.cpp
@@ -0,0 +1,195 @@
+#include <QtTest>
+#include <QtCborMapper>
+
+#include <QDateTime>
+#include <QTimeZone>
+#include <QSize>
+
+class Record : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int number MEMBER number)
+    Q_PROPERTY(double ratio MEMBER ratio)
+    Q_PROPERTY(bool enabled MEMBER enabled)
+    Q_PROPERTY(QString text MEMBER text)
+    Q_PROPERTY(QByteArray bytes MEMBER bytes)
+    Q_PROPERTY(QStringList list MEMBER list)
+    Q_PROPERTY(QSize size MEMBER size)
+    Q_PROPERTY(QDateTime dateTime MEMBER dateTime)
+    Q_PROPERTY(QDate date MEMBER date)
+    Q_PROPERTY(QTime time MEMBER time)
+
+public:
+    explicit Record(QObject* parent = Q_NULLPTR) :
+        QObject(parent), number(0), ratio(0.0), enabled(false) {
+    }
+
+    int number;
+    double ratio;
+    bool enabled;
+    QString text;
+    QByteArray bytes;
+    QStringList list;
+    QSize size;
+    QDateTime dateTime;
+    QDate date;
+    QTime time;
+};
+
+class tst_QtCborMapper : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void roundTrip_data();
+    void roundTrip();
+    void validate();
+    void manyObjects();
+};
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+
+namespace
+{
+
+Record* roundTripped(const Record& source, QObject* parent)
+{
+    QByteArray data;
+    QtCborMapper mapper;
+    {
+        QtCborWriter writer(&data);
+        if (!mapper.serialize(writer, &source))
+            return Q_NULLPTR;
+    }
+
+    Record* result = new Record(parent);
+    QtCborReader reader(data);
+    if (!mapper.unserialize(reader, result))
+        return Q_NULLPTR;
+    return result;
+}
+
+}
+
+void tst_QtCborMapper::roundTrip_data()
+{
+    QTest::addColumn<QDateTime>("dateTime");
+    QTest::addColumn<QDate>("date");
+    QTest::addColumn<QTime>("time");
+
+    const QDate date(2021, 11, 30);
+    const QTime time(18, 26, 11, 345);
+    QTest::newRow("utc") << QDateTime(date, time, Qt::UTC) << date << time;
+    QTest::newRow("local") << QDateTime(date, time, Qt::LocalTime) << date << time;
+    QTest::newRow("offset") << QDateTime(date, time, Qt::OffsetFromUTC, 3 * 3600) << date << time;
+    QTest::newRow("negative offset") << QDateTime(date, time, Qt::OffsetFromUTC, -(5 * 3600 + 30 * 60)) << date << time;
+    QTest::newRow("before epoch") << QDateTime(QDate(1901, 2, 3), time, Qt::UTC) << QDate(1901, 2, 3) << QTime(0, 0);
+    QTest::newRow("invalid") << QDateTime() << QDate() << QTime();
+}
+
+void tst_QtCborMapper::roundTrip()
+{
+    QFETCH(QDateTime, dateTime);
+    QFETCH(QDate, date);
+    QFETCH(QTime, time);
+
+    Record source;
+    source.number = -42;
+    source.ratio = 0.125;
+    source.enabled = true;
+    source.text = QStringLiteral("text é");
+    source.bytes = QByteArray("\x00\x01\xff", 3);
+    source.list = QStringList() << "a" << "b";
+    source.size = QSize(640, 480);
+    source.dateTime = dateTime;
+    source.date = date;
+    source.time = time;
+
+    QObject parent;
+    Record* result = roundTripped(source, &parent);
+    QVERIFY(result != Q_NULLPTR);
+
+    QCOMPARE(result->number, source.number);
+    QCOMPARE(result->ratio, source.ratio);
+    QCOMPARE(result->enabled, source.enabled);
+    QCOMPARE(result->text, source.text);
+    QCOMPARE(result->bytes, source.bytes);
+    QCOMPARE(result->list, source.list);
+    QCOMPARE(result->size, source.size);
+
+    QCOMPARE(result->dateTime.isValid(), dateTime.isValid());
+    if (dateTime.isValid()) {
+        QCOMPARE(result->dateTime, dateTime);
+        QCOMPARE(result->dateTime.timeSpec(), dateTime.timeSpec());
+        QCOMPARE(result->dateTime.offsetFromUtc(), dateTime.offsetFromUtc());
+    }
+    QCOMPARE(result->date.isValid(), date.isValid());
+    QCOMPARE(result->date, date);
+    QCOMPARE(result->time.isValid(), time.isValid());
+    QCOMPARE(result->time, time);
+}
+
+void tst_QtCborMapper::validate()
+{
+    Record source;
+    source.number = 7;
+
+    QByteArray data;
+    QtCborMapper mapper;
+    {
+        QtCborWriter writer(&data);
+        QVERIFY(mapper.serialize(writer, &source));
+    }
+
+    // fresh reader: validateObject() reads object by itself
+    QtCborReader reader(data);
+    QVERIFY(mapper.validateObject<Record>(reader));
+
+    // and unserialize() maps the same object
+    Record result;
+    QVERIFY(mapper.unserialize(reader, &result));
+    QCOMPARE(result.number, 7);
+
+    QtCborReader empty(QByteArray(1, char(0xa0))); // empty map
+    QVERIFY(!mapper.validateObject<Record>(empty));
+}
+
+void tst_QtCborMapper::manyObjects()
+{
+    QByteArray data;
+    QtCborMapper mapper;
+    {
+        QtCborWriter writer(&data);
+        writer.stream().startArray();
+        for (int i = 0; i < 3; i++) {
+            Record source;
+            source.number = i;
+            source.text = QString::number(i);
+            QVERIFY(mapper.serialize(writer, &source));
+        }
+        writer.stream().endArray();
+    }
+
+    QtCborReader reader(data);
+    QVERIFY(reader.stream().enterContainer());
+    for (int i = 0; i < 3; i++) {
+        Record result;
+        QVERIFY(mapper.unserialize(reader, &result));
+        QCOMPARE(result.number, i);
+        QCOMPARE(result.text, QString::number(i));
+    }
+    QVERIFY(!reader.stream().hasNext());
+}
+
+#else
+
+void tst_QtCborMapper::roundTrip_data() {}
+void tst_QtCborMapper::roundTrip() { QSKIP("QtCborMapper requires Qt 5.12"); }
+void tst_QtCborMapper::validate() { QSKIP("QtCborMapper requires Qt 5.12"); }
+void tst_QtCborMapper::manyObjects() { QSKIP("QtCborMapper requires Qt 5.12"); }
+
+#endif
+
+QTEST_GUILESS_MAIN(tst_QtCborMapper)
+
+#include "tst_qtcbormapper.moc"
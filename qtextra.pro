@@ -7,8 +7,11 @@ TEMPLATE = subdirs
 
 SUBDIRS += \
         qtcoreextra \
+        qtcoreextra/tests \
+        qtcoreextra/benchmarks \
         qtplugins \
         qtwidgetsextra \
+        qtwidgetsextra/benchmarks \
         qtpropertybrowser \
         qtsqlextra \
         qtsqlwidgets \
@@ -0,0 +1,29 @@
+# Common settings of QtWidgetsExtra benchmarks, TARGET
+# must be specified before including this file
+
+QT       += core gui testlib
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+TEMPLATE = app
+CONFIG += debug_and_release
+CONFIG += c++14 console
+CONFIG -= app_bundle
+
+CONFIG(debug, debug|release) {
+        TARGET = $${TARGET}d
+        MOC_DIR	    = tmp/debug_shared/moc
+        OBJECTS_DIR = tmp/debug_shared/obj
+        LIBS += -L$$PWD/../../libs -lqtwidgetsextrad
+} else {
+        MOC_DIR	    = tmp/release_shared/moc
+        OBJECTS_DIR = tmp/release_shared/obj
+        LIBS += -L$$PWD/../../libs -lqtwidgetsextra
+}
+
+DEFINES += QT_DEPRECATED_WARNINGS QTWIDGETSEXTRA_DLL
+
+INCLUDEPATH += \
+    $$PWD/../include
+
+DEPENDPATH += \
+    $$PWD/../include
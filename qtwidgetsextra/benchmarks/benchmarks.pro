@@ -0,0 +1,13 @@
+#####################################################################
+# QtWidgetsExtra benchmarks
+#
+# Every benchmark is a QTest application, results may be written
+# in machine-readable form using QTest output options, e.g.:
+#
+#   bench_itemfilter -o itemfilter.csv,csv
+#####################################################################
+
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    itemfilter
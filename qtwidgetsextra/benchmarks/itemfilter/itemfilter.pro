@@ -0,0 +1,6 @@
+TARGET = bench_itemfilter
+
+include(../benchmarks.pri)
+
+SOURCES += \
+    tst_bench_itemfilter.cpp
@@ -0,0 +1,272 @@
+#include <QtTest>
+#include <QAbstractTableModel>
+#include <QRegularExpression>
+#include <QRegExp>
+
+#include <QtItemFilter>
+
+namespace
+{
+
+enum { RowCount = 100000 };
+
+/*
+ * Table with preformatted text in first column and
+ * row number in second one: data() costs almost nothing,
+ * so only filtering is measured
+ */
+class RowModel :
+        public QAbstractTableModel
+{
+public:
+    RowModel() {
+        texts.reserve(RowCount);
+        for (int i = 0; i < RowCount; i++)
+            texts << QString("Item %1 of the list").arg(i);
+    }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const Q_DECL_OVERRIDE {
+        return (parent.isValid() ? 0 : RowCount);
+    }
+
+    int columnCount(const QModelIndex& parent = QModelIndex()) const Q_DECL_OVERRIDE {
+        return (parent.isValid() ? 0 : 2);
+    }
+
+    QVariant data(const QModelIndex& index, int role) const Q_DECL_OVERRIDE {
+        if (role != Qt::DisplayRole && role != Qt::EditRole)
+            return QVariant();
+        if (index.column() == 0)
+            return texts.at(index.row());
+        return index.row();
+    }
+
+private:
+    QStringList texts;
+};
+
+/*
+ * Matching as it was done before QtItemFilter compiled its
+ * pattern (copied from the original qtitemfilter.cpp): regular
+ * expression is built and values are converted on every call
+ */
+namespace reference
+{
+
+/*
+ * Typed replacement of deprecated QVariant ordering operators
+ * used by the original code: numbers are compared as numbers,
+ * dates and times by their value, anything else as strings
+ */
+int order(const QVariant& lhs, const QVariant& rhs)
+{
+    switch (lhs.userType())
+    {
+    case QMetaType::QDate:
+        return (lhs.toDate() < rhs.toDate() ? -1 : (rhs.toDate() < lhs.toDate() ? 1 : 0));
+    case QMetaType::QTime:
+        return (lhs.toTime() < rhs.toTime() ? -1 : (rhs.toTime() < lhs.toTime() ? 1 : 0));
+    case QMetaType::QDateTime:
+        return (lhs.toDateTime() < rhs.toDateTime() ? -1 : (rhs.toDateTime() < lhs.toDateTime() ? 1 : 0));
+    case QMetaType::QString:
+        return QString::compare(lhs.toString(), rhs.toString());
+    default:
+        break;
+    }
+    bool lok = false, rok = false;
+    const double l = lhs.toDouble(&lok), r = rhs.toDouble(&rok);
+    if (lok && rok)
+        return (l < r ? -1 : (r < l ? 1 : 0));
+    return QString::compare(lhs.toString(), rhs.toString());
+}
+
+static inline QRegularExpression::PatternOptions regexOpts(QtItemFilter::RegexOptions opts, Qt::CaseSensitivity cs)
+{
+    QRegularExpression::PatternOptions result;
+    if (opts & QtItemFilter::MultiLine)
+        result |= QRegularExpression::MultilineOption;
+
+    if (opts & QtItemFilter::Unicode)
+        result |= QRegularExpression::UseUnicodePropertiesOption;
+
+    if (opts & QtItemFilter::ExtendedSyntax)
+        result |= QRegularExpression::ExtendedPatternSyntaxOption;
+
+    if (opts & QtItemFilter::Optimize)
+        result |= QRegularExpression::OptimizeOnFirstUsageOption;
+
+    if (cs == Qt::CaseInsensitive)
+        result |= QRegularExpression::CaseInsensitiveOption;
+
+    return result;
+}
+
+static inline bool stringMatch(const QString& pattern, const QString& what, Qt::MatchFlags flags, QtItemFilter::RegexOptions options)
+{
+    Qt::CaseSensitivity cs = flags & Qt::MatchCaseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive;
+    switch (flags) {
+    case Qt::MatchRegExp:
+        return (QRegularExpression(pattern, regexOpts(options, cs)).match(what).hasMatch());
+    case Qt::MatchWildcard:
+        return (QRegExp(pattern, cs, QRegExp::Wildcard).exactMatch(what));
+    case Qt::MatchStartsWith:
+        return (what.startsWith(pattern, cs));
+    case Qt::MatchEndsWith:
+        return (what.endsWith(pattern, cs));
+    case Qt::MatchFixedString:
+        return (what.compare(pattern, cs) == 0);
+    case Qt::MatchContains:
+    default:
+        break;
+    }
+    return (what.contains(pattern, cs));
+}
+
+static inline bool match(const QVariant &pattern, const QVariant& what,  Qt::MatchFlags flags, QtItemFilter::RegexOptions options)
+{
+    // QVariant based matching
+    if (flags == Qt::MatchExactly) {
+        return (what == pattern);
+    } else { // QString based matching - only convert to a string if it is needed
+        return stringMatch(pattern.toString(), what.toString(), flags, options);
+    }
+}
+
+
+static inline int compareStrings(const QString& pattern, const QString& what, Qt::MatchFlags flags)
+{
+    Qt::CaseSensitivity cs = flags & Qt::MatchCaseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive;
+    return QString::compare(pattern, what, cs);
+}
+
+static inline int compareVariants(const QVariant& pattern, const QVariant& what, Qt::MatchFlags flags)
+{
+    if (pattern.type() == QVariant::String)
+        return compareStrings(pattern.toString(), what.toString(), flags);
+
+    if (pattern == what || order(pattern, what) >= 0 || order(pattern, what) <= 0)
+        return 0;
+    if (order(pattern, what) > 0)
+        return 1;
+    if (order(pattern, what) < 0)
+        return -1;
+    return 1;
+}
+
+bool accepts(const QtItemFilter& filter, const QVariant& v)
+{
+    const QVariant pattern = filter.pattern();
+    const Qt::MatchFlags flags = filter.matchFlags();
+    const QtItemFilter::RegexOptions options = filter.regexOptions();
+    switch(filter.condition()) {
+    case QtItemFilter::None:         return true;
+    case QtItemFilter::Match:        return match(pattern, v, flags, options);
+    case QtItemFilter::Equal:        return match(pattern, v, Qt::MatchExactly, QtItemFilter::NoOptions);
+    case QtItemFilter::NotEqual:     return (!match(pattern, v, Qt::MatchExactly, QtItemFilter::NoOptions));
+    case QtItemFilter::Less:         return (compareVariants(pattern, v, flags) > 0);
+    case QtItemFilter::LessEqual:    return (compareVariants(pattern, v, flags) >= 0);
+    case QtItemFilter::Greater:      return (compareVariants(pattern, v, flags) < 0);
+    case QtItemFilter::GreaterEqual: return (compareVariants(pattern, v, flags) <= 0);
+    default: break;
+    }
+    return false;
+}
+
+bool accepted(const QtItemFilter& filter, const QModelIndex &index)
+{
+    if (!filter.isEnabled() || (filter.condition() == QtItemFilter::None || !filter.pattern().isValid()))
+        return true;
+    return accepts(filter, index.data(filter.patternRole()));
+}
+
+}
+
+int filterRows(const QAbstractItemModel& model, const QtItemFilter& filter, int column, bool compiled)
+{
+    int accepted = 0;
+    for (int row = 0; row < RowCount; row++) {
+        const QModelIndex index = model.index(row, column);
+        if (compiled ? filter.accepted(index) : reference::accepted(filter, index))
+            ++accepted;
+    }
+    return accepted;
+}
+
+}
+
+class tst_BenchItemFilter : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void rowsPerSecond_data();
+    void rowsPerSecond();
+
+private:
+    RowModel model;
+};
+
+void tst_BenchItemFilter::rowsPerSecond_data()
+{
+    QTest::addColumn<int>("condition");
+    QTest::addColumn<int>("flags");
+    QTest::addColumn<QVariant>("pattern");
+    QTest::addColumn<int>("column");
+    QTest::addColumn<bool>("compiled");
+
+    struct Case {
+        const char* name;
+        int condition;
+        int flags;
+        QVariant pattern;
+        int column;
+    };
+    const Case cases[] = {
+        { "contains", QtItemFilter::Match, Qt::MatchContains, QString("77"), 0 },
+        { "starts with", QtItemFilter::Match, Qt::MatchStartsWith, QString("item 1"), 0 },
+        { "ends with", QtItemFilter::Match, Qt::MatchEndsWith, QString("THE LIST"), 0 },
+        { "regexp", QtItemFilter::Match, Qt::MatchRegExp, QString("^item \\d*7\\d* of"), 0 },
+        { "wildcard", QtItemFilter::Match, Qt::MatchWildcard, QString("item *7* of*"), 0 },
+        { "equal", QtItemFilter::Equal, Qt::MatchExactly, QString("Item 500 of the list"), 0 },
+        { "less int", QtItemFilter::Less, Qt::MatchExactly, 50000, 1 },
+        { "greater string", QtItemFilter::Greater, Qt::MatchExactly, QString("Item 5"), 0 }
+    };
+    for (const Case& c : cases) {
+        QTest::newRow(QByteArray(c.name) + " before") << c.condition << c.flags << c.pattern << c.column << false;
+        QTest::newRow(QByteArray(c.name) + " after") << c.condition << c.flags << c.pattern << c.column << true;
+    }
+}
+
+void tst_BenchItemFilter::rowsPerSecond()
+{
+    QFETCH(int, condition);
+    QFETCH(int, flags);
+    QFETCH(QVariant, pattern);
+    QFETCH(int, column);
+    QFETCH(bool, compiled);
+
+    QtItemFilter filter;
+    filter.setPatternRole(Qt::DisplayRole);
+    filter.setCondition(static_cast<QtItemFilter::Condition>(condition));
+    filter.setMatchFlags(static_cast<Qt::MatchFlags>(flags));
+    filter.setPattern(pattern);
+
+    // both implementations must agree, except ordering of
+    // non-string values: original code treats any two of
+    // them as equal, compiled filter compares them properly
+    const bool ordered = (condition & (QtItemFilter::Less | QtItemFilter::Greater)) != 0;
+    if (!ordered || pattern.type() == QVariant::String) {
+        const int expected = filterRows(model, filter, column, false);
+        QCOMPARE(filterRows(model, filter, column, true), expected);
+    }
+
+    // single iteration filters whole table: rows per
+    // second is RowCount divided by reported time
+    QBENCHMARK {
+        filterRows(model, filter, column, compiled);
+    }
+}
+
+QTEST_GUILESS_MAIN(tst_BenchItemFilter)
+
+#include "tst_bench_itemfilter.moc"
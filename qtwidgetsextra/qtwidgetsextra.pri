@@ -86,6 +86,7 @@ HEADERS += \
     $$PWD/src/itemviews/models/qtrevertibleproxymodel.h \
     $$PWD/src/itemviews/models/qtcachingproxymodel.h \
     $$PWD/src/itemviews/models/qttreeproxymodel.h \
+    $$PWD/src/itemviews/models/qtitemfilterproxymodel.h \
     $$PWD/src/widgets/qtspinboxedit.h \
     $$PWD/src/painting/qtpaintutils.h \
     $$PWD/src/itemviews/delegates/qtwidgetitemdelegate.h \
@@ -176,6 +177,7 @@ SOURCES += \
     $$PWD/src/itemviews/models/qtrevertibleproxymodel.cpp \
     $$PWD/src/itemviews/models/qtcachingproxymodel.cpp \
     $$PWD/src/itemviews/models/qttreeproxymodel.cpp \
+    $$PWD/src/itemviews/models/qtitemfilterproxymodel.cpp \
     $$PWD/src/widgets/qtspinboxedit.cpp \
     $$PWD/src/painting/qtpaintutils.cpp \
     $$PWD/src/itemviews/delegates/qtwidgetitemdelegate.cpp \
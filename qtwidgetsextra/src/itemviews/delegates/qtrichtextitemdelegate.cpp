@@ -12,26 +12,103 @@
 #include <QTextLayout>
 #include <QStaticText>
 
+#include <QTextDocument>
+#include <QAbstractTextDocumentLayout>
+#include <QCache>
+#include <QtMath>
+
 #include <QColor>
 #include <QPainter>
 
 #include "qtrichtextitemdelegate.h"
 
 
+namespace
+{
+
+// Key of laid out document
+struct LayoutKey
+{
+    QString text;
+    QFont font;
+    int width; // text width, -1 if text is not wrapped
+
+    inline bool operator==(const LayoutKey& other) const
+    {
+        return (width == other.width && font == other.font && text == other.text);
+    }
+};
+
+inline uint qHash(const LayoutKey& key, uint seed = 0)
+{
+    uint h = ::qHash(key.text, seed);
+    h = h * 31 + ::qHash(key.font);
+    return h * 31 + ::qHash(key.width);
+}
+
+// Text without markup and line breaks looks
+// the same as plain text and rich text
+inline bool isPlainText(const QString& text, Qt::TextFormat format)
+{
+    if (format == Qt::PlainText)
+        return true;
+    if (format == Qt::AutoText)
+        return !Qt::mightBeRichText(text);
+
+    for (auto it = text.cbegin(); it != text.cend(); ++it) {
+        const QChar c = *it;
+        if (c == QLatin1Char('<') || c == QLatin1Char('&') || c == QLatin1Char('\n'))
+            return false;
+    }
+    return true;
+}
+
+}
+
 class QtRichTextItemDelegatePrivate
 {
 public:
     //mutable QHeaderView* headerView;
     Qt::TextFormat format;
-    mutable QTextDocument document;
+    mutable QCache<LayoutKey, QTextDocument> layouts; // shared by paint() and sizeHint()
 
     QtRichTextItemDelegatePrivate();
+
+    QTextDocument* layout(const QString& text, const QFont& font, int width) const;
+    static int textWidth(const QStyleOptionViewItem& option);
 };
 
 QtRichTextItemDelegatePrivate::QtRichTextItemDelegatePrivate() :
     // headerView(Q_NULLPTR)
-    format(Qt::AutoText)
+    format(Qt::AutoText),
+    layouts(256)
+{
+}
+
+QTextDocument *QtRichTextItemDelegatePrivate::layout(const QString &text, const QFont &font, int width) const
+{
+    LayoutKey key = { text, font, width };
+    if (QTextDocument* document = layouts.object(key))
+        return document;
+
+    QTextDocument* document = new QTextDocument;
+    document->setUndoRedoEnabled(false);
+    document->setDefaultFont(font);
+    document->setDocumentMargin(0);
+    document->setTextWidth(width);
+    document->setHtml(text);
+    document->size(); // run layout now, not on every draw
+    layouts.insert(key, document);
+    return document;
+}
+
+int QtRichTextItemDelegatePrivate::textWidth(const QStyleOptionViewItem &option)
 {
+    // text is drawn right to the icon with 2 pixel margin
+    int width = option.rect.width() - 2;
+    if (option.features & QStyleOptionViewItem::HasDecoration)
+        width -= option.decorationSize.width();
+    return (width > 0 ? width : -1);
 }
 
 
@@ -59,6 +136,31 @@ Qt::TextFormat QtRichTextItemDelegate::textFormat() const
     return d->format;
 }
 
+// Maximum number of laid out documents kept in cache
+void QtRichTextItemDelegate::setMaxCacheSize(int maxSize)
+{
+    Q_D(QtRichTextItemDelegate);
+    d->layouts.setMaxCost(qMax(0, maxSize));
+}
+
+int QtRichTextItemDelegate::maxCacheSize() const
+{
+    Q_D(const QtRichTextItemDelegate);
+    return d->layouts.maxCost();
+}
+
+int QtRichTextItemDelegate::cacheSize() const
+{
+    Q_D(const QtRichTextItemDelegate);
+    return d->layouts.size();
+}
+
+void QtRichTextItemDelegate::clearCache()
+{
+    Q_D(QtRichTextItemDelegate);
+    d->layouts.clear();
+}
+
 void QtRichTextItemDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
 {
     Q_D(const QtRichTextItemDelegate);
@@ -67,42 +169,43 @@ void QtRichTextItemDelegate::paint(QPainter *painter, const QStyleOptionViewItem
         return;
     }
 
-    QString text = option.text;//index.data(Qt::EditRole).toString();
-    if (d->format == Qt::AutoText) {
-        if (!Qt::mightBeRichText(text)) {
-            QStyledItemDelegate::paint(painter, option, index);
-            return;
-        }
-    }
-
-    QIcon icon = index.data(Qt::DecorationRole).value<QIcon>();
-
     QStyleOptionViewItem options = option;
-    //initStyleOption(&options, index);
+    initStyleOption(&options, index);
 
-    QStyle *style = option.widget? option.widget->style() : qApp->style();
+    // fast path: no markup - draw as plain text
+    if (isPlainText(options.text, d->format)) {
+        QStyledItemDelegate::paint(painter, option, index);
+        return;
+    }
 
-    d->document.setDefaultFont(option.font);
-    d->document.setDocumentMargin(0);
-    d->document.setTextWidth(option.rect.width());
-    d->document.setHtml(text);
+    QTextDocument* document = d->layout(options.text, options.font, QtRichTextItemDelegatePrivate::textWidth(options));
 
-    options.text = "";
+    QStyle *style = option.widget? option.widget->style() : qApp->style();
 
+    options.text = QString();
 
     painter->save();
 
-    style->drawControl(QStyle::CE_ItemViewItem, &options, painter);
+    style->drawControl(QStyle::CE_ItemViewItem, &options, painter, options.widget);
 
     // shift text right to make icon visible
     QSize iconSize;
-    if (!icon.isNull()) {
-         iconSize = icon.actualSize(options.rect.size());
-    }
+    if (options.features & QStyleOptionViewItem::HasDecoration)
+        iconSize = options.decorationSize;
 
     painter->translate(options.rect.left() + 2 + iconSize.width(), options.rect.top() + 1);
     QRect clip(0, 0, options.rect.width() - iconSize.width(), options.rect.height());
-    d->document.drawContents(painter, clip);
+
+    // colors are applied on drawing, so layout does not depend on them
+    QAbstractTextDocumentLayout::PaintContext context;
+    context.palette = options.palette;
+    if (options.state & QStyle::State_Selected) {
+        const QPalette::ColorGroup group = (options.state & QStyle::State_Enabled ? QPalette::Normal : QPalette::Disabled);
+        context.palette.setColor(QPalette::Text, options.palette.color(group, QPalette::HighlightedText));
+    }
+    context.clip = clip;
+    painter->setClipRect(clip);
+    document->documentLayout()->draw(painter, context);
     painter->restore();
 
 #if 0
@@ -160,6 +263,7 @@ void QtRichTextItemDelegate::paint(QPainter *painter, const QStyleOptionViewItem
 
 QSize QtRichTextItemDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
 {
+    Q_D(const QtRichTextItemDelegate);
     QVariant value = index.data(Qt::SizeHintRole);
     if (value.isValid())
         return qvariant_cast<QSize>(value);
@@ -167,20 +271,19 @@ QSize QtRichTextItemDelegate::sizeHint(const QStyleOptionViewItem &option, const
     QStyleOptionViewItem options(option);
     initStyleOption(&options, index);
 
-    QTextOption textOption(Qt::AlignLeft);
-    textOption.setWrapMode(QTextOption::WordWrap);
+    if (isPlainText(options.text, d->format))
+        return QStyledItemDelegate::sizeHint(option, index);
 
-    QStyle *style = option.widget ? option.widget->style() : QApplication::style();
-    QSize itemSize = style->sizeFromContents(QStyle::CT_ItemViewItem, &option, QSize(), option.widget);
+    QTextDocument* document = d->layout(options.text, options.font, QtRichTextItemDelegatePrivate::textWidth(options));
 
-    QString text = index.data(Qt::EditRole).toString();
+    int iconWidth = 0;
+    if (options.features & QStyleOptionViewItem::HasDecoration)
+        iconWidth = options.decorationSize.width();
 
-    QStaticText staticText;
-    staticText.setTextWidth(option.rect.width());
-    staticText.setTextOption(textOption);
-    staticText.setText(text);
-    QSize textSize = staticText.size().toSize();
-    return QSize(itemSize.width() + 2, textSize.height() - option.fontMetrics.height() > 2 ? textSize.height() : option.fontMetrics.height()+2);
+    const QSize textSize = document->size().toSize();
+    const int fontHeight = options.fontMetrics.height();
+    return QSize(iconWidth + 2 + qCeil(document->idealWidth()),
+                 textSize.height() - fontHeight > 2 ? textSize.height() : fontHeight + 2);
 }
 
 /*
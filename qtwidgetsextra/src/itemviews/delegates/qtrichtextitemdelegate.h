@@ -6,6 +6,14 @@
 
 class QHeaderView;
 
+/*!
+ * \brief The QtRichTextItemDelegate class
+ *
+ * Delegate that draws item text as rich text. Laid out
+ * documents are kept in LRU cache keyed by text, font
+ * and text width, so repaints and sizeHint() reuse the
+ * layout; text without markup is drawn as plain text.
+ */
 class QTWIDGETSEXTRA_EXPORT QtRichTextItemDelegate :
         public QStyledItemDelegate
 {
@@ -18,6 +26,10 @@ public:
     void setTextFormat(Qt::TextFormat format);
     Qt::TextFormat textFormat() const;
 
+    void setMaxCacheSize(int maxSize);
+    int maxCacheSize() const;
+    int cacheSize() const;
+
     // QAbstractItemDelegate interface
 public:
     virtual void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const Q_DECL_OVERRIDE;
@@ -31,6 +43,9 @@ public:
     virtual void setModelData(QWidget *editor, QAbstractItemModel *model, const QModelIndex &index) const Q_DECL_OVERRIDE;
     virtual void updateEditorGeometry(QWidget *editor, const QStyleOptionViewItem &option, const QModelIndex &) const Q_DECL_OVERRIDE;
 
+public Q_SLOTS:
+    void clearCache();
+
 Q_SIGNALS:
     void textFormatChanged(Qt::TextFormat);
 
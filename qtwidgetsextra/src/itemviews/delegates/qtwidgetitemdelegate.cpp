@@ -3,7 +3,13 @@
 #include <QPainter>
 #include <QEvent>
 #include <QMouseEvent>
-#include <QPixmapCache>
+#include <QCache>
+#include <QSet>
+#include <QTimer>
+#include <QPointer>
+#include <QDataStream>
+#include <QIcon>
+#include <QImage>
 #include <QApplication>
 #include <QAbstractItemView>
 #include <QAbstractButton>
@@ -16,22 +22,89 @@ namespace
 {
 Q_CONSTEXPR const char* isButtonDownProperty = "down";
 
-// Compute hash of model index and size of it cell representation.
-// Hashing is doing by first packing row/column of index
-// and width/height of size into 64-bit unsigned integers
-// and reinterpreting them as a QLatin-1 string: this is
-// one of the fastest methods
-QString hashIndex(const QModelIndex& index, const QSize& size)
+// Style state bits that can change item appearance
+const int renderStateMask = QStyle::State_Enabled | QStyle::State_Active |
+                                        QStyle::State_Selected | QStyle::State_MouseOver |
+                                        QStyle::State_HasFocus | QStyle::State_Editing;
+
+// Number of cells rendered in advance per idle pass
+Q_CONSTEXPR const int prefetchChunkSize = 8;
+
+// Hash of variant value; types without hash function
+// are hashed by their serialized or string form
+uint hashVariant(const QVariant& value, uint seed)
 {
-    char buf[2 * sizeof(uint64_t)];
+    switch (value.userType())
+    {
+    case QMetaType::UnknownType:
+        return seed;
+    case QMetaType::Bool:
+    case QMetaType::Int:
+        return qHash(value.toInt(), seed);
+    case QMetaType::UInt:
+        return qHash(value.toUInt(), seed);
+    case QMetaType::LongLong:
+    case QMetaType::ULongLong:
+        return qHash(value.toLongLong(), seed);
+    case QMetaType::Double:
+        return qHash(value.toDouble(), seed);
+    case QMetaType::QString:
+        return qHash(value.toString(), seed);
+    case QMetaType::QStringList:
+        return qHash(value.toStringList(), seed);
+    case QMetaType::QByteArray:
+        return qHash(value.toByteArray(), seed);
+    case QMetaType::QColor:
+        return qHash(value.value<QColor>().rgba(), seed);
+    case QMetaType::QPixmap:
+        return qHash(value.value<QPixmap>().cacheKey(), seed);
+    case QMetaType::QImage:
+        return qHash(value.value<QImage>().cacheKey(), seed);
+    case QMetaType::QIcon:
+        return qHash(value.value<QIcon>().cacheKey(), seed);
+    default:
+        break;
+    }
 
-    uint64_t h1 = uint64_t(index.row()) | uint64_t(index.column()) << 32; // pack index
-    memcpy(buf + sizeof(uint64_t) * 0, &h1, sizeof(uint64_t)); // a la std::bit_cast
+    QByteArray bytes;
+    QDataStream stream(&bytes, QIODevice::WriteOnly);
+    if (QMetaType::save(stream, value.userType(), value.constData()))
+        return qHash(bytes, seed);
+    if (value.canConvert<QString>())
+        return qHash(value.toString(), seed);
+    return qHash(value.userType(), seed);
+}
+
+// Key of rendered item pixmap
+struct RenderKey
+{
+    quint64 content; // hash of item data
+    QSize size;
+    qreal dpr;
+    int state; // item style state
+    int widgetState; // sub-widget style state
+
+    inline bool operator==(const RenderKey& other) const
+    {
+        return (content == other.content && size == other.size && dpr == other.dpr &&
+                state == other.state && widgetState == other.widgetState);
+    }
+};
 
-    uint64_t h2 = uint64_t(size.width()) | uint64_t(size.height()) << 32; // pack size
-    memcpy(buf + sizeof(uint64_t) * 1, &h2, sizeof(uint64_t)); // a la std::bit_cast
+inline uint qHash(const RenderKey& key, uint seed = 0)
+{
+    uint h = ::qHash(key.content, seed);
+    h = h * 31 + ::qHash(key.size.width());
+    h = h * 31 + ::qHash(key.size.height());
+    h = h * 31 + ::qHash(key.dpr);
+    h = h * 31 + ::qHash(key.state);
+    return h * 31 + ::qHash(key.widgetState);
+}
 
-   return QLatin1String(buf, sizeof(buf)); // reinterpret as a string
+// Cost of pixmap in kilobytes
+inline int pixmapCost(const QPixmap& pixmap)
+{
+    return qMax(1, static_cast<int>(qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8 / 1024));
 }
 
 }
@@ -59,36 +132,71 @@ public:
     mutable WidgetState currentState; // current sub-widget state (sub-widget that under mouse cursor)
     mutable QModelIndex currentIndex; // current model index (index that under mouse cursor)
     mutable std::unique_ptr<QtItemWidget> widget; // widget to embed
-    QPixmapCache cache;
+    mutable QVector<int> roles; // roles that widget reads
+    mutable QCache<RenderKey, QPixmap> cache; // cost in kilobytes
+    mutable quint64 hits;
+    mutable quint64 misses;
     QWidget::RenderFlags flags; // widget rendering flags
     bool cacheEnabled : 1; // does cachild enabled
     bool staticContents : 1; // hint for static contents (in that case we don't need to handle sub-widget state)
     bool eventFilterEnabled : 1; // use QObject::eventFilter() or QStyleItemDelegate::editorEvent() for external event handling
+    bool prefetchEnabled : 1; // render next page of items in advance
+
+    // cells painted during current paint event,
+    // the same number of rows below them is prefetched
+    mutable QTimer prefetchTimer;
+    mutable QPointer<QAbstractItemView> prefetchView;
+    mutable QPersistentModelIndex prefetchParent;
+    mutable QStyleOptionViewItem prefetchOption;
+    mutable QPoint paintedRows;    // first and last painted row
+    mutable QPoint paintedColumns; // first and last painted column
+    mutable bool painting;         // paint event in progress
+    mutable bool prefetchNested;   // painted items are not top-level
+    mutable int prefetchRow;
+    mutable int prefetchEnd;
 
     QtWidgetItemDelegatePrivate()
-        : flags(QWidget::DrawChildren | QWidget::DrawWindowBackground)
+        : cache(10240)
+        , hits(0)
+        , misses(0)
+        , flags(QWidget::DrawChildren | QWidget::DrawWindowBackground)
         , cacheEnabled(true)
         , staticContents(true)
         , eventFilterEnabled(false)
-    {}
+        , prefetchEnabled(false)
+        , painting(false)
+        , prefetchNested(false)
+        , prefetchRow(0)
+        , prefetchEnd(0)
+    {
+        prefetchTimer.setSingleShot(true);
+        prefetchTimer.setInterval(0);
+    }
 
-    bool findPixmap(const QString& key, QPixmap& p) const
+    bool findPixmap(const RenderKey& key, QPixmap& p) const
     {
-        // here we can use more elaborated cache,
-        // but for simplicity we currently use QPixmapCache
-        return cache.find(key, &p);
+        if (QPixmap* cached = cache.object(key)) {
+            p = *cached;
+            ++hits;
+            return true;
+        }
+        ++misses;
+        return false;
     }
 
-    void cachePixmap(const QString& key, const QPixmap& p) const
+    void cachePixmap(const RenderKey& key, const QPixmap& p) const
     {
-        // here we can use more elaborated cache,
-        // but for simplicity we currently use QPixmapCache
-        cache.insert(key, p);
+        cache.insert(key, new QPixmap(p), pixmapCost(p));
     }
 
+    RenderKey renderKey(const QStyleOptionViewItem &option, const QModelIndex &index, qreal dpr, const QtWidgetItemDelegate *delegate) const;
+    QPixmap renderPixmap(const QStyleOptionViewItem &option, const QModelIndex &index, qreal dpr, const QtWidgetItemDelegate *delegate) const;
+
     void renderDirect(QPainter* painter, const QRect& rect) const;
     void renderCached(QPainter* painter, const QStyleOptionViewItem &option, const QModelIndex &index, const QtWidgetItemDelegate *delegate) const;
 
+    void notePainted(const QStyleOptionViewItem &option, const QModelIndex &index) const;
+
     void clearState() const;
     void resetState() const;
     void applyState() const;
@@ -96,6 +204,31 @@ public:
 };
 
 
+RenderKey QtWidgetItemDelegatePrivate::renderKey(const QStyleOptionViewItem &option, const QModelIndex &index, qreal dpr, const QtWidgetItemDelegate *delegate) const
+{
+    RenderKey key;
+    key.content = delegate->contentHash(index);
+    key.size = option.rect.size();
+    key.dpr = dpr;
+    key.state = (option.state & renderStateMask);
+    // dynamic contents: sub-widget under mouse is drawn in its own state
+    key.widgetState = (!staticContents && currentIndex == index ? int(currentState.state) : 0);
+    return key;
+}
+
+QPixmap QtWidgetItemDelegatePrivate::renderPixmap(const QStyleOptionViewItem &option, const QModelIndex &index, qreal dpr, const QtWidgetItemDelegate *delegate) const
+{
+    delegate->updateWidgetData(index, option); // update widget data
+
+    QPixmap pixmap(option.rect.size() * dpr);
+    pixmap.setDevicePixelRatio(dpr);
+    pixmap.fill(Qt::transparent);
+
+    QPainter pixmapPainter(&pixmap);
+    widget->render(&pixmapPainter, QPoint(), QRegion(), flags);
+    return pixmap;
+}
+
 void QtWidgetItemDelegatePrivate::renderDirect(QPainter *painter, const QRect &rect) const
 {
     painter->save();
@@ -107,30 +240,45 @@ void QtWidgetItemDelegatePrivate::renderDirect(QPainter *painter, const QRect &r
 void QtWidgetItemDelegatePrivate::renderCached(QPainter *painter, const QStyleOptionViewItem& option, const QModelIndex& index, const QtWidgetItemDelegate *delegate) const
 {
     // same as above - but use cache to speed-up things
-    const QString hashCode = hashIndex(index, option.rect.size());
+    const qreal dpr = painter->device()->devicePixelRatioF();
+    const RenderKey key = renderKey(option, index, dpr, delegate);
 
     QPixmap pixmap;
-    if (findPixmap(hashCode, pixmap)) // cache hit
+    if (!findPixmap(key, pixmap)) // cache miss
     {
-        painter->save();
-        painter->translate(option.rect.topLeft());
-        painter->drawPixmap(0, 0, pixmap); // draw pixmap from cache
-        painter->restore();
+        pixmap = renderPixmap(option, index, dpr, delegate);
+        cachePixmap(key, pixmap); // cache pixmap
     }
-    else // cache miss
-    {
-        delegate->updateWidgetData(index, option); // update widget data
-
-        pixmap = QPixmap(option.rect.size());
-        pixmap.fill(Qt::transparent);
-
-        QPainter pixmapPainter(&pixmap);
-        widget->render(&pixmapPainter, QPoint(), QRegion(), flags);
+    painter->drawPixmap(option.rect.topLeft(), pixmap);
+}
 
-        cachePixmap(hashCode, pixmap); // cache pixmap
+void QtWidgetItemDelegatePrivate::notePainted(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    auto view = qobject_cast<QAbstractItemView*>(const_cast<QWidget*>(option.widget));
+    if (view == Q_NULLPTR)
+        return;
 
-        painter->drawPixmap(option.rect.topLeft(), pixmap);
+    // first cell of new paint event
+    if (!painting || view != prefetchView || index.parent() != prefetchParent)
+    {
+        painting = true;
+        prefetchView = view;
+        prefetchParent = index.parent();
+        prefetchNested = prefetchParent.isValid();
+        prefetchOption = option;
+        prefetchOption.state &= ~(QStyle::State_Selected | QStyle::State_MouseOver | QStyle::State_HasFocus);
+        paintedRows = QPoint(index.row(), index.row());
+        paintedColumns = QPoint(index.column(), index.column());
     }
+    else
+    {
+        paintedRows.rx() = qMin(paintedRows.x(), index.row());
+        paintedRows.ry() = qMax(paintedRows.y(), index.row());
+        paintedColumns.rx() = qMin(paintedColumns.x(), index.column());
+        paintedColumns.ry() = qMax(paintedColumns.y(), index.column());
+    }
+    // zero timer fires when paint event is over
+    prefetchTimer.start();
 }
 
 void QtWidgetItemDelegatePrivate::clearState() const
@@ -183,7 +331,7 @@ QtWidgetItemDelegate::QtWidgetItemDelegate(QObject *parent)
     , d_ptr(new QtWidgetItemDelegatePrivate)
 {
     Q_D(QtWidgetItemDelegate);
-    d->cache.setCacheLimit(512);
+    connect(&d->prefetchTimer, &QTimer::timeout, this, &QtWidgetItemDelegate::prefetch);
 }
 
 QtWidgetItemDelegate::~QtWidgetItemDelegate()
@@ -234,13 +382,59 @@ bool QtWidgetItemDelegate::isCacheEnabled() const
 void QtWidgetItemDelegate::setCacheLimit(int cacheSize)
 {
     Q_D(QtWidgetItemDelegate);
-    d->cache.setCacheLimit(cacheSize);
+    d->cache.setMaxCost(qMax(0, cacheSize));
 }
 
+// Maximum size of cached pixmaps in kilobytes
 int QtWidgetItemDelegate::cacheLimit() const
 {
     Q_D(const QtWidgetItemDelegate);
-    return d->cache.cacheLimit();
+    return d->cache.maxCost();
+}
+
+// Size of cached pixmaps in kilobytes
+int QtWidgetItemDelegate::cacheSize() const
+{
+    Q_D(const QtWidgetItemDelegate);
+    return d->cache.totalCost();
+}
+
+// Prefetch renders page of items below painted ones
+// into the cache, while event loop is idle
+void QtWidgetItemDelegate::setPrefetchEnabled(bool on)
+{
+    Q_D(QtWidgetItemDelegate);
+    d->prefetchEnabled = on;
+    if (!on) {
+        d->prefetchTimer.stop();
+        d->painting = false;
+        d->prefetchRow = d->prefetchEnd = 0;
+    }
+}
+
+bool QtWidgetItemDelegate::isPrefetchEnabled() const
+{
+    Q_D(const QtWidgetItemDelegate);
+    return d->prefetchEnabled;
+}
+
+quint64 QtWidgetItemDelegate::cacheHits() const
+{
+    Q_D(const QtWidgetItemDelegate);
+    return d->hits;
+}
+
+quint64 QtWidgetItemDelegate::cacheMisses() const
+{
+    Q_D(const QtWidgetItemDelegate);
+    return d->misses;
+}
+
+void QtWidgetItemDelegate::resetStatistics()
+{
+    Q_D(QtWidgetItemDelegate);
+    d->hits = 0;
+    d->misses = 0;
 }
 
 void QtWidgetItemDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
@@ -312,6 +506,8 @@ void QtWidgetItemDelegate::paint(QPainter *painter, const QStyleOptionViewItem &
     else
     {
         d->renderCached(painter, option, index, this);
+        if (d->prefetchEnabled)
+            d->notePainted(option, index);
     }
 }
 
@@ -327,6 +523,25 @@ QtWidgetItemDelegate::RenderHint QtWidgetItemDelegate::renderHint(const QStyleOp
     return (((option.state & (QStyle::State_MouseOver|QStyle::State_Selected)) || !d->cacheEnabled) ? RenderHint::RenderDirect : RenderHint::RenderCached);
 }
 
+// Hash of item contents used as cache key - items with
+// equal hashes are drawn with the same cached pixmap.
+// By default data of item widget roles is hashed;
+// derived classes can overload this method if widget
+// appearance depends on something beyond these roles
+quint64 QtWidgetItemDelegate::contentHash(const QModelIndex &index) const
+{
+    Q_D(const QtWidgetItemDelegate);
+    // two 32-bit hashes with different seeds make collisions unlikely
+    uint h1 = 0, h2 = 0x9e3779b9u;
+    for (auto it = d->roles.cbegin(); it != d->roles.cend(); ++it)
+    {
+        const QVariant value = index.data(*it);
+        h1 = hashVariant(value, h1 * 31 + *it);
+        h2 = hashVariant(value, h2 ^ (h2 << 6) ^ *it);
+    }
+    return (quint64(h1) << 32) | h2;
+}
+
 QtItemWidget *QtWidgetItemDelegate::widget() const
 {
     Q_D(const QtWidgetItemDelegate);
@@ -365,6 +580,7 @@ void QtWidgetItemDelegate::createWidgetOnDemand() const
     // This also important: we adjust widget size beforehand
     // to get correct value for sizeHint() overriden method
     d->widget->adjustSize();
+    d->roles = d->widget->dataRoles();
 }
 
 void QtWidgetItemDelegate::updateWidgetData(const QModelIndex& index, const QStyleOptionViewItem& option) const
@@ -489,25 +705,94 @@ void QtWidgetItemDelegate::invalidate()
     Q_EMIT requestRepaint();
 }
 
+// Cache is addressed by contents, so changed items are
+// rendered anew anyway; these methods drop pixmaps of
+// current item contents, e.g. when widget appearance
+// depends on something beyond contentHash()
 void QtWidgetItemDelegate::invalidateIndex(const QModelIndex &index)
 {
-    Q_D(QtWidgetItemDelegate);
-    auto view = qobject_cast<QAbstractItemView*>(parent());
-    if (view)
-        d->cache.remove(hashIndex(index, view->visualRect(index).size()));
+    invalidateRange(index, index);
 }
 
 void QtWidgetItemDelegate::invalidateRange(const QModelIndex &topLeft, const QModelIndex &bottomRight)
 {
     Q_D(QtWidgetItemDelegate);
-    auto view = qobject_cast<QAbstractItemView*>(parent());
-    if (!view)
+    if (!topLeft.isValid() || !bottomRight.isValid() || d->cache.isEmpty())
         return;
 
-    const QModelIndex index = topLeft;
+    createWidgetOnDemand();
+
+    QSet<quint64> contents;
     for (int i = topLeft.row(), n = bottomRight.row(); i <= n; ++i)
         for (int j = topLeft.column(), m = bottomRight.column(); j <= m; ++j)
-            d->cache.remove(hashIndex(index.sibling(i, j), view->visualRect(index).size()));
+            contents.insert(contentHash(topLeft.sibling(i, j)));
+
+    const QList<RenderKey> keys = d->cache.keys();
+    for (auto it = keys.cbegin(); it != keys.cend(); ++it)
+        if (contents.contains(it->content))
+            d->cache.remove(*it);
+}
+
+void QtWidgetItemDelegate::prefetch()
+{
+    Q_D(QtWidgetItemDelegate);
+    QAbstractItemView* view = d->prefetchView.data();
+    if (!d->prefetchEnabled || !d->cacheEnabled || !d->widget || !view || !view->model())
+        return;
+
+    QAbstractItemModel* model = view->model();
+    const QModelIndex parent = d->prefetchParent;
+    if (d->prefetchNested != parent.isValid() || (parent.isValid() && parent.model() != model))
+        return; // parent item was removed
+
+    if (d->painting)
+    {
+        // paint event is over: next page starts below last painted row
+        d->painting = false;
+        d->prefetchRow = d->paintedRows.y() + 1;
+        d->prefetchEnd = d->prefetchRow + (d->paintedRows.y() - d->paintedRows.x() + 1);
+    }
+    d->prefetchEnd = qMin(d->prefetchEnd, model->rowCount(parent));
+
+    const qreal dpr = view->viewport()->devicePixelRatioF();
+    d->resetState(); // sub-widget states are not cached
+
+    int rendered = 0;
+    for (; d->prefetchRow < d->prefetchEnd && rendered < prefetchChunkSize; ++d->prefetchRow)
+    {
+        for (int column = d->paintedColumns.x(); column <= d->paintedColumns.y(); ++column)
+        {
+            const QModelIndex index = model->index(d->prefetchRow, column, parent);
+            if (!index.isValid() || view->itemDelegate(index) != this)
+                continue;
+
+            QStyleOptionViewItem option = d->prefetchOption;
+            option.rect = view->visualRect(index);
+            if (option.rect.isEmpty() || renderHint(option, index) != RenderCached)
+                continue;
+
+            const RenderKey key = d->renderKey(option, index, dpr, this);
+            if (d->cache.contains(key))
+                continue;
+
+            if (d->widget->size() != option.rect.size())
+                d->widget->resize(option.rect.size());
+
+            const QPixmap pixmap = d->renderPixmap(option, index, dpr, this);
+            const int cost = pixmapCost(pixmap);
+            if (d->cache.totalCost() + cost > d->cache.maxCost())
+            {
+                // don't push out pixmaps of visible items
+                d->prefetchRow = d->prefetchEnd;
+                return;
+            }
+            d->cachePixmap(key, pixmap);
+            ++rendered;
+        }
+    }
+
+    if (d->prefetchRow < d->prefetchEnd)
+        d->prefetchTimer.start(); // continue on next idle pass
 }
 
 
@@ -524,6 +809,14 @@ void QtItemWidget::setData(const QModelIndex&, const QStyleOptionViewItem &)
     // does nothing by default
 }
 
+// Roles hashed to address cached renderings of item: widgets
+// that read other roles in setData() should overload this
+QVector<int> QtItemWidget::dataRoles() const
+{
+    return QVector<int>() << Qt::DisplayRole << Qt::DecorationRole << Qt::EditRole
+                          << Qt::ToolTipRole << Qt::CheckStateRole;
+}
+
 bool QtItemWidget::viewportEvent(QEvent *e, QWidget*)
 {
     return QWidget::event(e);
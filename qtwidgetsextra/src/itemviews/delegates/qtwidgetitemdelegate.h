@@ -2,6 +2,7 @@
 #define QTWIDGETITEMDELEGATE_H
 
 #include <QStyledItemDelegate>
+#include <QVector>
 
 #include <QtWidgetsExtra>
 
@@ -11,6 +12,15 @@ class QtItemWidget;
 // class QtWidgetItemDelegate provides the ability
 // to embed custom widgets as elements of QAbstractItemView
 //
+// Cached renderings are addressed by content: the key is
+// a hash of the roles that item widget reads (see
+// QtItemWidget::dataRoles()), cell size, device pixel
+// ratio and style state. Changed cells get new pixmaps
+// without explicit invalidation, and cells with equal
+// contents share one pixmap, no matter where they are
+// moved by sorting or filtering. Pixmaps are kept in
+// delegate's own cache within cacheLimit() kilobytes.
+//
 class QTWIDGETSEXTRA_EXPORT QtWidgetItemDelegate : public QStyledItemDelegate
 {
     Q_OBJECT
@@ -35,6 +45,14 @@ public:
 
     void setCacheLimit(int cacheSize);
     int cacheLimit() const;
+    int cacheSize() const;
+
+    void setPrefetchEnabled(bool on);
+    bool isPrefetchEnabled() const;
+
+    quint64 cacheHits() const;
+    quint64 cacheMisses() const;
+    void resetStatistics();
 
     // QAbstractItemDelegate interface
 public:
@@ -59,12 +77,16 @@ protected:
     virtual QtItemWidget* createItemWidget() const = 0;
     virtual void updateWidgetData(const QModelIndex& index, const QStyleOptionViewItem &option) const;
     virtual RenderHint renderHint(const QStyleOptionViewItem &option, const QModelIndex &) const;
+    virtual quint64 contentHash(const QModelIndex& index) const;
 
     QtItemWidget* widget() const;
 
 protected:
     void createWidgetOnDemand() const;
 
+private Q_SLOTS:
+    void prefetch();
+
 private:
     QT_PIMPL(QtWidgetItemDelegate)
 };
@@ -81,6 +103,8 @@ public:
     virtual ~QtItemWidget();
 
     virtual void setData(const QModelIndex&, const QStyleOptionViewItem&);
+    // roles of index that setData() reads
+    virtual QVector<int> dataRoles() const;
 
 protected:
     virtual bool viewportEvent(QEvent *e, QWidget*);
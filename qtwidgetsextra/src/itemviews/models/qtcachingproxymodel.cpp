@@ -1,34 +1,364 @@
+#include <list>
 #include <vector>
+#include <algorithm>
 #include <unordered_map>
 #include <QBasicTimer>
 #include <QTimerEvent>
+#include <QElapsedTimer>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QPointer>
+#include <QScrollBar>
+#include <QAbstractItemView>
+#include <QPersistentModelIndex>
+#include <QStringList>
+#include <QPixmap>
+#include <QImage>
 #include "qtcachingproxymodel.h"
 
+namespace
+{
+
+struct CacheKey
+{
+    int row;
+    int column;
+    int role;
+
+    inline bool operator==(const CacheKey& other) const {
+        return (row == other.row && column == other.column && role == other.role);
+    }
+};
+
+struct CacheKeyHash
+{
+    size_t operator()(const CacheKey& key) const {
+        return qHash((quint64(quint32(key.row)) << 32) | quint32(key.column), uint(key.role));
+    }
+};
+
+struct CacheEntry
+{
+    CacheKey key;
+    QVariant value;
+    qint64 cost;
+    bool hot; // entry is in protected segment
+};
+
+typedef std::list<CacheEntry> CacheList;
+
+// Approximate memory consumed by cached value
+qint64 valueCost(const QVariant& value)
+{
+    qint64 cost = sizeof(CacheEntry) + 4 * sizeof(void*); // entry, list and hash nodes
+    switch (value.userType())
+    {
+    case QMetaType::QString:
+        cost += value.toString().size() * sizeof(QChar);
+        break;
+    case QMetaType::QByteArray:
+        cost += value.toByteArray().size();
+        break;
+    case QMetaType::QStringList:
+    {
+        const QStringList list = value.toStringList();
+        for (auto it = list.cbegin(); it != list.cend(); ++it)
+            cost += sizeof(QString) + it->size() * sizeof(QChar);
+        break;
+    }
+    case QMetaType::QPixmap:
+    {
+        const QPixmap pixmap = value.value<QPixmap>();
+        cost += qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+        break;
+    }
+    case QMetaType::QImage:
+    {
+        const QImage image = value.value<QImage>();
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+        cost += image.sizeInBytes();
+#else
+        cost += image.byteCount();
+#endif
+        break;
+    }
+    default:
+        break;
+    }
+    return cost;
+}
+
+// Share of cache budget reserved for protected segment, percents
+static const int HotShare = 80;
+
+// Duration of single idle-time prefetch slice, msecs
+static const int PrefetchSlice = 5;
+
+// Reads prefetch range of thread-safe source on worker thread
+class PrefetchTask : public QRunnable
+{
+public:
+    PrefetchTask(QtCachingProxyModel* proxy, QAbstractItemModel* source, const QAtomicInt* generation,
+                 int gen, int first, int last, int left, int right, const std::vector<int>& roles)
+        : proxy(proxy), source(source), generation(generation), gen(gen)
+        , first(first), last(last), left(left), right(right), roles(roles)
+    {}
+
+    void run() Q_DECL_OVERRIDE
+    {
+        QVariantList values;
+        values.reserve((last - first + 1) * (right - left + 1) * static_cast<int>(roles.size()));
+        for (int r = first; r <= last; ++r)
+        {
+            if (generation->load() != gen)
+                return; // source changed, results are useless
+            for (int c = left; c <= right; ++c) {
+                const QModelIndex index = source->index(r, c);
+                for (auto role : roles)
+                    values.push_back(index.data(role));
+            }
+        }
+        // proxy waits for the pool on destruction, so it is still alive here
+        QMetaObject::invokeMethod(proxy, "onPrefetched", Qt::QueuedConnection,
+                                  Q_ARG(int, gen), Q_ARG(int, first), Q_ARG(int, last),
+                                  Q_ARG(QVariantList, values));
+    }
+
+private:
+    QtCachingProxyModel* proxy;
+    QAbstractItemModel* source;
+    const QAtomicInt* generation;
+    int gen, first, last, left, right;
+    std::vector<int> roles;
+};
+
+}
+
 class QtCachingProxyModelPrivate
 {
 public:
-    mutable std::unordered_map<quint64, QVariant> cache;
+    Q_DECLARE_PUBLIC(QtCachingProxyModel)
+
+    QtCachingProxyModel* q_ptr;
+    mutable CacheList cold; // probation segment, most recent first
+    mutable CacheList hot;  // protected segment, most recent first
+    mutable std::unordered_map<CacheKey, CacheList::iterator, CacheKeyHash> cache;
+    mutable qint64 cost, hotCost;
+    mutable quint64 hits, misses, evictions;
+    std::vector<std::pair<int, QPersistentModelIndex>> layoutRows; // cached rows captured before layout change
     std::vector<int> cachedRoles;
+    qint64 budget;
     size_t maxCacheSize;
     int column;
     int interval;
     QBasicTimer timer;
     QtCachingProxyModel::CachingPolicy policy;
 
-    QtCachingProxyModelPrivate()
-        : maxCacheSize(100)
+    // prefetching
+    QPointer<QAbstractItemView> view;
+    std::vector<std::pair<int, int>> ranges; // pending ranges, first one is in progress
+    int visibleFirst, visibleLast;
+    int lookahead;
+    int cursor;        // next row of current range (idle-time mode)
+    int rangeFirst, rangeLast; // rows of current range fetched so far (idle-time mode)
+    std::pair<int, int> inflight; // rows being read by worker
+    bool refresh;      // re-read values that are already cached
+    bool busy;         // worker is reading current range
+    QAtomicInt generation; // bumped whenever cached rows become invalid
+    QBasicTimer idleTimer;
+    QThreadPool pool;
+
+    QtCachingProxyModelPrivate(QtCachingProxyModel* q)
+        : q_ptr(q)
+        , cost(0)
+        , hotCost(0)
+        , hits(0)
+        , misses(0)
+        , evictions(0)
+        , budget(8 * 1024 * 1024)
+        , maxCacheSize(INT_MAX)
         , column(0)
         , interval(10000)
         , policy(QtCachingProxyModel::ManualUpdate)
-    {}
+        , visibleFirst(-1)
+        , visibleLast(-1)
+        , lookahead(100)
+        , cursor(0)
+        , rangeFirst(-1)
+        , rangeLast(-1)
+        , inflight(-1, -1)
+        , refresh(false)
+        , busy(false)
+    {
+        pool.setMaxThreadCount(1);
+    }
+
+    // Drop pending prefetch work and results of running worker
+    inline void cancelPrefetch()
+    {
+        generation.ref();
+        ranges.clear();
+        idleTimer.stop();
+        busy = false;
+        refresh = false;
+    }
+
+    // Drop results of running worker and restart current range
+    inline void invalidatePrefetch()
+    {
+        generation.ref();
+        busy = false;
+        if (!ranges.empty())
+            idleTimer.start(0, q_ptr);
+    }
+
+    // Pending ranges refer to rows of the source before structural
+    // change: drop them and prefetch current visible window again
+    inline void restartPrefetch()
+    {
+        prefetch(visibleFirst, visibleLast, true, false); // cancels pending work first
+    }
+
+    inline bool isThreadSafe(const QAbstractItemModel* model) const
+    {
+        return model->property("threadSafe").toBool();
+    }
+
+    // Split window around visible rows into prefetch ranges
+    void prefetch(int first, int last, bool down, bool reload)
+    {
+        cancelPrefetch();
+        const QAbstractItemModel* model = q_ptr->sourceModel();
+        if (!model || first < 0 || cachedRoles.empty())
+            return;
+
+        const int n = model->rowCount();
+        last = qMin(last, n - 1);
+        if (first > last)
+            return;
+
+        const std::pair<int, int> below(last + 1, qMin(n - 1, last + lookahead));
+        const std::pair<int, int> above(qMax(0, first - lookahead), first - 1);
+        ranges.emplace_back(first, last);
+        ranges.push_back(down ? below : above);
+        ranges.push_back(down ? above : below);
+        ranges.erase(std::remove_if(ranges.begin(), ranges.end(),
+                                    [](const std::pair<int, int>& r) { return r.first > r.second; }),
+                     ranges.end());
+        cursor = first;
+        rangeFirst = rangeLast = -1;
+        refresh = reload;
+        idleTimer.start(0, q_ptr);
+    }
+
+    // Announce prefetched range and go on with the next one
+    void finishRange(int first, int last)
+    {
+        Q_Q(QtCachingProxyModel);
+        if (first >= 0 && first <= last) {
+            int left = 0, right = 0;
+            columnRange(q->sourceModel(), left, right);
+            Q_EMIT q->dataChanged(q->index(first, left), q->index(last, right),
+                                  QVector<int>(cachedRoles.begin(), cachedRoles.end()));
+        }
+        ranges.erase(ranges.begin());
+        rangeFirst = rangeLast = -1;
+        if (cost >= budget)
+            ranges.clear(); // further prefetching would only evict values
+        if (ranges.empty()) {
+            refresh = false;
+            return;
+        }
+        cursor = ranges.front().first;
+        idleTimer.start(0, q_ptr);
+    }
 
-    inline QVariant cacheValue(int row, int role, const QVariant& value) const
+    // Read current range on the GUI thread for at most PrefetchSlice msecs
+    void prefetchSlice()
     {
-        if (cache.size() > maxCacheSize)
-            cache.erase(cache.begin());
+        Q_Q(QtCachingProxyModel);
+        const QAbstractItemModel* model = q->sourceModel();
+        int left = 0, right = 0;
+        columnRange(model, left, right);
+
+        QElapsedTimer clock;
+        clock.start();
+        // never read past the end, even if range is outdated
+        const int last = qMin(ranges.front().second, model->rowCount() - 1);
+        int fetchedFirst = -1, fetchedLast = -1;
+        for (; cursor <= last && clock.elapsed() < PrefetchSlice; ++cursor)
+        {
+            bool fetched = false;
+            for (int c = left; c <= right; ++c)
+                for (auto role : cachedRoles) {
+                    const CacheKey key = indexate(cursor, c, role);
+                    if (!refresh && cache.count(key))
+                        continue;
+                    cacheValue(key, model->index(cursor, c).data(role));
+                    fetched = true;
+                }
+            if (fetched) {
+                fetchedFirst = (fetchedFirst < 0 ? cursor : fetchedFirst);
+                fetchedLast = cursor;
+            }
+        }
+
+        // range may take several slices: remember fetched rows until it is done
+        if (fetchedFirst >= 0) {
+            rangeFirst = (rangeFirst < 0 ? fetchedFirst : rangeFirst);
+            rangeLast = fetchedLast;
+        }
+
+        if (cursor > last) {
+            finishRange(rangeFirst, rangeLast);
+        } else {
+            idleTimer.start(0, q_ptr);
+        }
+    }
 
-        cache.emplace(indexate(row, role), value);
-        return value;
+    // Hand current range over to worker thread
+    void startWorker()
+    {
+        Q_Q(QtCachingProxyModel);
+        QAbstractItemModel* model = q->sourceModel();
+        int left = 0, right = 0;
+        columnRange(model, left, right);
+
+        // skip leading and trailing rows that are cached already
+        std::pair<int, int> range = ranges.front();
+        range.second = qMin(range.second, model->rowCount() - 1);
+        auto cached = [&](int row) {
+            for (int c = left; c <= right; ++c)
+                for (auto role : cachedRoles)
+                    if (!cache.count(indexate(row, c, role)))
+                        return false;
+            return true;
+        };
+        if (!refresh) {
+            while (range.first <= range.second && cached(range.first))
+                ++range.first;
+            while (range.second >= range.first && cached(range.second))
+                --range.second;
+        }
+        if (range.first > range.second) {
+            finishRange(-1, -1);
+            return;
+        }
+
+        busy = true;
+        inflight = range;
+        pool.start(new PrefetchTask(q, model, &generation, generation.load(),
+                                    range.first, range.second, left, right, cachedRoles));
+    }
+
+    void columnRange(const QAbstractItemModel* model, int& left, int& right) const
+    {
+        if (column < 0) {
+            left = 0;
+            right = model->columnCount() - 1;
+        } else {
+            left = right = column;
+        }
     }
 
     inline bool isCachedRole(int role) const
@@ -36,21 +366,144 @@ public:
         return std::find(cachedRoles.begin(), cachedRoles.end(), role) != cachedRoles.end();
     }
 
-    inline quint64 indexate(int row, int role) const
+    inline bool isCached(const QModelIndex& index, int role) const
+    {
+        return (index.isValid() && (column < 0 || index.column() == column) &&
+                isCachedRole(role) && !index.parent().isValid());
+    }
+
+    inline CacheKey indexate(int row, int column, int role) const
+    {
+        CacheKey key = { row, column, role };
+        return key;
+    }
+
+    // Look up value and update its recency
+    const QVariant* find(const CacheKey& key) const
+    {
+        auto it = cache.find(key);
+        if (it == cache.end()) {
+            ++misses;
+            return Q_NULLPTR;
+        }
+        ++hits;
+        touch(it->second);
+        return &it->second->value;
+    }
+
+    void touch(CacheList::iterator it) const
+    {
+        if (it->hot) {
+            hot.splice(hot.begin(), hot, it);
+            return;
+        }
+
+        // second hit: promote to protected segment
+        hot.splice(hot.begin(), cold, it);
+        it->hot = true;
+        hotCost += it->cost;
+
+        // demote least recently used protected values back to probation
+        const qint64 hotBudget = budget / 100 * HotShare;
+        while (hotCost > hotBudget && hot.size() > 1) {
+            auto last = std::prev(hot.end());
+            last->hot = false;
+            hotCost -= last->cost;
+            cold.splice(cold.begin(), hot, last);
+        }
+    }
+
+    const QVariant& cacheValue(const CacheKey& key, const QVariant& value) const
+    {
+        auto it = cache.find(key);
+        if (it != cache.end()) {
+            CacheEntry& entry = *it->second;
+            const qint64 delta = valueCost(value) - entry.cost;
+            entry.value = value;
+            entry.cost += delta;
+            cost += delta;
+            if (entry.hot)
+                hotCost += delta;
+            evict();
+            return (cache.count(key) ? entry.value : value);
+        }
+
+        CacheEntry entry = { key, value, valueCost(value), false };
+        cold.push_front(entry);
+        cache.emplace(key, cold.begin());
+        cost += entry.cost;
+        const QVariant& result = cold.front().value;
+        evict();
+        return (cache.count(key) ? result : value);
+    }
+
+    void erase(CacheList::iterator it) const
     {
-        return ((quint64)row) | (((quint64)role) << 32);
+        cost -= it->cost;
+        if (it->hot) {
+            hotCost -= it->cost;
+            hot.erase(it);
+        } else {
+            cold.erase(it);
+        }
+    }
+
+    void evict() const
+    {
+        while ((cost > budget || cache.size() > maxCacheSize) && !cache.empty())
+        {
+            // probation values go first
+            auto victim = std::prev(cold.empty() ? hot.end() : cold.end());
+            cache.erase(victim->key);
+            erase(victim);
+            ++evictions;
+        }
+    }
+
+    void clear()
+    {
+        cache.clear();
+        cold.clear();
+        hot.clear();
+        cost = hotCost = 0;
+        restartPrefetch();
+    }
+
+    // Re-key or drop every entry; fn returns false for entries to drop
+    template<class _Fn>
+    void rekey(_Fn fn)
+    {
+        cache.clear();
+        CacheList* lists[] = { &hot, &cold };
+        for (CacheList* list : lists)
+        {
+            for (auto it = list->begin(); it != list->end();)
+            {
+                if (fn(it->key)) {
+                    cache.emplace(it->key, it);
+                    ++it;
+                } else {
+                    auto next = std::next(it);
+                    erase(it);
+                    it = next;
+                }
+            }
+        }
     }
 };
 
 
 QtCachingProxyModel::QtCachingProxyModel(QObject *parent) :
     QIdentityProxyModel(parent),
-    d_ptr(new QtCachingProxyModelPrivate)
+    d_ptr(new QtCachingProxyModelPrivate(this))
 {
 }
 
 QtCachingProxyModel::~QtCachingProxyModel()
 {
+    Q_D(QtCachingProxyModel);
+    d->cancelPrefetch();
+    d->pool.waitForDone();
 }
 
 void QtCachingProxyModel::setCachingPolicy(QtCachingProxyModel::CachingPolicy policy)
@@ -98,14 +551,26 @@ void QtCachingProxyModel::setMaxCacheSize(int maxSize)
     if (maxSize < 0)
         maxSize = INT_MAX;
     d->maxCacheSize = static_cast<size_t>(maxSize);
-    while (d->cache.size() > d->maxCacheSize)
-        d->cache.erase(d->cache.begin()); // shrink cache to fit
+    d->evict(); // shrink cache to fit
 }
 
 int QtCachingProxyModel::maxCacheSize() const
 {
     Q_D(const QtCachingProxyModel);
-    return d->maxCacheSize;
+    return static_cast<int>(d->maxCacheSize);
+}
+
+void QtCachingProxyModel::setCacheBudget(qint64 bytes)
+{
+    Q_D(QtCachingProxyModel);
+    d->budget = qMax<qint64>(bytes, 0);
+    d->evict(); // shrink cache to fit
+}
+
+qint64 QtCachingProxyModel::cacheBudget() const
+{
+    Q_D(const QtCachingProxyModel);
+    return d->budget;
 }
 
 int QtCachingProxyModel::cacheSize() const
@@ -114,6 +579,36 @@ int QtCachingProxyModel::cacheSize() const
     return static_cast<int>(d->cache.size());
 }
 
+qint64 QtCachingProxyModel::cacheCost() const
+{
+    Q_D(const QtCachingProxyModel);
+    return d->cost;
+}
+
+quint64 QtCachingProxyModel::cacheHits() const
+{
+    Q_D(const QtCachingProxyModel);
+    return d->hits;
+}
+
+quint64 QtCachingProxyModel::cacheMisses() const
+{
+    Q_D(const QtCachingProxyModel);
+    return d->misses;
+}
+
+quint64 QtCachingProxyModel::cacheEvictions() const
+{
+    Q_D(const QtCachingProxyModel);
+    return d->evictions;
+}
+
+void QtCachingProxyModel::resetStatistics()
+{
+    Q_D(QtCachingProxyModel);
+    d->hits = d->misses = d->evictions = 0;
+}
+
 void QtCachingProxyModel::setCachedColumn(int column)
 {
     Q_D(QtCachingProxyModel);
@@ -149,8 +644,45 @@ const std::vector<int>& QtCachingProxyModel::cachedRoles() const
 void QtCachingProxyModel::setSourceModel(QAbstractItemModel *model)
 {
     Q_D(QtCachingProxyModel);
-    if (sourceModel() != model)
-        clearCache();
+    QAbstractItemModel* source = sourceModel();
+    if (source == model)
+        return;
+
+    d->cancelPrefetch();
+    d->pool.waitForDone(); // worker may still read the old source
+    clearCache();
+    d->cancelPrefetch(); // visible window belongs to the old source
+    if (source)
+    {
+        disconnect(source, &QAbstractItemModel::dataChanged, this, &QtCachingProxyModel::onSourceDataChanged);
+        disconnect(source, &QAbstractItemModel::rowsInserted, this, &QtCachingProxyModel::onSourceRowsInserted);
+        disconnect(source, &QAbstractItemModel::rowsRemoved, this, &QtCachingProxyModel::onSourceRowsRemoved);
+        disconnect(source, &QAbstractItemModel::layoutAboutToBeChanged, this, &QtCachingProxyModel::onSourceLayoutAboutToBeChanged);
+        disconnect(source, &QAbstractItemModel::layoutChanged, this, &QtCachingProxyModel::onSourceLayoutChanged);
+        disconnect(source, &QAbstractItemModel::rowsAboutToBeMoved, this, &QtCachingProxyModel::onSourceLayoutAboutToBeChanged);
+        disconnect(source, &QAbstractItemModel::rowsMoved, this, &QtCachingProxyModel::onSourceLayoutChanged);
+        disconnect(source, &QAbstractItemModel::columnsInserted, this, &QtCachingProxyModel::clearCache);
+        disconnect(source, &QAbstractItemModel::columnsRemoved, this, &QtCachingProxyModel::clearCache);
+        disconnect(source, &QAbstractItemModel::columnsMoved, this, &QtCachingProxyModel::clearCache);
+        disconnect(source, &QAbstractItemModel::modelReset, this, &QtCachingProxyModel::clearCache);
+    }
+
+    // connect before the base class: cache must be updated
+    // before the changes are forwarded to the views
+    if (model)
+    {
+        connect(model, &QAbstractItemModel::dataChanged, this, &QtCachingProxyModel::onSourceDataChanged);
+        connect(model, &QAbstractItemModel::rowsInserted, this, &QtCachingProxyModel::onSourceRowsInserted);
+        connect(model, &QAbstractItemModel::rowsRemoved, this, &QtCachingProxyModel::onSourceRowsRemoved);
+        connect(model, &QAbstractItemModel::layoutAboutToBeChanged, this, &QtCachingProxyModel::onSourceLayoutAboutToBeChanged);
+        connect(model, &QAbstractItemModel::layoutChanged, this, &QtCachingProxyModel::onSourceLayoutChanged);
+        connect(model, &QAbstractItemModel::rowsAboutToBeMoved, this, &QtCachingProxyModel::onSourceLayoutAboutToBeChanged);
+        connect(model, &QAbstractItemModel::rowsMoved, this, &QtCachingProxyModel::onSourceLayoutChanged);
+        connect(model, &QAbstractItemModel::columnsInserted, this, &QtCachingProxyModel::clearCache);
+        connect(model, &QAbstractItemModel::columnsRemoved, this, &QtCachingProxyModel::clearCache);
+        connect(model, &QAbstractItemModel::columnsMoved, this, &QtCachingProxyModel::clearCache);
+        connect(model, &QAbstractItemModel::modelReset, this, &QtCachingProxyModel::clearCache);
+    }
 
     QIdentityProxyModel::setSourceModel(model);
 }
@@ -160,13 +692,10 @@ bool QtCachingProxyModel::setData(const QModelIndex &proxyIndex, const QVariant
     Q_D(QtCachingProxyModel);
     if (QIdentityProxyModel::setData(proxyIndex, value, role))
     {
-        const QVariant value = proxyIndex.data(role);
-        const quint64 idx = d->indexate(proxyIndex.row(), role);
-        auto it = d->cache.find(idx);
-        if (it != d->cache.end()) // cache hit
-            it->second = value;
-        else // cache miss
-            d->cacheValue(proxyIndex.row(), role, value);
+        // source may adjust the value, so re-read it
+        if (d->isCached(proxyIndex, role))
+            d->cacheValue(d->indexate(proxyIndex.row(), proxyIndex.column(), role),
+                          QIdentityProxyModel::data(proxyIndex, role));
         return true;
     }
     return false;
@@ -175,14 +704,14 @@ bool QtCachingProxyModel::setData(const QModelIndex &proxyIndex, const QVariant
 QVariant QtCachingProxyModel::data(const QModelIndex &proxyIndex, int role) const
 {
     Q_D(const QtCachingProxyModel);
-    if (proxyIndex.isValid() && proxyIndex.column() == d->column && d->isCachedRole(role))
+    if (d->isCached(proxyIndex, role))
     {
-        const quint64 idx = d->indexate(proxyIndex.row(), role);
-        auto it = d->cache.find(idx);
-        if (it != d->cache.end()) // cache hit
-            return it->second;
+        const CacheKey key = d->indexate(proxyIndex.row(), proxyIndex.column(), role);
+        const QVariant* value = d->find(key);
+        if (value) // cache hit
+            return *value;
         else // cache miss
-            return d->cacheValue(proxyIndex.row(), role, QIdentityProxyModel::data(proxyIndex, role));
+            return d->cacheValue(key, QIdentityProxyModel::data(proxyIndex, role));
     }
     return QIdentityProxyModel::data(proxyIndex, role);
 }
@@ -190,21 +719,73 @@ QVariant QtCachingProxyModel::data(const QModelIndex &proxyIndex, int role) cons
 void QtCachingProxyModel::clearCache()
 {
     Q_D(QtCachingProxyModel);
-    d->cache.clear();
+    d->clear();
 }
 
 void QtCachingProxyModel::updateCache()
 {
-    // basic implementation does nothing
+    // basic implementation re-reads visible rows and lookahead
+    Q_D(QtCachingProxyModel);
+    d->prefetch(d->visibleFirst, d->visibleLast, true, true);
+}
+
+void QtCachingProxyModel::setVisibleRange(int first, int last)
+{
+    Q_D(QtCachingProxyModel);
+    if (d->visibleFirst == first && d->visibleLast == last)
+        return;
+
+    const bool down = (first >= d->visibleFirst);
+    d->visibleFirst = first;
+    d->visibleLast = last;
+    d->prefetch(first, last, down, false);
+}
+
+void QtCachingProxyModel::setPrefetchLookahead(int rows)
+{
+    Q_D(QtCachingProxyModel);
+    d->lookahead = qMax(rows, 0);
+}
+
+int QtCachingProxyModel::prefetchLookahead() const
+{
+    Q_D(const QtCachingProxyModel);
+    return d->lookahead;
+}
+
+void QtCachingProxyModel::attachView(QAbstractItemView *view)
+{
+    Q_D(QtCachingProxyModel);
+    if (d->view == view)
+        return;
+
+    if (d->view) {
+        disconnect(d->view->verticalScrollBar(), &QScrollBar::valueChanged, this, &QtCachingProxyModel::onViewScrolled);
+        disconnect(d->view->verticalScrollBar(), &QScrollBar::rangeChanged, this, &QtCachingProxyModel::onViewScrolled);
+    }
+
+    d->view = view;
+
+    if (d->view) {
+        connect(d->view->verticalScrollBar(), &QScrollBar::valueChanged, this, &QtCachingProxyModel::onViewScrolled);
+        connect(d->view->verticalScrollBar(), &QScrollBar::rangeChanged, this, &QtCachingProxyModel::onViewScrolled);
+        onViewScrolled();
+    }
+}
+
+QAbstractItemView *QtCachingProxyModel::attachedView() const
+{
+    Q_D(const QtCachingProxyModel);
+    return d->view;
 }
 
 void QtCachingProxyModel::cacheIndex(const QModelIndex &index)
 {
     Q_D(QtCachingProxyModel);
-    if (index.isValid() && index.column() == d->column)
+    for (auto role : d->cachedRoles)
     {
-        for (auto role : d->cachedRoles)
-            d->cacheValue(index.row(), role, index.data(role));
+        if (d->isCached(index, role))
+            d->cacheValue(d->indexate(index.row(), index.column(), role), QIdentityProxyModel::data(index, role));
     }
 }
 
@@ -214,5 +795,175 @@ void QtCachingProxyModel::timerEvent(QTimerEvent *event)
     if (event->timerId() == d->timer.timerId())
         updateCache();
 
+    if (event->timerId() == d->idleTimer.timerId())
+    {
+        d->idleTimer.stop();
+        if (d->ranges.empty() || d->busy || !sourceModel())
+            return;
+
+        if (d->isThreadSafe(sourceModel()))
+            d->startWorker();
+        else
+            d->prefetchSlice();
+        return;
+    }
+
     QIdentityProxyModel::timerEvent(event);
 }
+
+void QtCachingProxyModel::onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles)
+{
+    Q_D(QtCachingProxyModel);
+    if (topLeft.parent().isValid())
+        return;
+
+    // values read by worker may be outdated
+    if (d->busy && topLeft.row() <= d->inflight.second && bottomRight.row() >= d->inflight.first)
+        d->invalidatePrefetch();
+    if (d->cache.empty())
+        return;
+
+    const int top = topLeft.row(), bottom = bottomRight.row();
+    const int left = topLeft.column(), right = bottomRight.column();
+    const std::vector<int>& changed = (roles.isEmpty() ? d->cachedRoles : std::vector<int>(roles.begin(), roles.end()));
+
+    // look up every changed cell when the range is small, otherwise scan the cache
+    const qint64 cells = qint64(bottom - top + 1) * (right - left + 1) * changed.size();
+    if (cells <= static_cast<qint64>(d->cache.size()))
+    {
+        for (int r = top; r <= bottom; ++r)
+            for (int c = left; c <= right; ++c)
+                for (auto role : changed) {
+                    auto it = d->cache.find(d->indexate(r, c, role));
+                    if (it != d->cache.end()) {
+                        d->erase(it->second);
+                        d->cache.erase(it);
+                    }
+                }
+        return;
+    }
+
+    d->rekey([&](const CacheKey& key) {
+        return !(key.row >= top && key.row <= bottom && key.column >= left && key.column <= right &&
+                 std::find(changed.begin(), changed.end(), key.role) != changed.end());
+    });
+}
+
+void QtCachingProxyModel::onSourceRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    Q_D(QtCachingProxyModel);
+    if (parent.isValid())
+        return;
+
+    const int count = last - first + 1;
+    d->restartPrefetch();
+    d->rekey([first, count](CacheKey& key) {
+        if (key.row >= first)
+            key.row += count;
+        return true;
+    });
+}
+
+void QtCachingProxyModel::onSourceRowsRemoved(const QModelIndex &parent, int first, int last)
+{
+    Q_D(QtCachingProxyModel);
+    if (parent.isValid())
+        return;
+
+    const int count = last - first + 1;
+    d->restartPrefetch();
+    d->rekey([first, last, count](CacheKey& key) {
+        if (key.row < first)
+            return true;
+        if (key.row <= last)
+            return false;
+        key.row -= count;
+        return true;
+    });
+}
+
+void QtCachingProxyModel::onSourceLayoutAboutToBeChanged()
+{
+    Q_D(QtCachingProxyModel);
+    d->layoutRows.clear();
+    QAbstractItemModel* source = sourceModel();
+    if (d->cache.empty() || !source)
+        return;
+
+    // track every cached row through the layout change
+    std::vector<int> rows;
+    rows.reserve(d->cache.size());
+    for (auto it = d->cache.begin(); it != d->cache.end(); ++it)
+        rows.push_back(it->first.row);
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+    d->layoutRows.reserve(rows.size());
+    for (auto row : rows)
+        d->layoutRows.emplace_back(row, QPersistentModelIndex(source->index(row, 0)));
+}
+
+void QtCachingProxyModel::onSourceLayoutChanged()
+{
+    Q_D(QtCachingProxyModel);
+    if (d->layoutRows.empty()) {
+        d->restartPrefetch();
+        return;
+    }
+
+    std::unordered_map<int, int> moved; // old row -> new row or -1
+    for (auto it = d->layoutRows.begin(); it != d->layoutRows.end(); ++it) {
+        const QPersistentModelIndex& index = it->second;
+        moved.emplace(it->first, (index.isValid() && !index.parent().isValid() ? index.row() : -1));
+    }
+    d->layoutRows.clear();
+
+    d->restartPrefetch();
+    d->rekey([&moved](CacheKey& key) {
+        auto it = moved.find(key.row);
+        if (it == moved.end() || it->second < 0)
+            return false;
+        key.row = it->second;
+        return true;
+    });
+}
+
+void QtCachingProxyModel::onViewScrolled()
+{
+    Q_D(QtCachingProxyModel);
+    QAbstractItemView* view = d->view;
+    if (!view || view->model() != this)
+        return;
+
+    // top-level rows at the top and bottom edges of viewport
+    QModelIndex top = view->indexAt(QPoint(0, 0));
+    QModelIndex bottom = view->indexAt(QPoint(0, view->viewport()->height() - 1));
+    while (top.parent().isValid())
+        top = top.parent();
+    while (bottom.parent().isValid())
+        bottom = bottom.parent();
+
+    if (!top.isValid())
+        return;
+    setVisibleRange(top.row(), bottom.isValid() ? bottom.row() : rowCount() - 1);
+}
+
+void QtCachingProxyModel::onPrefetched(int generation, int first, int last, const QVariantList &values)
+{
+    Q_D(QtCachingProxyModel);
+    if (generation != d->generation.load() || d->ranges.empty())
+        return; // source or prefetch window changed meanwhile
+
+    d->busy = false;
+    int left = 0, right = 0;
+    d->columnRange(sourceModel(), left, right);
+    auto value = values.cbegin();
+    for (int r = first; r <= last; ++r)
+        for (int c = left; c <= right; ++c)
+            for (auto role : d->cachedRoles) {
+                if (value == values.cend())
+                    break;
+                d->cacheValue(d->indexate(r, c, role), *value++);
+            }
+    d->finishRange(first, last);
+}
@@ -4,6 +4,37 @@
 #include <QIdentityProxyModel>
 #include <QtWidgetsExtra>
 
+class QAbstractItemView;
+
+/*!
+ * \brief The QtCachingProxyModel class
+ *
+ * Identity proxy that keeps values of selected roles in
+ * segmented LRU cache keyed by (row, column, role).
+ * Newly cached values enter probation segment and are
+ * promoted to protected segment on the second hit, so
+ * single pass over the model (e.g. scrolling) cannot flush
+ * frequently used values. Cache size is limited by memory
+ * budget in bytes (estimated from the cached values) and,
+ * optionally, by number of entries.
+ *
+ * Cached values are invalidated precisely on source
+ * changes: changed cells are dropped, rows shifted by
+ * insertion/removal are re-keyed and rows permuted by
+ * layout changes are remapped.
+ *
+ * Cache may also be filled ahead of time: the proxy is told
+ * visible row range with setVisibleRange() or observes view
+ * attached with attachView(), and prefetches cached roles for
+ * visible rows plus prefetchLookahead() rows in scrolling
+ * direction. Prefetching runs in short idle-time slices on
+ * the GUI thread; sources that declare themselves thread-safe
+ * by dynamic property "threadSafe" set to true are read on
+ * a worker thread instead. Every prefetched range is announced
+ * with single dataChanged() signal.
+ *
+ * \note only top-level items are cached
+ */
 class QTWIDGETSEXTRA_EXPORT QtCachingProxyModel :
         public QIdentityProxyModel
 {
@@ -28,7 +59,22 @@ public:
     void setMaxCacheSize(int maxSize);
     int maxCacheSize() const;
 
+    void setCacheBudget(qint64 bytes);
+    qint64 cacheBudget() const;
+
     int cacheSize() const;
+    qint64 cacheCost() const;
+
+    quint64 cacheHits() const;
+    quint64 cacheMisses() const;
+    quint64 cacheEvictions() const;
+    void resetStatistics();
+
+    void setPrefetchLookahead(int rows);
+    int prefetchLookahead() const;
+
+    void attachView(QAbstractItemView* view);
+    QAbstractItemView* attachedView() const;
 
     void setCachedColumn(int column);
     int cachedColumn() const;
@@ -42,6 +88,7 @@ public:
     QVariant data(const QModelIndex &proxyIndex, int role) const Q_DECL_OVERRIDE;
 
 public Q_SLOTS:
+    void setVisibleRange(int first, int last);
     void clearCache();
     virtual void updateCache();
     virtual void cacheIndex(const QModelIndex& index);
@@ -49,6 +96,15 @@ public Q_SLOTS:
 protected:
     void timerEvent(QTimerEvent* event) Q_DECL_OVERRIDE;
 
+private Q_SLOTS:
+    void onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles);
+    void onSourceRowsInserted(const QModelIndex &parent, int first, int last);
+    void onSourceRowsRemoved(const QModelIndex &parent, int first, int last);
+    void onSourceLayoutAboutToBeChanged();
+    void onSourceLayoutChanged();
+    void onViewScrolled();
+    void onPrefetched(int generation, int first, int last, const QVariantList& values);
+
 private:
     QT_PIMPL(QtCachingProxyModel)
 };
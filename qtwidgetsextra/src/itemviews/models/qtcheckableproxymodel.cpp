@@ -2,20 +2,250 @@
 #include <algorithm>
 #include <functional>
 
+#include <QtAlgorithms>
 #include <QDebug>
 
 #include "qtcheckableproxymodel.h"
 
+namespace
+{
+
+// Word-packed bitset with cached number of set bits.
+// Bits beyond size() are always zero.
+class CheckBits
+{
+public:
+    CheckBits() : n(0), checked(0) {}
+
+    inline int size() const { return n; }
+    inline int count() const { return checked; }
+
+    inline bool test(int i) const
+    {
+        return ((words[i >> 6] >> (i & 63)) & 1) != 0;
+    }
+
+    // returns true if bit was changed
+    inline bool set(int i, bool on)
+    {
+        quint64& w = words[i >> 6];
+        const quint64 mask = quint64(1) << (i & 63);
+        if (((w & mask) != 0) == on)
+            return false;
+        w ^= mask;
+        checked += (on ? 1 : -1);
+        return true;
+    }
+
+    void reset(int size, bool on)
+    {
+        n = size;
+        words.assign(wordCount(size), on ? ~quint64(0) : quint64(0));
+        clearTail();
+        checked = (on ? size : 0);
+    }
+
+    void invert()
+    {
+        for (auto it = words.begin(); it != words.end(); ++it)
+            *it = ~*it;
+        clearTail();
+        checked = n - checked;
+    }
+
+    // set bits [first, last], indexes of changed bits are appended to changed
+    void fill(int first, int last, bool on, std::vector<int>* changed)
+    {
+        for (int i = first; i <= last; )
+        {
+            const int b = i & 63;
+            const int len = qMin(64 - b, last - i + 1);
+            const quint64 mask = lowMask(len) << b;
+            quint64& w = words[i >> 6];
+            quint64 diff = (on ? ~w : w) & mask;
+            const int k = static_cast<int>(qPopulationCount(diff));
+            checked += (on ? k : -k);
+            if (changed) {
+                for (; diff != 0; diff &= diff - 1)
+                    changed->push_back((i & ~63) + static_cast<int>(qCountTrailingZeroBits(diff)));
+            }
+            w = (on ? (w | mask) : (w & ~mask));
+            i += len;
+        }
+    }
+
+    void insert(int pos, int count, bool on)
+    {
+        const int tail = n - pos;
+        n += count;
+        words.resize(wordCount(n), 0);
+        move(pos, pos + count, tail);
+        for (int i = pos, last = pos + count; i < last; i += 64) {
+            const int len = qMin(64, last - i);
+            put(i, len, on ? ~quint64(0) : quint64(0));
+        }
+        checked += (on ? count : 0);
+    }
+
+    void remove(int pos, int count)
+    {
+        for (int i = pos, last = pos + count; i < last; i += 64)
+            checked -= static_cast<int>(qPopulationCount(get(i, qMin(64, last - i))));
+        move(pos + count, pos, n - pos - count);
+        n -= count;
+        words.resize(wordCount(n));
+        clearTail();
+    }
+
+private:
+    static inline int wordCount(int bits) { return (bits + 63) >> 6; }
+
+    static inline quint64 lowMask(int len)
+    {
+        return (len >= 64 ? ~quint64(0) : (quint64(1) << len) - 1);
+    }
+
+    inline void clearTail()
+    {
+        if ((n & 63) != 0)
+            words.back() &= lowMask(n & 63);
+    }
+
+    // read len (1..64) bits starting at off
+    inline quint64 get(int off, int len) const
+    {
+        const int w = off >> 6, b = off & 63;
+        quint64 v = words[w] >> b;
+        if (b != 0 && b + len > 64)
+            v |= words[w + 1] << (64 - b);
+        return (v & lowMask(len));
+    }
+
+    // write len (1..64) bits starting at off
+    inline void put(int off, int len, quint64 v)
+    {
+        const int w = off >> 6, b = off & 63;
+        const quint64 mask = lowMask(len);
+        v &= mask;
+        words[w] = (words[w] & ~(mask << b)) | (v << b);
+        if (b != 0 && b + len > 64) {
+            const int written = 64 - b;
+            words[w + 1] = (words[w + 1] & ~(mask >> written)) | (v >> written);
+        }
+    }
+
+    // copy len bits from src to dst, ranges may overlap
+    void move(int src, int dst, int len)
+    {
+        if (len <= 0 || src == dst)
+            return;
+        if (dst > src) {
+            for (int rest = len; rest > 0; ) {
+                const int chunk = qMin(64, rest);
+                rest -= chunk;
+                put(dst + rest, chunk, get(src + rest, chunk));
+            }
+        } else {
+            for (int done = 0; done < len; ) {
+                const int chunk = qMin(64, len - done);
+                put(dst + done, chunk, get(src + done, chunk));
+                done += chunk;
+            }
+        }
+    }
+
+    std::vector<quint64> words;
+    int n;
+    int checked;
+};
+
+// Changes of more ranges than this are announced
+// as single dataChanged() for the whole column
+static const int MaxChangedRanges = 64;
+
+}
+
 class QtCheckableProxyModelPrivate
 {
 public:
-    std::vector<bool> bits;
+    CheckBits bits;
     int column;
+    Qt::CheckState state; // last announced check state
+    bool checkedOnly;
     QtCheckableProxyModelPrivate();
+
+    inline Qt::CheckState currentState() const
+    {
+        if (bits.count() == 0)
+            return Qt::Unchecked;
+        return (bits.count() == bits.size() ? Qt::Checked : Qt::PartiallyChecked);
+    }
+
+    void updateState(QtCheckableProxyModel* q);
+    void notifyAll(QtCheckableProxyModel* q);
+    void notify(QtCheckableProxyModel* q, std::vector<int>& sourceRows);
 };
 
 QtCheckableProxyModelPrivate::QtCheckableProxyModelPrivate() :
-    column(0) {}
+    column(0), state(Qt::Unchecked), checkedOnly(false) {}
+
+void QtCheckableProxyModelPrivate::updateState(QtCheckableProxyModel *q)
+{
+    const Qt::CheckState s = currentState();
+    if (s != state) {
+        state = s;
+        Q_EMIT q->checkStateChanged(s);
+    }
+}
+
+void QtCheckableProxyModelPrivate::notifyAll(QtCheckableProxyModel *q)
+{
+    const int n = q->rowCount();
+    if (n > 0)
+        Q_EMIT q->dataChanged(q->index(0, column), q->index(n - 1, column), QVector<int>() << Qt::CheckStateRole);
+    updateState(q);
+}
+
+void QtCheckableProxyModelPrivate::notify(QtCheckableProxyModel *q, std::vector<int> &sourceRows)
+{
+    if (sourceRows.empty())
+        return;
+
+    const int n = q->rowCount();
+    if (static_cast<int>(sourceRows.size()) > n / 2) {
+        notifyAll(q);
+        return;
+    }
+
+    // map to proxy rows and coalesce into contiguous ranges
+    const QAbstractItemModel* source = q->sourceModel();
+    std::vector<int> rows;
+    rows.reserve(sourceRows.size());
+    for (auto it = sourceRows.cbegin(); it != sourceRows.cend(); ++it) {
+        const QModelIndex index = q->mapFromSource(source->index(*it, 0));
+        if (index.isValid())
+            rows.push_back(index.row());
+    }
+    std::sort(rows.begin(), rows.end());
+
+    std::vector<std::pair<int, int>> ranges;
+    for (auto it = rows.cbegin(); it != rows.cend(); ++it) {
+        if (!ranges.empty() && ranges.back().second + 1 == *it)
+            ranges.back().second = *it;
+        else
+            ranges.emplace_back(*it, *it);
+    }
+
+    if (static_cast<int>(ranges.size()) > MaxChangedRanges) {
+        notifyAll(q);
+        return;
+    }
+
+    const QVector<int> roles = QVector<int>() << Qt::CheckStateRole;
+    for (auto it = ranges.cbegin(); it != ranges.cend(); ++it)
+        Q_EMIT q->dataChanged(q->index(it->first, column), q->index(it->second, column), roles);
+    updateState(q);
+}
 
 
 QtCheckableProxyModel::QtCheckableProxyModel(QObject *parent) :
@@ -37,17 +267,20 @@ void QtCheckableProxyModel::setSourceModel(QAbstractItemModel *model)
     {
         disconnect(sourceModel(), &QAbstractItemModel::rowsInserted, this, &QtCheckableProxyModel::insert);
         disconnect(sourceModel(), &QAbstractItemModel::rowsRemoved, this, &QtCheckableProxyModel::remove);
+        disconnect(sourceModel(), &QAbstractItemModel::modelReset, this, &QtCheckableProxyModel::resetInternals);
     }
 
-    BaseModel::setSourceModel(model);
-
+    // connect before the base class: bitset must match
+    // source rows when the base class filters them
+    d->bits.reset(model != Q_NULLPTR ? model->rowCount() : 0, true);
     if (model != Q_NULLPTR)
     {
-        d->bits.resize(model->rowCount());
-        std::fill(d->bits.begin(), d->bits.end(), true);
         connect(model, &QAbstractItemModel::rowsInserted, this, &QtCheckableProxyModel::insert);
         connect(model, &QAbstractItemModel::rowsRemoved, this, &QtCheckableProxyModel::remove);
+        connect(model, &QAbstractItemModel::modelReset, this, &QtCheckableProxyModel::resetInternals);
     }
+
+    BaseModel::setSourceModel(model);
 }
 
 void QtCheckableProxyModel::setModelColumn(int column)
@@ -69,21 +302,67 @@ void QtCheckableProxyModel::setCheckState(Qt::CheckState state)
     if (checkState() == state)
         return;
 
-    std::fill(d->bits.begin(), d->bits.end(), (state == Qt::Checked));
-    QModelIndex first = index(0, d->column);
-    QModelIndex last = index(rowCount()-1, d->column);
-    Q_EMIT dataChanged(first, last, QVector<int>() << Qt::CheckStateRole);
+    d->bits.reset(d->bits.size(), (state == Qt::Checked));
+    d->notifyAll(this);
 }
 
 Qt::CheckState QtCheckableProxyModel::checkState() const
 {
     Q_D(const QtCheckableProxyModel);
+    return d->currentState();
+}
+
+void QtCheckableProxyModel::setCheckState(const QModelIndexList &indexes, Qt::CheckState state)
+{
+    Q_D(QtCheckableProxyModel);
+
+    const bool on = (state == Qt::Checked);
+    std::vector<int> changed;
+    for (auto it = indexes.cbegin(); it != indexes.cend(); ++it)
+    {
+        if (!it->isValid() || it->model() != this)
+            continue;
+        const QModelIndex source = mapToSource(*it);
+        if (source.parent().isValid() || source.row() >= d->bits.size())
+            continue;
+        if (d->bits.set(source.row(), on))
+            changed.push_back(source.row());
+    }
+    d->notify(this, changed);
+}
+
+void QtCheckableProxyModel::setRangeCheckState(int firstSourceRow, int lastSourceRow, Qt::CheckState state)
+{
+    Q_D(QtCheckableProxyModel);
+
+    firstSourceRow = qMax(firstSourceRow, 0);
+    lastSourceRow = qMin(lastSourceRow, d->bits.size() - 1);
+    if (firstSourceRow > lastSourceRow)
+        return;
+
+    std::vector<int> changed;
+    d->bits.fill(firstSourceRow, lastSourceRow, (state == Qt::Checked), &changed);
+    d->notify(this, changed);
+}
+
+bool QtCheckableProxyModel::isChecked(int sourceRow) const
+{
+    Q_D(const QtCheckableProxyModel);
+    if (sourceRow < 0 || sourceRow >= d->bits.size())
+        return false;
+    return d->bits.test(sourceRow);
+}
+
+int QtCheckableProxyModel::checkedCount() const
+{
+    Q_D(const QtCheckableProxyModel);
+    return d->bits.count();
+}
 
-    int n = std::count(d->bits.begin(), d->bits.end(), true);
-    if (n == 0)
-        return Qt::Unchecked;
-    else
-        return (size_t(n) == d->bits.size() ? Qt::Checked : Qt::PartiallyChecked);
+bool QtCheckableProxyModel::isFilterChecked() const
+{
+    Q_D(const QtCheckableProxyModel);
+    return d->checkedOnly;
 }
 
 bool QtCheckableProxyModel::setData(const QModelIndex &index, const QVariant &value, int role)
@@ -94,11 +373,12 @@ bool QtCheckableProxyModel::setData(const QModelIndex &index, const QVariant &va
     Q_D(QtCheckableProxyModel);
     if (role == Qt::CheckStateRole && d->column == index.column())
     {
-        int row = mapToSource(index).row();
+        const QModelIndex source = mapToSource(index);
+        const int row = source.row();
         bool state = (static_cast<Qt::CheckState>(value.toInt()) == Qt::Checked);
-        if (d->bits[row] != state) {
-            d->bits[row] = state;
+        if (!source.parent().isValid() && row < d->bits.size() && d->bits.set(row, state)) {
             Q_EMIT dataChanged(index, index, QVector<int>() << role);
+            d->updateState(this);
             return true;
         }
     }
@@ -114,12 +394,13 @@ QVariant QtCheckableProxyModel::data(const QModelIndex &index, int role) const
 
     if (role == Qt::CheckStateRole && d->column == index.column())
     {
-        int row = mapToSource(index).row();
-        if (row < 0)
+        const QModelIndex source = mapToSource(index);
+        const int row = source.row();
+        if (row < 0 || source.parent().isValid())
             return QVariant();
-        if (size_t(row) >= d->bits.size())
+        if (row >= d->bits.size())
             return QVariant();
-        return (int)(d->bits[row] ? Qt::Checked : Qt::Unchecked);
+        return (int)(d->bits.test(row) ? Qt::Checked : Qt::Unchecked);
     }
     return BaseModel::data(index, role);
 }
@@ -147,39 +428,65 @@ void QtCheckableProxyModel::invert()
 {
     Q_D(QtCheckableProxyModel);
 
-    std::transform(d->bits.begin(), d->bits.end(), d->bits.begin(), std::logical_not<bool>());
-    QModelIndex first = index(0, d->column);
-    QModelIndex last  = index(rowCount()-1, d->column);
-    Q_EMIT dataChanged(first, last, QVector<int>() << Qt::CheckStateRole);
+    d->bits.invert();
+    d->notifyAll(this);
 }
 
 void QtCheckableProxyModel::filterChecked()
 {
-    setFilterFixedString(QString(Qt::Checked));
+    Q_D(QtCheckableProxyModel);
+    d->checkedOnly = true;
+    invalidateFilter();
 }
 
 void QtCheckableProxyModel::clearFilter()
 {
-    setFilterFixedString(QString());
+    Q_D(QtCheckableProxyModel);
+    if (!d->checkedOnly)
+        return;
+
+    d->checkedOnly = false;
+    invalidateFilter();
 }
 
+bool QtCheckableProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    Q_D(const QtCheckableProxyModel);
+    if (d->checkedOnly && !sourceParent.isValid() &&
+        sourceRow < d->bits.size() && !d->bits.test(sourceRow))
+        return false;
+    return BaseModel::filterAcceptsRow(sourceRow, sourceParent);
+}
 
-void QtCheckableProxyModel::insert(const QModelIndex &, int row, int count)
+
+void QtCheckableProxyModel::insert(const QModelIndex &parent, int first, int last)
 {
     Q_D(QtCheckableProxyModel);
-    d->bits.insert(d->bits.begin() + row, count + 1, true);
+    if (parent.isValid())
+        return;
+
+    d->bits.insert(first, last - first + 1, true);
+    d->updateState(this);
 }
 
-void QtCheckableProxyModel::remove(const QModelIndex &, int row, int count)
+void QtCheckableProxyModel::remove(const QModelIndex &parent, int first, int last)
 {
     Q_D(QtCheckableProxyModel);
-    d->bits.erase(d->bits.begin() + row, d->bits.begin() + (row + count));
+    if (parent.isValid())
+        return;
+
+    d->bits.remove(first, last - first + 1);
+    d->updateState(this);
 }
 
 void QtCheckableProxyModel::resetInternals()
 {
     Q_D(QtCheckableProxyModel);
-    d->bits.resize(rowCount());
+    const QAbstractItemModel* model = sourceModel();
+    const int n = (model != Q_NULLPTR ? model->rowCount() : 0);
+    if (n != d->bits.size())
+        d->bits.reset(n, true);
+    d->updateState(this);
 }
 
 
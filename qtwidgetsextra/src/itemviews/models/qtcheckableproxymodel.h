@@ -4,6 +4,20 @@
 #include <QSortFilterProxyModel>
 #include <QtWidgetsExtra>
 
+/*!
+ * \brief The QtCheckableProxyModel class
+ *
+ * Proxy that adds check box to every row of modelColumn().
+ * Check states of source rows are kept in word-packed bitset
+ * with cached number of checked rows, so overall checkState()
+ * is O(1) and bulk operations touch 64 rows at once.
+ *
+ * filterChecked() hides unchecked rows directly from bitset;
+ * rows checked or unchecked while filter is active are not
+ * refiltered until the next filterChecked() call.
+ *
+ * \note only top-level rows are checkable
+ */
 class QTWIDGETSEXTRA_EXPORT QtCheckableProxyModel :
         public QSortFilterProxyModel
 {
@@ -24,6 +38,13 @@ public:
 
     Qt::CheckState checkState() const;
 
+    void setCheckState(const QModelIndexList& indexes, Qt::CheckState state);
+    void setRangeCheckState(int firstSourceRow, int lastSourceRow, Qt::CheckState state);
+
+    bool isChecked(int sourceRow) const;
+    int checkedCount() const;
+    bool isFilterChecked() const;
+
     // QAbstractItemModel interface
     virtual bool setData(const QModelIndex &index, const QVariant &value, int role) Q_DECL_OVERRIDE;
     virtual QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const Q_DECL_OVERRIDE;
@@ -33,6 +54,9 @@ public:
     virtual bool insertRows(int row, int count, const QModelIndex &parent);
     virtual bool removeRows(int row, int count, const QModelIndex &parent);
 
+protected:
+    virtual bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const Q_DECL_OVERRIDE;
+
 public Q_SLOTS:
     void setChecked();
     void setUnchecked();
@@ -41,8 +65,8 @@ public Q_SLOTS:
     void filterChecked();
     void clearFilter();
 
-    void insert(const QModelIndex&, int row, int count);
-    void remove(const QModelIndex&, int row, int count);
+    void insert(const QModelIndex& parent, int first, int last);
+    void remove(const QModelIndex& parent, int first, int last);
     void resetInternals();
 
 Q_SIGNALS:
@@ -1,7 +1,10 @@
 #include "qtcompositeproxymodel.h"
 #include "qtitemfilter.h"
 #include <QHash>
+#include <QCache>
 #include <QList>
+#include <QPair>
+#include <QVector>
 #include <QLinearGradient>
 #include <QBrush>
 #include <QFontMetricsF>
@@ -27,6 +30,24 @@ struct RoleTraverseOptions
     }
 };
 
+struct MappedKey
+{
+    QModelIndex index; // source index
+    int role;
+
+    MappedKey(const QModelIndex& i, int r) : index(i), role(r) {}
+
+    inline bool operator==(const MappedKey& other) const
+    {
+        return (role == other.role && index == other.index);
+    }
+};
+
+inline uint qHash(const MappedKey& key, uint seed = 0)
+{
+    return (qHash(key.index) ^ qHash(key.role, seed));
+}
+
 class QtCompositeProxyModelPrivate
 {
 public:
@@ -36,6 +57,14 @@ public:
     QString delimiter;
     QtCompositeProxyModel::BackgroundCombiation combinationMode;
 
+    typedef QPair<QModelIndex, int> RowKey; // source parent and row
+    typedef QHash<RowKey, QVector<MappedKey>> RowKeyHash;
+    mutable QCache<MappedKey, QVariant> cache; // memoized mapper results
+    mutable RowKeyHash rowKeys; // cached keys of each source row
+    mutable int rowKeyCount;
+    mutable quint64 hits;
+    mutable quint64 misses;
+
     QtCompositeProxyModelPrivate();
     inline QVariant formatText(QtProxyModelIndex& index, const MapperList& mappers, int mode) const;
     inline QVariant formatColor(QtProxyModelIndex& index, const MapperList& mappers, int mode) const;
@@ -44,13 +73,80 @@ public:
     inline QVariant textAlign(QtProxyModelIndex& index, const MapperList& mappers, int mode) const;
     inline QVariant font(QtProxyModelIndex& index, const MapperList& mappers, int mode) const;
     inline QVariant userData(QtProxyModelIndex& index, const MapperList& mappers, int mode) const;
+
+    void insert(const MappedKey& key, const QVariant& value) const;
+    void invalidate(const QModelIndex& parent, int first, int last);
+    void invalidate();
+
+private:
+    RowKeyHash::iterator invalidate(RowKeyHash::iterator it);
+    void rebuildRowKeys() const;
 };
 
 
 QtCompositeProxyModelPrivate::QtCompositeProxyModelPrivate() :
     delimiter("\n"),
-    combinationMode(QtCompositeProxyModel::Gradient)
+    combinationMode(QtCompositeProxyModel::Gradient),
+    cache(10000),
+    rowKeyCount(0),
+    hits(0),
+    misses(0)
+{
+}
+
+void QtCompositeProxyModelPrivate::insert(const MappedKey& key, const QVariant& value) const
+{
+    cache.insert(key, new QVariant(value));
+    rowKeys[RowKey(key.index.parent(), key.index.row())].append(key);
+    // QCache evicts items silently: drop keys of evicted
+    // items once row index becomes twice as large as cache
+    if (++rowKeyCount > 2 * qMax(cache.maxCost(), 1))
+        rebuildRowKeys();
+}
+
+void QtCompositeProxyModelPrivate::invalidate(const QModelIndex& parent, int first, int last)
+{
+    if (last - first + 1 > rowKeys.size()) {
+        // huge range: visit only rows that have cached items
+        for (auto it = rowKeys.begin(); it != rowKeys.end();) {
+            if (it.key().second >= first && it.key().second <= last && it.key().first == parent)
+                it = invalidate(it);
+            else
+                ++it;
+        }
+        return;
+    }
+
+    for (int row = first; row <= last; ++row) {
+        auto it = rowKeys.find(RowKey(parent, row));
+        if (it != rowKeys.end())
+            invalidate(it);
+    }
+}
+
+QtCompositeProxyModelPrivate::RowKeyHash::iterator QtCompositeProxyModelPrivate::invalidate(RowKeyHash::iterator it)
+{
+    // keys of evicted items are still here: removing them is no-op
+    for (auto k = it->cbegin(); k != it->cend(); ++k)
+        cache.remove(*k);
+    rowKeyCount -= it->size();
+    return rowKeys.erase(it);
+}
+
+void QtCompositeProxyModelPrivate::invalidate()
+{
+    cache.clear();
+    rowKeys.clear();
+    rowKeyCount = 0;
+}
+
+void QtCompositeProxyModelPrivate::rebuildRowKeys() const
 {
+    rowKeys.clear();
+    const QList<MappedKey> keys = cache.keys();
+    for (auto it = keys.cbegin(); it != keys.cend(); ++it)
+        rowKeys[RowKey(it->index.parent(), it->index.row())].append(*it);
+    rowKeyCount = keys.size();
 }
 
 
@@ -248,6 +344,7 @@ void QtCompositeProxyModel::setTraverseOptions(int role, QtCompositeProxyModel::
     {
         Q_EMIT layoutAboutToBeChanged();
         d->traversOptsMap.emplace_back(role, opts);
+        d->invalidate();
         Q_EMIT layoutChanged();
     }
     else
@@ -257,6 +354,7 @@ void QtCompositeProxyModel::setTraverseOptions(int role, QtCompositeProxyModel::
 
         Q_EMIT layoutAboutToBeChanged();
         it->options = opts;
+        d->invalidate();
         Q_EMIT layoutChanged();
     }
 }
@@ -298,6 +396,7 @@ void QtCompositeProxyModel::attachMapping(int sourceColumn, int sourceRole, QtIt
             it->push_back(mapper);
         }
     }
+    d->invalidate();
 
     Q_EMIT layoutChanged();
 }
@@ -317,6 +416,7 @@ int QtCompositeProxyModel::detachMapping(int sourceColumn, int sourceRole, QtIte
     }
 
     it->removeAt(index);
+    d->invalidate();
     if (it->isEmpty()) {
         Q_EMIT layoutAboutToBeChanged();
         d->mappings.erase(it);
@@ -337,6 +437,7 @@ int QtCompositeProxyModel::detachMappings(int sourceColumn, int sourceRole)
     Q_EMIT layoutAboutToBeChanged();
     int n = it->size();
     it->clear();
+    d->invalidate();
     Q_EMIT layoutChanged();
 
     return n;
@@ -355,6 +456,7 @@ int QtCompositeProxyModel::detachMapping(QtItemMapper *mapper)
             ++count;
         }
     }
+    d->invalidate();
     Q_EMIT layoutChanged();
     return count;
 }
@@ -375,10 +477,100 @@ void QtCompositeProxyModel::clearMappings()
     Q_EMIT layoutAboutToBeChanged();
 
     d->mappings.clear();
+    d->invalidate();
 
     Q_EMIT layoutChanged();
 }
 
+void QtCompositeProxyModel::setMaxCacheSize(int maxSize)
+{
+    Q_D(QtCompositeProxyModel);
+    d->cache.setMaxCost(qMax(maxSize, 0));
+}
+
+int QtCompositeProxyModel::maxCacheSize() const
+{
+    Q_D(const QtCompositeProxyModel);
+    return d->cache.maxCost();
+}
+
+int QtCompositeProxyModel::cacheSize() const
+{
+    Q_D(const QtCompositeProxyModel);
+    return d->cache.size();
+}
+
+quint64 QtCompositeProxyModel::cacheHits() const
+{
+    Q_D(const QtCompositeProxyModel);
+    return d->hits;
+}
+
+quint64 QtCompositeProxyModel::cacheMisses() const
+{
+    Q_D(const QtCompositeProxyModel);
+    return d->misses;
+}
+
+void QtCompositeProxyModel::resetStatistics()
+{
+    Q_D(QtCompositeProxyModel);
+    d->hits = d->misses = 0;
+}
+
+void QtCompositeProxyModel::clearCache()
+{
+    Q_D(QtCompositeProxyModel);
+    d->invalidate();
+}
+
+void QtCompositeProxyModel::setSourceModel(QAbstractItemModel *model)
+{
+    QAbstractItemModel* source = sourceModel();
+    if (source == model)
+        return;
+
+    if (source) {
+        disconnect(source, &QAbstractItemModel::dataChanged, this, &QtCompositeProxyModel::onSourceDataChanged);
+        disconnect(source, &QAbstractItemModel::rowsInserted, this, &QtCompositeProxyModel::clearCache);
+        disconnect(source, &QAbstractItemModel::rowsRemoved, this, &QtCompositeProxyModel::clearCache);
+        disconnect(source, &QAbstractItemModel::rowsMoved, this, &QtCompositeProxyModel::clearCache);
+        disconnect(source, &QAbstractItemModel::columnsInserted, this, &QtCompositeProxyModel::clearCache);
+        disconnect(source, &QAbstractItemModel::columnsRemoved, this, &QtCompositeProxyModel::clearCache);
+        disconnect(source, &QAbstractItemModel::columnsMoved, this, &QtCompositeProxyModel::clearCache);
+        disconnect(source, &QAbstractItemModel::layoutChanged, this, &QtCompositeProxyModel::clearCache);
+        disconnect(source, &QAbstractItemModel::modelReset, this, &QtCompositeProxyModel::clearCache);
+    }
+
+    // connect before the base class: cache must be invalidated
+    // before views are notified and ask for new values
+    if (model) {
+        connect(model, &QAbstractItemModel::dataChanged, this, &QtCompositeProxyModel::onSourceDataChanged);
+        connect(model, &QAbstractItemModel::rowsInserted, this, &QtCompositeProxyModel::clearCache);
+        connect(model, &QAbstractItemModel::rowsRemoved, this, &QtCompositeProxyModel::clearCache);
+        connect(model, &QAbstractItemModel::rowsMoved, this, &QtCompositeProxyModel::clearCache);
+        connect(model, &QAbstractItemModel::columnsInserted, this, &QtCompositeProxyModel::clearCache);
+        connect(model, &QAbstractItemModel::columnsRemoved, this, &QtCompositeProxyModel::clearCache);
+        connect(model, &QAbstractItemModel::columnsMoved, this, &QtCompositeProxyModel::clearCache);
+        connect(model, &QAbstractItemModel::layoutChanged, this, &QtCompositeProxyModel::clearCache);
+        connect(model, &QAbstractItemModel::modelReset, this, &QtCompositeProxyModel::clearCache);
+    }
+
+    clearCache();
+    QIdentityProxyModel::setSourceModel(model);
+}
+
+void QtCompositeProxyModel::onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    Q_D(QtCompositeProxyModel);
+    if (d->cache.isEmpty())
+        return;
+
+    // mappers may read any role or sibling of mapped item:
+    // drop all cached values of changed rows
+    d->invalidate(topLeft.parent(), topLeft.row(), bottomRight.row());
+}
+
 QVariant QtCompositeProxyModel::data(const QModelIndex &proxyIndex, int role) const
 {
     Q_D(const QtCompositeProxyModel);
@@ -394,25 +586,41 @@ QVariant QtCompositeProxyModel::data(const QModelIndex &proxyIndex, int role) co
         return QIdentityProxyModel::data(proxyIndex, role);
     }
 
+    const MappedKey cacheKey(index.index(), role);
+    if (const QVariant* cached = d->cache.object(cacheKey)) {
+        ++d->hits;
+        return *cached;
+    }
+    ++d->misses;
+
+    QVariant result;
     switch (role) {
     case Qt::DisplayRole:
     case Qt::ToolTipRole:
     case Qt::StatusTipRole:
     case Qt::WhatsThisRole:
-        return d->formatText(index, *it, traverseOptions(Qt::DisplayRole));
+        result = d->formatText(index, *it, traverseOptions(Qt::DisplayRole));
+        break;
     case Qt::BackgroundRole:
-        return d->formatColor(index, *it, traverseOptions(Qt::BackgroundRole));
+        result = d->formatColor(index, *it, traverseOptions(Qt::BackgroundRole));
+        break;
     case Qt::ForegroundRole:
-        return d->foreground(index, *it, traverseOptions(Qt::ForegroundRole));
+        result = d->foreground(index, *it, traverseOptions(Qt::ForegroundRole));
+        break;
     case Qt::DecorationRole:
-        return d->decoration(index, *it, traverseOptions(Qt::DecorationRole));
+        result = d->decoration(index, *it, traverseOptions(Qt::DecorationRole));
+        break;
     case Qt::TextAlignmentRole:
-        return d->textAlign(index, *it, traverseOptions(Qt::TextAlignmentRole));
+        result = d->textAlign(index, *it, traverseOptions(Qt::TextAlignmentRole));
+        break;
     case Qt::FontRole:
-        return d->font(index, *it, traverseOptions(Qt::FontRole));
+        result = d->font(index, *it, traverseOptions(Qt::FontRole));
+        break;
     default:
-        return d->userData(index, *it, traverseOptions(Qt::UserRole));
+        result = d->userData(index, *it, traverseOptions(Qt::UserRole));
+        break;
     }
-    return QVariant();
+    d->insert(cacheKey, result);
+    return result;
 }
 
@@ -6,6 +6,19 @@
 
 class QtItemMapper;
 
+/*!
+ * \brief The QtCompositeProxyModel class
+ *
+ * Identity proxy that passes values of attached columns and
+ * roles through chains of QtItemMapper instances.
+ *
+ * Mapped values are memoized per (index, role) in bounded
+ * LRU cache. The cache is invalidated for changed source
+ * rows and on every structural change of the source model
+ * or of the attached mappings. Mappers do not notify about
+ * their own changes: call clearCache() after reconfiguring
+ * an attached mapper.
+ */
 class QTWIDGETSEXTRA_EXPORT QtCompositeProxyModel :
         public QIdentityProxyModel
 {
@@ -41,10 +54,26 @@ public:
     int countMappings(int sourceColumn, int sourceRole) const;
     void clearMappings();
 
+    void setMaxCacheSize(int maxSize);
+    int maxCacheSize() const;
+    int cacheSize() const;
+
+    quint64 cacheHits() const;
+    quint64 cacheMisses() const;
+    void resetStatistics();
+
+    void setSourceModel(QAbstractItemModel* model) Q_DECL_OVERRIDE;
+
     // QAbstractItemModel interface
 public:
     virtual QVariant data(const QModelIndex &proxyIndex, int role) const Q_DECL_OVERRIDE;
 
+public Q_SLOTS:
+    void clearCache();
+
+private Q_SLOTS:
+    void onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+
 private:
     QScopedPointer<class QtCompositeProxyModelPrivate> d_ptr;
     Q_DECLARE_PRIVATE(QtCompositeProxyModel)
@@ -7,6 +7,8 @@
 
 #include <QRegularExpression>
 #include <QRegExp>
+#include <QStringMatcher>
+#include <QDateTime>
 
 #include <QBrush>
 
@@ -38,56 +40,56 @@ static inline QRegularExpression::PatternOptions regexOpts(QtItemFilter::RegexOp
     return result;
 }
 
-static inline bool stringMatch(const QString& pattern, const QString& what, Qt::MatchFlags flags, QtItemFilter::RegexOptions options)
-{
-    Qt::CaseSensitivity cs = flags & Qt::MatchCaseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive;
-    switch (flags) {
-    case Qt::MatchRegExp:
-        return (QRegularExpression(pattern, regexOpts(options, cs)).match(what).hasMatch());
-    case Qt::MatchWildcard:
-        return (QRegExp(pattern, cs, QRegExp::Wildcard).exactMatch(what));
-    case Qt::MatchStartsWith:
-        return (what.startsWith(pattern, cs));
-    case Qt::MatchEndsWith:
-        return (what.endsWith(pattern, cs));
-    case Qt::MatchFixedString:
-        return (what.compare(pattern, cs) == 0);
-    case Qt::MatchContains:
-    default:
-        break;
-    }
-    return (what.contains(pattern, cs));
-}
-
-static inline bool match(const QVariant &pattern, const QVariant& what,  Qt::MatchFlags flags, QtItemFilter::RegexOptions options)
+// Numeric and string values are compared natively,
+// everything else is compared by its string representation
+enum CompareKind
 {
-    // QVariant based matching
-    if (flags == Qt::MatchExactly) {
-        return (what == pattern);
-    } else { // QString based matching - only convert to a string if it is needed
-        return stringMatch(pattern.toString(), what.toString(), flags, options);
-    }
-}
-
+    CompareSigned,
+    CompareUnsigned,
+    CompareReal,
+    CompareDate,
+    CompareTime,
+    CompareDateTime,
+    CompareString
+};
 
-static inline int compareStrings(const QString& pattern, const QString& what, Qt::MatchFlags flags)
+static inline CompareKind compareKind(int type)
 {
-    Qt::CaseSensitivity cs = flags & Qt::MatchCaseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive;
-    return QString::compare(pattern, what, cs);
+    switch (type)
+    {
+    case QMetaType::Bool:
+    case QMetaType::Char:
+    case QMetaType::SChar:
+    case QMetaType::Short:
+    case QMetaType::Int:
+    case QMetaType::Long:
+    case QMetaType::LongLong:
+        return CompareSigned;
+    case QMetaType::UChar:
+    case QMetaType::UShort:
+    case QMetaType::UInt:
+    case QMetaType::ULong:
+    case QMetaType::ULongLong:
+        return CompareUnsigned;
+    case QMetaType::Float:
+    case QMetaType::Double:
+        return CompareReal;
+    case QMetaType::QDate:
+        return CompareDate;
+    case QMetaType::QTime:
+        return CompareTime;
+    case QMetaType::QDateTime:
+        return CompareDateTime;
+    default:
+        break;
+    }
+    return CompareString;
 }
 
-static inline int compareVariants(const QVariant& pattern, const QVariant& what, Qt::MatchFlags flags)
+template<class T>
+static inline int compareValues(const T& x, const T& y)
 {
-    if (pattern.type() == QVariant::String)
-        return compareStrings(pattern.toString(), what.toString(), flags);
-
-    if (pattern == what || pattern >= what || pattern <= what)
-        return 0;
-    if (pattern > what)
-        return 1;
-    if (pattern < what)
-        return -1;
-    return 1;
+    return (x < y ? -1 : (y < x ? 1 : 0));
 }
 
 }
@@ -178,12 +180,125 @@ public:
     QtItemFilter::RegexOptions options;
     quint8 condition;
 
+    // compiled pattern, rebuilt whenever pattern or matching options change
+    int matchType;
+    Qt::CaseSensitivity cs;
+    QString text;
+    QStringMatcher matcher;
+    QRegularExpression regex;
+#if QT_VERSION < QT_VERSION_CHECK(5, 12, 0)
+    QRegExp wildcard;
+#endif
+    CompareKind kind;
+    qint64 signedValue;
+    quint64 unsignedValue;
+    double realValue;
+    QDate dateValue;
+    QTime timeValue;
+    QDateTime dateTimeValue;
+
     QtItemFilterPrivate() :
         patternRole(Qt::EditRole),
         flags(Qt::MatchExactly),
         options(QtItemFilter::NoOptions),
-        condition(QtItemFilter::None)
+        condition(QtItemFilter::None),
+        matchType(Qt::MatchExactly),
+        cs(Qt::CaseInsensitive),
+        kind(CompareString),
+        signedValue(0),
+        unsignedValue(0),
+        realValue(0.0)
+    {
+    }
+
+    void compile()
+    {
+        matchType = static_cast<int>(flags & 0x0F);
+        cs = (flags & Qt::MatchCaseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive);
+        text = pattern.toString();
+
+        matcher = QStringMatcher(text, cs);
+        regex = QRegularExpression();
+        switch (matchType)
+        {
+        case Qt::MatchRegExp:
+            regex = QRegularExpression(text, regexOpts(options, cs));
+            regex.optimize(); // JIT-compile now instead of on the first match
+            break;
+        case Qt::MatchWildcard:
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+            regex = QRegularExpression(QRegularExpression::wildcardToRegularExpression(text),
+                                       regexOpts(QtItemFilter::NoOptions, cs));
+            regex.optimize();
+#else
+            wildcard = QRegExp(text, cs, QRegExp::Wildcard);
+#endif
+            break;
+        default:
+            break;
+        }
+
+        kind = compareKind(pattern.userType());
+        switch (kind)
+        {
+        case CompareSigned:   signedValue = pattern.toLongLong(); break;
+        case CompareUnsigned: unsignedValue = pattern.toULongLong(); break;
+        case CompareReal:     realValue = pattern.toDouble(); break;
+        case CompareDate:     dateValue = pattern.toDate(); break;
+        case CompareTime:     timeValue = pattern.toTime(); break;
+        case CompareDateTime: dateTimeValue = pattern.toDateTime(); break;
+        default: break;
+        }
+    }
+
+    bool stringMatch(const QString& what) const
+    {
+        switch (matchType)
+        {
+        case Qt::MatchRegExp:
+            return regex.match(what).hasMatch();
+        case Qt::MatchWildcard:
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+            return regex.match(what).hasMatch();
+#else
+            return QRegExp(wildcard).exactMatch(what);
+#endif
+        case Qt::MatchStartsWith:
+            return what.startsWith(text, cs);
+        case Qt::MatchEndsWith:
+            return what.endsWith(text, cs);
+        case Qt::MatchFixedString:
+            return (what.compare(text, cs) == 0);
+        case Qt::MatchContains:
+        default:
+            break;
+        }
+        return (matcher.indexIn(what) != -1);
+    }
+
+    bool match(const QVariant& what) const
     {
+        // QVariant based matching
+        if (matchType == Qt::MatchExactly)
+            return (what == pattern);
+        // QString based matching - only convert to a string if it is needed
+        return stringMatch(what.toString());
+    }
+
+    // Compare pattern with value: < 0 if pattern is less than value, > 0 if greater
+    int compare(const QVariant& what) const
+    {
+        switch (kind)
+        {
+        case CompareSigned:   return compareValues(signedValue, what.toLongLong());
+        case CompareUnsigned: return compareValues(unsignedValue, what.toULongLong());
+        case CompareReal:     return compareValues(realValue, what.toDouble());
+        case CompareDate:     return compareValues(dateValue, what.toDate());
+        case CompareTime:     return compareValues(timeValue, what.toTime());
+        case CompareDateTime: return compareValues(dateTimeValue, what.toDateTime());
+        default: break;
+        }
+        return QString::compare(text, what.toString(), cs);
     }
 };
 
@@ -202,6 +317,7 @@ void QtItemFilter::setPattern(const QVariant &pattern)
 {
     Q_D(QtItemFilter);
     d->pattern = pattern;
+    d->compile();
 }
 
 QVariant QtItemFilter::pattern() const
@@ -214,6 +330,7 @@ void QtItemFilter::setPatternString(const QString &pattern)
 {
     Q_D(QtItemFilter);
     d->pattern = pattern;
+    d->compile();
 }
 
 QString QtItemFilter::patternString() const
@@ -230,6 +347,7 @@ void QtItemFilter::setPatternType(Type t)
             d->pattern.convert(t);
         else
             qWarning() << "failed to convert pattern from [" << d->pattern.type() << "] to type [" << t << ']';
+        d->compile();
     }
 }
 
@@ -267,6 +385,7 @@ void QtItemFilter::setMatchFlags(Qt::MatchFlags f)
 {
     Q_D(QtItemFilter);
     d->flags = f;
+    d->compile();
 }
 
 Qt::MatchFlags QtItemFilter::matchFlags() const
@@ -279,6 +398,7 @@ void QtItemFilter::setRegexOptions(QtItemFilter::RegexOptions opt)
 {
     Q_D(QtItemFilter);
     d->options = opt;
+    d->compile();
 }
 
 QtItemFilter::RegexOptions QtItemFilter::regexOptions() const
@@ -295,18 +415,26 @@ bool QtItemFilter::accepted(const QModelIndex &index) const
     return accepts(index.data(patternRole()));
 }
 
+bool QtItemFilter::acceptsValue(const QVariant &value) const
+{
+    Q_D(const QtItemFilter);
+    if (!isEnabled() || (d->condition == None || !d->pattern.isValid()))
+        return true;
+    return accepts(value);
+}
+
 bool QtItemFilter::accepts(const QVariant &v) const
 {
     Q_D(const QtItemFilter);
     switch(d->condition) {
     case None:         return true;
-    case Match:        return match(d->pattern, v, d->flags, d->options);
-    case Equal:        return match(d->pattern, v, Qt::MatchExactly, NoOptions);
-    case NotEqual:     return (!match(d->pattern, v, Qt::MatchExactly, NoOptions));
-    case Less:         return (compareVariants(d->pattern, v, d->flags) > 0);
-    case LessEqual:    return (compareVariants(d->pattern, v, d->flags) >= 0);
-    case Greater:      return (compareVariants(d->pattern, v, d->flags) < 0);
-    case GreaterEqual: return (compareVariants(d->pattern, v, d->flags) <= 0);
+    case Match:        return d->match(v);
+    case Equal:        return (v == d->pattern);
+    case NotEqual:     return (v != d->pattern);
+    case Less:         return (d->compare(v) > 0);
+    case LessEqual:    return (d->compare(v) >= 0);
+    case Greater:      return (d->compare(v) < 0);
+    case GreaterEqual: return (d->compare(v) <= 0);
     default: break;
     }
     return false;
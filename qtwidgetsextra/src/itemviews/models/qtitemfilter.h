@@ -6,6 +6,8 @@
 #include <QVariant>
 #include <QVector>
 #include <QHash>
+#include <QPair>
+#include <QVarLengthArray>
 #include <QIcon>
 #include <QFont>
 #include <QColor>
@@ -41,12 +43,21 @@ public:
     }
 
     inline QVariant data(int role) const {
-        auto it = mCache.find(role);
-        return (it == mCache.end() ? mIndex.data(role) : *it);
+        for (auto it = mCache.cbegin(); it != mCache.cend(); ++it) {
+            if (it->first == role)
+                return it->second;
+        }
+        return mIndex.data(role);
     }
 
     inline void setData(int role, const QVariant& value) {
-        mCache[role] = value;
+        for (auto it = mCache.begin(); it != mCache.end(); ++it) {
+            if (it->first == role) {
+                it->second = value;
+                return;
+            }
+        }
+        mCache.append(qMakePair(role, value));
     }
 
     inline bool isValid() const {
@@ -58,7 +69,8 @@ public:
     }
 
 private:
-    QHash<int, QVariant> mCache;
+    // only a few roles are ever overridden: keep them inline
+    QVarLengthArray<QPair<int, QVariant>, 2> mCache;
     QModelIndex mIndex;
     int mRole;
 };
@@ -260,6 +272,8 @@ public:
     }
 
     bool accepted(const QModelIndex& index) const Q_DECL_OVERRIDE;
+    // same as accepted() for value already read from patternRole()
+    bool acceptsValue(const QVariant& value) const;
 
 protected:
     bool accepts(const QVariant& v) const Q_DECL_OVERRIDE;
@@ -0,0 +1,525 @@
+#include "qtitemfilterproxymodel.h"
+#include "qtitemfilter.h"
+
+#include <QPointer>
+#include <QDateTime>
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+namespace
+{
+
+class FilterTask : public QRunnable
+{
+public:
+    explicit FilterTask(const std::function<void()>& f) : func(f) {}
+    void run() Q_DECL_OVERRIDE { func(); }
+private:
+    std::function<void()> func;
+};
+
+static inline bool isActive(const QtItemFilter* filter)
+{
+    return (filter->isEnabled() &&
+            filter->condition() != QtItemFilter::None &&
+            filter->pattern().isValid());
+}
+
+static inline bool isNumeric(int type)
+{
+    switch (type)
+    {
+    case QMetaType::Char:
+    case QMetaType::SChar:
+    case QMetaType::UChar:
+    case QMetaType::Short:
+    case QMetaType::UShort:
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::Long:
+    case QMetaType::ULong:
+    case QMetaType::LongLong:
+    case QMetaType::ULongLong:
+    case QMetaType::Float:
+    case QMetaType::Double:
+        return true;
+    default:
+        break;
+    }
+    return false;
+}
+
+template<class T>
+static inline int compareValues(const T& x, const T& y)
+{
+    return (x < y ? -1 : (y < x ? 1 : 0));
+}
+
+// Compare two range bounds, ok is set to false for incomparable values
+static int compareBounds(const QVariant& x, const QVariant& y, Qt::CaseSensitivity cs, bool* ok)
+{
+    *ok = true;
+    const int type = x.userType();
+    if (isNumeric(type) && isNumeric(y.userType()))
+        return compareValues(x.toDouble(), y.toDouble());
+
+    if (type == y.userType())
+    {
+        switch (type)
+        {
+        case QMetaType::QString:   return QString::compare(x.toString(), y.toString(), cs);
+        case QMetaType::QDate:     return compareValues(x.toDate(), y.toDate());
+        case QMetaType::QTime:     return compareValues(x.toTime(), y.toTime());
+        case QMetaType::QDateTime: return compareValues(x.toDateTime(), y.toDateTime());
+        default: break;
+        }
+    }
+    *ok = false;
+    return 0;
+}
+
+enum FilterChange
+{
+    Unchanged = 0,
+    Narrowed,
+    Changed
+};
+
+struct FilterState
+{
+    QtItemFilter* filter;
+    int column;
+    // filter properties at the last evaluation
+    QVariant pattern;
+    Qt::MatchFlags flags;
+    int role;
+    int condition;
+    int options;
+    bool active;
+    bool evaluated;
+
+    FilterState(QtItemFilter* f, int c) :
+        filter(f), column(c), role(0), condition(0), options(0),
+        active(false), evaluated(false)
+    {
+    }
+
+    void save()
+    {
+        pattern = filter->pattern();
+        flags = filter->matchFlags();
+        role = filter->patternRole();
+        condition = filter->condition();
+        options = filter->regexOptions();
+        active = isActive(filter);
+        evaluated = true;
+    }
+
+    FilterChange change() const
+    {
+        const bool nowActive = isActive(filter);
+        if (!evaluated || !active) // filter did not restrict anything
+            return (nowActive ? Narrowed : Unchanged);
+        if (!nowActive)
+            return Changed;
+
+        if (filter->patternRole() != role ||
+            filter->condition() != condition ||
+            filter->matchFlags() != flags ||
+            filter->regexOptions() != options)
+            return Changed;
+
+        const QVariant current = filter->pattern();
+        if (current.userType() == pattern.userType() && current == pattern)
+            return Unchanged;
+
+        const Qt::CaseSensitivity cs = (flags & Qt::MatchCaseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive);
+        bool ok = false;
+        switch (condition)
+        {
+        case QtItemFilter::Match:
+        {
+            const QString text = current.toString();
+            const QString prev = pattern.toString();
+            switch (static_cast<int>(flags & 0x0F))
+            {
+            case Qt::MatchContains:
+                return (text.contains(prev, cs) ? Narrowed : Changed);
+            case Qt::MatchStartsWith:
+                return (text.startsWith(prev, cs) ? Narrowed : Changed);
+            case Qt::MatchEndsWith:
+                return (text.endsWith(prev, cs) ? Narrowed : Changed);
+            default:
+                break;
+            }
+            return Changed;
+        }
+        case QtItemFilter::Less:
+        case QtItemFilter::LessEqual:
+            // upper bound moved down
+            return (compareBounds(current, pattern, cs, &ok) <= 0 && ok ? Narrowed : Changed);
+        case QtItemFilter::Greater:
+        case QtItemFilter::GreaterEqual:
+            // lower bound moved up
+            return (compareBounds(current, pattern, cs, &ok) >= 0 && ok ? Narrowed : Changed);
+        default:
+            break;
+        }
+        return Changed;
+    }
+};
+
+}
+
+class QtItemFilterProxyModelPrivate
+{
+public:
+    QPointer<QAbstractItemModel> model;
+    std::vector<FilterState> filters;
+    std::vector<bool> accepted; // top-level source row -> accepted
+    int parallelThreshold;
+    bool widened;               // filter was removed since the last pass
+
+    QtItemFilterProxyModelPrivate() :
+        parallelThreshold(50000),
+        widened(false)
+    {
+    }
+
+    void evaluate(const std::vector<int>& rows, std::vector<char>& result) const;
+    void evaluate(int first, int last);
+    void evaluateAll();
+    void saveFilters();
+};
+
+void QtItemFilterProxyModelPrivate::evaluate(const std::vector<int>& rows, std::vector<char>& result) const
+{
+    const int n = static_cast<int>(rows.size());
+    result.assign(n, 1);
+    if (!model || n == 0)
+        return;
+
+    // distinct (column, role) pairs read by active filters
+    std::vector<QPair<int, int>> keys;
+    std::vector<const QtItemFilter*> active;
+    std::vector<size_t> filterSlots;
+    for (auto it = filters.cbegin(); it != filters.cend(); ++it)
+    {
+        if (!isActive(it->filter))
+            continue;
+        const QPair<int, int> key(it->column, it->filter->patternRole());
+        auto s = std::find(keys.begin(), keys.end(), key);
+        if (s == keys.end())
+            s = keys.insert(keys.end(), key);
+        active.push_back(it->filter);
+        filterSlots.push_back(static_cast<size_t>(s - keys.begin()));
+    }
+    if (active.empty())
+        return;
+
+    // snapshot filtered values: the source model is accessible from its own thread only
+    const size_t m = keys.size();
+    std::vector<QVariant> values(static_cast<size_t>(n) * m);
+    for (int i = 0; i < n; ++i)
+        for (size_t s = 0; s < m; ++s)
+            values[static_cast<size_t>(i) * m + s] = model->index(rows[i], keys[s].first).data(keys[s].second);
+
+    auto run = [&values, &active, &filterSlots, &result, m](int first, int last) {
+        for (int i = first; i < last; ++i) {
+            const QVariant* row = values.data() + static_cast<size_t>(i) * m;
+            for (size_t f = 0; f < active.size(); ++f) {
+                if (!active[f]->acceptsValue(row[filterSlots[f]])) {
+                    result[i] = 0;
+                    break;
+                }
+            }
+        }
+    };
+
+    const int threads = QThread::idealThreadCount();
+    if (parallelThreshold <= 0 || n < parallelThreshold || threads < 2) {
+        run(0, n);
+        return;
+    }
+
+    // a few chunks per thread to even out uneven filter costs
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+    const int chunks = threads * 4;
+    const int chunk = (n + chunks - 1) / chunks;
+    for (int first = 0; first < n; first += chunk) {
+        const int last = qMin(n, first + chunk);
+        pool.start(new FilterTask([&run, first, last]() { run(first, last); }));
+    }
+    pool.waitForDone();
+}
+
+void QtItemFilterProxyModelPrivate::evaluate(int first, int last)
+{
+    if (last < first)
+        return;
+
+    std::vector<int> rows(last - first + 1);
+    for (int i = first; i <= last; ++i)
+        rows[i - first] = i;
+
+    std::vector<char> result;
+    evaluate(rows, result);
+    for (int i = first; i <= last; ++i)
+        accepted[i] = (result[i - first] != 0);
+}
+
+void QtItemFilterProxyModelPrivate::evaluateAll()
+{
+    const int n = (model ? model->rowCount() : 0);
+    accepted.assign(n, true);
+    if (n > 0)
+        evaluate(0, n - 1);
+    saveFilters();
+}
+
+void QtItemFilterProxyModelPrivate::saveFilters()
+{
+    for (auto it = filters.begin(); it != filters.end(); ++it)
+        it->save();
+    widened = false;
+}
+
+
+
+QtItemFilterProxyModel::QtItemFilterProxyModel(QObject *parent) :
+    QSortFilterProxyModel(parent),
+    d_ptr(new QtItemFilterProxyModelPrivate)
+{
+}
+
+QtItemFilterProxyModel::~QtItemFilterProxyModel()
+{
+}
+
+void QtItemFilterProxyModel::addFilter(int sourceColumn, QtItemFilter *filter)
+{
+    Q_D(QtItemFilterProxyModel);
+    if (!filter)
+        return;
+
+    for (auto it = d->filters.cbegin(); it != d->filters.cend(); ++it)
+        if (it->filter == filter && it->column == sourceColumn)
+            return;
+
+    // new filter can only narrow the result
+    d->filters.emplace_back(filter, sourceColumn);
+    refilter();
+}
+
+int QtItemFilterProxyModel::removeFilter(QtItemFilter *filter)
+{
+    Q_D(QtItemFilterProxyModel);
+    const size_t size = d->filters.size();
+    d->filters.erase(std::remove_if(d->filters.begin(), d->filters.end(),
+                                    [filter](const FilterState& s) { return s.filter == filter; }),
+                     d->filters.end());
+
+    const int count = static_cast<int>(size - d->filters.size());
+    if (count > 0) {
+        d->widened = true;
+        refilter();
+    }
+    return count;
+}
+
+void QtItemFilterProxyModel::clearFilters()
+{
+    Q_D(QtItemFilterProxyModel);
+    if (d->filters.empty())
+        return;
+
+    d->filters.clear();
+    d->accepted.assign(d->accepted.size(), true);
+    d->widened = false;
+    invalidateFilter();
+}
+
+QList<QtItemFilter *> QtItemFilterProxyModel::filters(int sourceColumn) const
+{
+    Q_D(const QtItemFilterProxyModel);
+    QList<QtItemFilter*> result;
+    for (auto it = d->filters.cbegin(); it != d->filters.cend(); ++it)
+        if (it->column == sourceColumn)
+            result << it->filter;
+    return result;
+}
+
+void QtItemFilterProxyModel::setParallelThreshold(int rows)
+{
+    Q_D(QtItemFilterProxyModel);
+    d->parallelThreshold = rows;
+}
+
+int QtItemFilterProxyModel::parallelThreshold() const
+{
+    Q_D(const QtItemFilterProxyModel);
+    return d->parallelThreshold;
+}
+
+int QtItemFilterProxyModel::acceptedCount() const
+{
+    Q_D(const QtItemFilterProxyModel);
+    return static_cast<int>(std::count(d->accepted.cbegin(), d->accepted.cend(), true));
+}
+
+void QtItemFilterProxyModel::setSourceModel(QAbstractItemModel *model)
+{
+    Q_D(QtItemFilterProxyModel);
+
+    QAbstractItemModel* source = sourceModel();
+    if (source == model)
+        return;
+
+    if (source) {
+        disconnect(source, &QAbstractItemModel::dataChanged, this, &QtItemFilterProxyModel::onSourceDataChanged);
+        disconnect(source, &QAbstractItemModel::rowsInserted, this, &QtItemFilterProxyModel::onSourceRowsInserted);
+        disconnect(source, &QAbstractItemModel::rowsRemoved, this, &QtItemFilterProxyModel::onSourceRowsRemoved);
+        disconnect(source, &QAbstractItemModel::rowsMoved, this, &QtItemFilterProxyModel::onSourceRowsMoved);
+        disconnect(source, &QAbstractItemModel::layoutChanged, this, &QtItemFilterProxyModel::onSourceLayoutChanged);
+        disconnect(source, &QAbstractItemModel::modelReset, this, &QtItemFilterProxyModel::onSourceReset);
+    }
+
+    // connect before the base class: bitmap must be updated
+    // before the base class asks filterAcceptsRow()
+    if (model) {
+        connect(model, &QAbstractItemModel::dataChanged, this, &QtItemFilterProxyModel::onSourceDataChanged);
+        connect(model, &QAbstractItemModel::rowsInserted, this, &QtItemFilterProxyModel::onSourceRowsInserted);
+        connect(model, &QAbstractItemModel::rowsRemoved, this, &QtItemFilterProxyModel::onSourceRowsRemoved);
+        connect(model, &QAbstractItemModel::rowsMoved, this, &QtItemFilterProxyModel::onSourceRowsMoved);
+        connect(model, &QAbstractItemModel::layoutChanged, this, &QtItemFilterProxyModel::onSourceLayoutChanged);
+        connect(model, &QAbstractItemModel::modelReset, this, &QtItemFilterProxyModel::onSourceReset);
+    }
+
+    d->model = model;
+    d->evaluateAll();
+    QSortFilterProxyModel::setSourceModel(model);
+}
+
+void QtItemFilterProxyModel::refilter()
+{
+    Q_D(QtItemFilterProxyModel);
+
+    FilterChange change = (d->widened ? Changed : Unchanged);
+    for (auto it = d->filters.cbegin(); it != d->filters.cend() && change != Changed; ++it)
+        change = qMax(change, it->change());
+
+    if (change == Unchanged)
+        return;
+
+    if (change == Changed) {
+        d->evaluateAll();
+    } else {
+        // narrowed: rows rejected before stay rejected
+        std::vector<int> rows;
+        for (size_t i = 0; i < d->accepted.size(); ++i)
+            if (d->accepted[i])
+                rows.push_back(static_cast<int>(i));
+
+        std::vector<char> result;
+        d->evaluate(rows, result);
+        for (size_t i = 0; i < rows.size(); ++i)
+            if (!result[i])
+                d->accepted[rows[i]] = false;
+        d->saveFilters();
+    }
+    invalidateFilter();
+}
+
+bool QtItemFilterProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    Q_D(const QtItemFilterProxyModel);
+    if (sourceParent.isValid()) {
+        for (auto it = d->filters.cbegin(); it != d->filters.cend(); ++it) {
+            const QModelIndex index = sourceModel()->index(sourceRow, it->column, sourceParent);
+            if (!it->filter->acceptsValue(index.data(it->filter->patternRole())))
+                return false;
+        }
+    } else if (sourceRow < static_cast<int>(d->accepted.size()) && !d->accepted[sourceRow]) {
+        return false;
+    }
+    return QSortFilterProxyModel::filterAcceptsRow(sourceRow, sourceParent);
+}
+
+void QtItemFilterProxyModel::onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles)
+{
+    Q_D(QtItemFilterProxyModel);
+    if (topLeft.parent().isValid() || d->filters.empty())
+        return;
+
+    bool affected = false;
+    for (auto it = d->filters.cbegin(); it != d->filters.cend() && !affected; ++it) {
+        affected = (it->column >= topLeft.column() && it->column <= bottomRight.column() &&
+                    (roles.isEmpty() || roles.contains(it->filter->patternRole())));
+    }
+    if (affected)
+        d->evaluate(topLeft.row(), qMin(bottomRight.row(), static_cast<int>(d->accepted.size()) - 1));
+}
+
+void QtItemFilterProxyModel::onSourceRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    Q_D(QtItemFilterProxyModel);
+    if (parent.isValid())
+        return;
+
+    d->accepted.insert(d->accepted.begin() + first, last - first + 1, true);
+    d->evaluate(first, last);
+}
+
+void QtItemFilterProxyModel::onSourceRowsRemoved(const QModelIndex &parent, int first, int last)
+{
+    Q_D(QtItemFilterProxyModel);
+    if (parent.isValid())
+        return;
+
+    d->accepted.erase(d->accepted.begin() + first, d->accepted.begin() + last + 1);
+}
+
+void QtItemFilterProxyModel::onSourceRowsMoved(const QModelIndex &parent, int first, int last,
+                                               const QModelIndex &destination, int row)
+{
+    Q_D(QtItemFilterProxyModel);
+    const int count = last - first + 1;
+    if (!parent.isValid() && !destination.isValid())
+    {
+        // rows were removed from [first, last] and inserted before row
+        std::vector<bool> moved(d->accepted.begin() + first, d->accepted.begin() + last + 1);
+        d->accepted.erase(d->accepted.begin() + first, d->accepted.begin() + last + 1);
+        const int to = (row > last ? row - count : row);
+        d->accepted.insert(d->accepted.begin() + to, moved.begin(), moved.end());
+    }
+    else if (!parent.isValid())
+    {
+        d->accepted.erase(d->accepted.begin() + first, d->accepted.begin() + last + 1);
+    }
+    else if (!destination.isValid())
+    {
+        d->accepted.insert(d->accepted.begin() + row, count, true);
+        d->evaluate(row, row + count - 1);
+    }
+}
+
+void QtItemFilterProxyModel::onSourceLayoutChanged(const QList<QPersistentModelIndex> &parents)
+{
+    Q_D(QtItemFilterProxyModel);
+    // top-level rows may be permuted
+    if (parents.isEmpty() || std::any_of(parents.cbegin(), parents.cend(),
+                                         [](const QPersistentModelIndex& p) { return !p.isValid(); }))
+        d->evaluateAll();
+}
+
+void QtItemFilterProxyModel::onSourceReset()
+{
+    Q_D(QtItemFilterProxyModel);
+    d->evaluateAll();
+}
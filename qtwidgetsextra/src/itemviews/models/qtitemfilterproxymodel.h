@@ -0,0 +1,73 @@
+#ifndef QTITEMFILTERPROXYMODEL_H
+#define QTITEMFILTERPROXYMODEL_H
+
+#include <QSortFilterProxyModel>
+#include <QtWidgetsExtra>
+
+class QtItemFilter;
+
+/*!
+ * \brief The QtItemFilterProxyModel class
+ *
+ * Filtering proxy that accepts source rows passing all
+ * QtItemFilter instances attached to source columns.
+ *
+ * Filters are evaluated over a snapshot of filtered
+ * (column, role) values taken on the GUI thread; large
+ * models are split into row chunks evaluated in parallel.
+ * Results are kept as bitmap of accepted source rows, so
+ * base class mapping is updated without evaluating filters
+ * again and attached views receive only minimal row
+ * removals and insertions.
+ *
+ * QtItemFilter does not notify about its changes: call
+ * refilter() after changing attached filters. If every
+ * change made since the previous pass narrows the result
+ * (e.g. longer "contains" pattern, tighter range bound or
+ * newly attached filter) only currently accepted rows are
+ * evaluated again.
+ *
+ * \note only top-level rows are kept in bitmap, child rows
+ * are evaluated directly
+ */
+class QTWIDGETSEXTRA_EXPORT QtItemFilterProxyModel :
+        public QSortFilterProxyModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int parallelThreshold READ parallelThreshold WRITE setParallelThreshold)
+
+public:
+    explicit QtItemFilterProxyModel(QObject* parent = Q_NULLPTR);
+    ~QtItemFilterProxyModel();
+
+    void addFilter(int sourceColumn, QtItemFilter* filter);
+    int removeFilter(QtItemFilter* filter);
+    void clearFilters();
+    QList<QtItemFilter*> filters(int sourceColumn) const;
+
+    void setParallelThreshold(int rows);
+    int parallelThreshold() const;
+
+    int acceptedCount() const;
+
+    void setSourceModel(QAbstractItemModel* model) Q_DECL_OVERRIDE;
+
+public Q_SLOTS:
+    void refilter();
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const Q_DECL_OVERRIDE;
+
+private Q_SLOTS:
+    void onSourceDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& roles);
+    void onSourceRowsInserted(const QModelIndex& parent, int first, int last);
+    void onSourceRowsRemoved(const QModelIndex& parent, int first, int last);
+    void onSourceRowsMoved(const QModelIndex& parent, int first, int last, const QModelIndex& destination, int row);
+    void onSourceLayoutChanged(const QList<QPersistentModelIndex>& parents);
+    void onSourceReset();
+
+private:
+    QT_PIMPL(QtItemFilterProxyModel)
+};
+
+#endif // QTITEMFILTERPROXYMODEL_H
@@ -1,4 +1,6 @@
 #include <algorithm>
+#include <iterator>
+#include <QTimer>
 #include <QMetaObject>
 #include <QMetaClassInfo>
 #include <QCoreApplication>
@@ -18,10 +20,15 @@ inline QString className(const QMetaObject* metaObject)
     return QCoreApplication::translate(name, name);
 }
 
+// Removals of more ranges than this are
+// announced as single model reset
+static const int MaxRemovedRanges = 32;
+
 }
 
 QtObjectListModel::QtObjectListModel(QObject *parent)
     : QAbstractListModel(parent)
+    , mFlushScheduled(false)
 {
 }
 
@@ -31,9 +38,11 @@ QtObjectListModel::~QtObjectListModel()
 
 void QtObjectListModel::insert(QObject *object)
 {
-    if (object != Q_NULLPTR) {
-        beginInsertRows(QModelIndex(), mObjects.size(), mObjects.size());
+    if (object != Q_NULLPTR && !mRows.contains(object)) {
+        const int row = mObjects.size();
+        beginInsertRows(QModelIndex(), row, row);
         mObjects.push_back(object);
+        mRows.insert(object, row);
         connect(object, &QObject::destroyed, this, &QtObjectListModel::objectDestroyed);
         endInsertRows();
     }
@@ -41,44 +50,94 @@ void QtObjectListModel::insert(QObject *object)
 
 void QtObjectListModel::insert(const QObjectList &list)
 {
-    for (auto it = mObjects.cbegin(); it != mObjects.cend(); ++it) {
-        disconnect(*it, &QObject::destroyed, this, &QtObjectListModel::objectDestroyed);
+    QObjectList objects;
+    objects.reserve(list.size());
+    QHash<QObject*, int> rows;
+    for (auto it = list.cbegin(); it != list.cend(); ++it) {
+        if (*it != Q_NULLPTR && !mRows.contains(*it) && !rows.contains(*it)) {
+            rows.insert(*it, mObjects.size() + objects.size());
+            objects.push_back(*it);
+        }
     }
 
-    if (list.isEmpty())
+    if (objects.isEmpty())
         return;
 
-    beginInsertRows(QModelIndex(), mObjects.size(), mObjects.size() + list.size());
-    std::copy(list.cbegin(), list.cend(), std::back_inserter(mObjects));
-    for (auto it = list.cbegin(); it != list.cend(); ++it) {
-        connect(*it, &QObject::destroyed, this, &QtObjectListModel::objectDestroyed);
+    beginInsertRows(QModelIndex(), mObjects.size(), mObjects.size() + objects.size() - 1);
+    mObjects.append(objects);
+    mRows.reserve(mRows.size() + rows.size());
+    for (auto it = rows.cbegin(); it != rows.cend(); ++it) {
+        mRows.insert(it.key(), it.value());
+        connect(it.key(), &QObject::destroyed, this, &QtObjectListModel::objectDestroyed);
     }
     endInsertRows();
 }
 
 void QtObjectListModel::remove(QObject *object)
 {
-    int i = mObjects.indexOf(object);
+    const int i = indexOf(object);
     if (i == -1)
         return;
-    beginRemoveRows(QModelIndex(), i, i);
-    mObjects.removeAt(i);
-    endRemoveRows();
+    remove(i, 1);
+}
+
+void QtObjectListModel::remove(const QObjectList &list)
+{
+    std::vector<int> rows;
+    rows.reserve(list.size());
+    for (auto it = list.cbegin(); it != list.cend(); ++it) {
+        auto row = mRows.constFind(*it);
+        if (row != mRows.cend())
+            rows.push_back(*row);
+    }
+    if (rows.empty())
+        return;
+
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+    std::vector<std::pair<int, int>> ranges;
+    for (auto it = rows.cbegin(); it != rows.cend(); ++it) {
+        if (!ranges.empty() && ranges.back().second + 1 == *it)
+            ranges.back().second = *it;
+        else
+            ranges.emplace_back(*it, *it);
+
+        QObject* object = mObjects[*it];
+        mRows.remove(object);
+        disconnect(object, &QObject::destroyed, this, &QtObjectListModel::objectDestroyed);
+    }
+    removeRanges(ranges);
 }
 
 bool QtObjectListModel::remove(int row, int count)
 {
-    if (row < 0)
+    if (row < 0 || count <= 0)
         return false;
-    if ((row + count) >= mObjects.size())
+    if ((row + count) > mObjects.size())
         return false;
 
-    beginRemoveRows(QModelIndex(), row, count-1);
-    mObjects.erase(mObjects.begin() + row, mObjects.begin() + (row + count));
-    endRemoveRows();
+    for (int i = row; i < row + count; ++i) {
+        QObject* object = mObjects[i];
+        if (object != Q_NULLPTR) { // destroyed objects are already forgotten
+            mRows.remove(object);
+            disconnect(object, &QObject::destroyed, this, &QtObjectListModel::objectDestroyed);
+        }
+    }
+    removeRanges(std::vector<std::pair<int, int>>(1, std::make_pair(row, row + count - 1)));
     return true;
 }
 
+bool QtObjectListModel::contains(QObject *object) const
+{
+    return mRows.contains(object);
+}
+
+int QtObjectListModel::indexOf(QObject *object) const
+{
+    return mRows.value(object, -1);
+}
+
 bool QtObjectListModel::setObject(int row, QObject *object)
 {
     static const QVector<int> roles = { Qt::DisplayRole,
@@ -90,7 +149,22 @@ bool QtObjectListModel::setObject(int row, QObject *object)
     if (row < 0 || row >= mObjects.size())
         return false;
 
+    if (mObjects[row] == object)
+        return true;
+
+    if (mRows.contains(object))
+        return false; // already listed in other row
+
+    QObject* previous = mObjects[row];
+    if (previous != Q_NULLPTR) {
+        mRows.remove(previous);
+        disconnect(previous, &QObject::destroyed, this, &QtObjectListModel::objectDestroyed);
+    }
+
     mObjects[row] = object;
+    mRows.insert(object, row);
+    connect(object, &QObject::destroyed, this, &QtObjectListModel::objectDestroyed);
+
     QModelIndex idx = index(row);
     Q_EMIT dataChanged(idx, idx, roles);
     return true;
@@ -106,25 +180,103 @@ QObject *QtObjectListModel::objectAt(int row) const
 
 QObjectList QtObjectListModel::objects() const
 {
-    return mObjects;
+    if (!mFlushScheduled)
+        return mObjects;
+
+    // skip rows of destroyed objects
+    QObjectList result;
+    result.reserve(mRows.size());
+    std::copy_if(mObjects.cbegin(), mObjects.cend(), std::back_inserter(result),
+                 [](QObject* object) { return object != Q_NULLPTR; });
+    return result;
 }
 
 
 void QtObjectListModel::reset()
 {
-    beginRemoveRows(QModelIndex(), 0, mObjects.count()-1);
+    beginResetModel();
+    for (auto it = mObjects.cbegin(); it != mObjects.cend(); ++it) {
+        if (*it != Q_NULLPTR)
+            disconnect(*it, &QObject::destroyed, this, &QtObjectListModel::objectDestroyed);
+    }
     mObjects.clear();
-    endRemoveRows();
+    mRows.clear();
+    endResetModel();
 }
 
 void QtObjectListModel::objectDestroyed(QObject *object)
 {
-    int index = mObjects.indexOf(object);
-    if (index != -1) {
-        beginRemoveRows(QModelIndex(), index, index);
-        mObjects.removeAt(index);
+    auto it = mRows.find(object);
+    if (it == mRows.end())
+        return;
+
+    // object is half-destroyed: forget it now, drop its row later
+    mObjects[*it] = Q_NULLPTR;
+    mRows.erase(it);
+
+    if (!mFlushScheduled) {
+        mFlushScheduled = true;
+        QTimer::singleShot(0, this, &QtObjectListModel::flushDestroyed);
+    }
+}
+
+void QtObjectListModel::flushDestroyed()
+{
+    mFlushScheduled = false;
+
+    std::vector<std::pair<int, int>> ranges;
+    for (int i = 0, n = mObjects.size(); i < n; ++i) {
+        if (mObjects[i] != Q_NULLPTR)
+            continue;
+        if (!ranges.empty() && ranges.back().second + 1 == i)
+            ranges.back().second = i;
+        else
+            ranges.emplace_back(i, i);
+    }
+    removeRanges(ranges);
+}
+
+void QtObjectListModel::removeRanges(const std::vector<std::pair<int, int>> &ranges)
+{
+    if (ranges.empty())
+        return;
+
+    if (static_cast<int>(ranges.size()) > MaxRemovedRanges)
+    {
+        // too many separate removals: compact list in one pass
+        beginResetModel();
+        QObjectList objects;
+        objects.reserve(mObjects.size());
+        int i = 0;
+        for (auto it = ranges.cbegin(); it != ranges.cend(); ++it) {
+            for (; i < it->first; ++i)
+                objects.push_back(mObjects[i]);
+            i = it->second + 1;
+        }
+        for (; i < mObjects.size(); ++i)
+            objects.push_back(mObjects[i]);
+        mObjects.swap(objects);
+        updateRows(ranges.front().first, mObjects.size() - 1);
+        endResetModel();
+        return;
+    }
+
+    // remove from the bottom, so that rows of remaining ranges stay valid
+    for (auto it = ranges.crbegin(); it != ranges.crend(); ++it) {
+        beginRemoveRows(QModelIndex(), it->first, it->second);
+        mObjects.erase(mObjects.begin() + it->first, mObjects.begin() + it->second + 1);
         endRemoveRows();
     }
+    updateRows(ranges.front().first, mObjects.size() - 1);
+}
+
+void QtObjectListModel::updateRows(int first, int last)
+{
+    for (int i = first; i <= last; ++i) {
+        QObject* object = mObjects[i];
+        if (object != Q_NULLPTR)
+            mRows[object] = i;
+    }
 }
 
 int QtObjectListModel::rowCount(const QModelIndex &parent) const
@@ -150,6 +302,9 @@ QVariant QtObjectListModel::data(const QModelIndex &index, int role) const
         return QVariant();
 
     QObject* object = mObjects[row];
+    if (object == Q_NULLPTR) // destroyed, row is about to be removed
+        return QVariant();
+
     switch(role) {
         /*case Qt::ToolTipRole:
         case Qt::StatusTipRole:
@@ -176,6 +331,9 @@ bool QtObjectListModel::setData(const QModelIndex &index, const QVariant &value,
     if (row < 0 || row >= mObjects.size())
         return false;
 
+    if (mObjects[row] == Q_NULLPTR)
+        return false;
+
     if (data(index, role) != value && role == Qt::EditRole) {
         mObjects[row]->setObjectName(value.toString());
         Q_EMIT dataChanged(index, index, QVector<int>() << role);
@@ -192,6 +350,39 @@ Qt::ItemFlags QtObjectListModel::flags(const QModelIndex &index) const
     return Qt::ItemIsEnabled|Qt::ItemIsSelectable|Qt::ItemIsEditable;
 }
 
+bool QtObjectListModel::moveRows(const QModelIndex &sourceParent, int sourceRow, int count,
+                                 const QModelIndex &destinationParent, int destinationChild)
+{
+    if (sourceParent.isValid() || destinationParent.isValid())
+        return false;
+    if (sourceRow < 0 || count <= 0 || sourceRow + count > mObjects.size())
+        return false;
+    if (destinationChild < 0 || destinationChild > mObjects.size())
+        return false;
+    if (destinationChild >= sourceRow && destinationChild <= sourceRow + count)
+        return false; // no-op or move into itself
+
+    if (!beginMoveRows(QModelIndex(), sourceRow, sourceRow + count - 1, QModelIndex(), destinationChild))
+        return false;
+
+    int first, last;
+    if (destinationChild < sourceRow) {
+        std::rotate(mObjects.begin() + destinationChild, mObjects.begin() + sourceRow,
+                    mObjects.begin() + sourceRow + count);
+        first = destinationChild;
+        last = sourceRow + count - 1;
+    } else {
+        std::rotate(mObjects.begin() + sourceRow, mObjects.begin() + sourceRow + count,
+                    mObjects.begin() + destinationChild);
+        first = sourceRow;
+        last = destinationChild - 1;
+    }
+    updateRows(first, last);
+
+    endMoveRows();
+    return true;
+}
+
 
 /*bool QtObjectListModel::insertRows(int row, int count, const QModelIndex &parent)
 {
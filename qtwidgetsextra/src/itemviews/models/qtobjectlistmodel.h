@@ -2,7 +2,22 @@
 #define QTOBJECTLISTMODEL_H
 
 #include <QAbstractListModel>
-
+#include <QHash>
+
+#include <utility>
+#include <vector>
+
+/*!
+ * \brief The QtObjectListModel class
+ *
+ * List model of tracked objects. Rows of objects are kept
+ * in hash, so membership tests and removals by object do
+ * not search the list. Every object is listed at most once.
+ *
+ * Objects destroyed during one event loop turn are removed
+ * together as ranges of rows on the next turn; until then
+ * their rows stay in the model with empty data.
+ */
 class QtObjectListModel : public QAbstractListModel
 {
     Q_OBJECT
@@ -15,8 +30,12 @@ public:
     void insert(const QObjectList& list);
 
     void remove(QObject* object);
+    void remove(const QObjectList& list);
     bool remove(int row, int count = 1);
 
+    bool contains(QObject* object) const;
+    int indexOf(QObject* object) const;
+
     bool setObject(int row, QObject *object);
     QObject* objectAt(int row) const;
 
@@ -37,6 +56,9 @@ public:
 
     Qt::ItemFlags flags(const QModelIndex& index) const override;
 
+    bool moveRows(const QModelIndex &sourceParent, int sourceRow, int count,
+                  const QModelIndex &destinationParent, int destinationChild) override;
+
     // Add data:
     //bool insertRows(int row, int count, const QModelIndex &parent = QModelIndex()) override;
 
@@ -47,9 +69,15 @@ public Q_SLOTS:
 
 private Q_SLOTS:
     void objectDestroyed(QObject*object);
+    void flushDestroyed();
 
 private:
+    void removeRanges(const std::vector<std::pair<int, int>>& ranges);
+    void updateRows(int first, int last);
+
     QObjectList mObjects;
+    QHash<QObject*, int> mRows; // object -> row
+    bool mFlushScheduled;
 };
 
 #endif // QTOBJECTLISTMODEL_H
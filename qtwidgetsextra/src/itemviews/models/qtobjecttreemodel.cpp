@@ -1,56 +1,193 @@
 #include "qtobjecttreemodel.h"
 #include <QChildEvent>
+#include <QPointer>
+#include <QThread>
+#include <QHash>
+
+#include <vector>
+
+class QtObjectTreeModelPrivate
+{
+public:
+    struct Node
+    {
+        QPointer<QObject> object; // becomes null as soon as object destruction starts
+        QObject* key;             // object address in reverse map
+        Node* parent;
+        int row;
+        bool fetched;
+        std::vector<Node*> children;
+
+        Node(QObject* o, Node* p, int r) :
+            object(o), key(o), parent(p), row(r), fetched(false) {
+        }
+    };
+
+    QtObjectTreeModel* q_ptr;
+    Node* root;
+    QHash<QObject*, Node*> nodes; // object -> node
+    bool editable;
+
+    QtObjectTreeModelPrivate(QtObjectTreeModel* q) :
+        q_ptr(q), root(Q_NULLPTR), editable(false)
+    {
+    }
+
+    inline Node* node(const QModelIndex& index) const
+    {
+        return (index.isValid() ? static_cast<Node*>(index.internalPointer()) : root);
+    }
+
+    inline QModelIndex index(Node* n) const
+    {
+        if (n == Q_NULLPTR || n == root)
+            return QModelIndex();
+        return q_ptr->createIndex(n->row, 0, n);
+    }
+
+    Node* createNode(QObject* object, Node* parent, int row);
+    void destroyNode(Node* n);
+    void populate(Node* n);
+    void childAdded(Node* n, QObject* child);
+    void childRemoved(Node* n, QObject* child);
+};
+
+QtObjectTreeModelPrivate::Node *QtObjectTreeModelPrivate::createNode(QObject *object, Node *parent, int row)
+{
+    Node* n = new Node(object, parent, row);
+    nodes.insert(object, n);
+    // cross-thread event filters are not supported
+    if (object->thread() == q_ptr->thread())
+        object->installEventFilter(q_ptr);
+    return n;
+}
+
+void QtObjectTreeModelPrivate::destroyNode(Node *n)
+{
+    for (auto it = n->children.begin(); it != n->children.end(); ++it)
+        destroyNode(*it);
+
+    auto it = nodes.find(n->key);
+    if (it != nodes.end() && *it == n)
+        nodes.erase(it);
+    if (n->object)
+        n->object->removeEventFilter(q_ptr);
+    delete n;
+}
+
+void QtObjectTreeModelPrivate::populate(Node *n)
+{
+    n->fetched = true;
+    if (!n->object)
+        return;
+
+    const QObjectList& objects = n->object->children();
+    n->children.reserve(objects.size());
+    for (auto it = objects.cbegin(); it != objects.cend(); ++it) {
+        if (*it != Q_NULLPTR) // children of object being deleted are nulled
+            n->children.push_back(createNode(*it, n, static_cast<int>(n->children.size())));
+    }
+}
+
+void QtObjectTreeModelPrivate::childAdded(Node *n, QObject *child)
+{
+    Node* c = nodes.value(child);
+    if (c != Q_NULLPTR && c->parent == n)
+        return;
+
+    // new children are always appended to QObject::children()
+    const int row = static_cast<int>(n->children.size());
+    q_ptr->beginInsertRows(index(n), row, row);
+    n->children.push_back(createNode(child, n, row));
+    q_ptr->endInsertRows();
+}
+
+void QtObjectTreeModelPrivate::childRemoved(Node *n, QObject *child)
+{
+    Node* c = nodes.value(child);
+    if (c == Q_NULLPTR || c->parent != n)
+        return;
+
+    const int row = c->row;
+    q_ptr->beginRemoveRows(index(n), row, row);
+    n->children.erase(n->children.begin() + row);
+    for (int i = row; i < static_cast<int>(n->children.size()); ++i)
+        n->children[i]->row = i;
+    destroyNode(c);
+    q_ptr->endRemoveRows();
+}
+
+
 
 QtObjectTreeModel::QtObjectTreeModel(QObject *root, QObject *parent) :
-    QAbstractItemModel(parent), mRoot(Q_NULLPTR), mEditable(false)
+    QAbstractItemModel(parent),
+    d_ptr(new QtObjectTreeModelPrivate(this))
 {
     setRootObject(root);
 }
 
+QtObjectTreeModel::~QtObjectTreeModel()
+{
+    Q_D(QtObjectTreeModel);
+    if (d->root)
+        d->destroyNode(d->root);
+}
+
 void QtObjectTreeModel::setRootObject(QObject *root)
 {
-    if (mRoot != root) {
-        if (mRoot != Q_NULLPTR)
-            mRoot->removeEventFilter(this);
+    Q_D(QtObjectTreeModel);
+    if (rootObject() == root)
+        return;
+
+    beginResetModel();
+    if (d->root) {
+        if (d->root->object)
+            disconnect(d->root->object, &QObject::destroyed, this, &QtObjectTreeModel::onRootDestroyed);
+        d->destroyNode(d->root);
+        d->root = Q_NULLPTR;
+    }
 
-        mRoot = root;
-        if (mRoot != Q_NULLPTR) {
-            mRoot->installEventFilter(this);
-        }
-        beginResetModel();
-        endResetModel();
-        Q_EMIT rootObjectChanged(mRoot);
+    if (root != Q_NULLPTR) {
+        d->root = d->createNode(root, Q_NULLPTR, 0);
+        d->populate(d->root);
+        connect(root, &QObject::destroyed, this, &QtObjectTreeModel::onRootDestroyed);
     }
+    endResetModel();
+    Q_EMIT rootObjectChanged(root);
 }
 
 QObject *QtObjectTreeModel::rootObject() const
 {
-    return mRoot;
+    Q_D(const QtObjectTreeModel);
+    return (d->root ? d->root->object.data() : Q_NULLPTR);
 }
 
 QObject *QtObjectTreeModel::object(const QModelIndex &index) const
 {
+    Q_D(const QtObjectTreeModel);
     if (!index.isValid())
         return Q_NULLPTR;
 
     if (index.model() != this)
         return Q_NULLPTR;
 
-    return static_cast<QObject*>(index.internalPointer());
+    return d->node(index)->object.data();
 }
 
 
 void QtObjectTreeModel::setEditable(bool on)
 {
-    if (mEditable != on) {
-        mEditable = on;
-        Q_EMIT editableChanged(mEditable);
+    Q_D(QtObjectTreeModel);
+    if (d->editable != on) {
+        d->editable = on;
+        Q_EMIT editableChanged(d->editable);
     }
 }
 
 bool QtObjectTreeModel::isEditable() const
 {
-    return mEditable;
+    Q_D(const QtObjectTreeModel);
+    return d->editable;
 }
 
 QVariant QtObjectTreeModel::headerData(int section, Qt::Orientation orientation, int role) const
@@ -68,45 +205,35 @@ QVariant QtObjectTreeModel::headerData(int section, Qt::Orientation orientation,
 
 QModelIndex QtObjectTreeModel::index(int row, int column, const QModelIndex &parent) const
 {
-    QObject *parentObject;
+    Q_D(const QtObjectTreeModel);
 
-     if( !parent.isValid() )
-       parentObject = mRoot;
-     else
-       parentObject = static_cast<QObject*>( parent.internalPointer() );
+    QtObjectTreeModelPrivate::Node* node = d->node(parent);
+    if (node == Q_NULLPTR || row < 0 || column < 0 || column >= columnCount())
+        return QModelIndex();
 
-     if( row < parentObject->children().count() )
-       return createIndex( row, column, parentObject->children().at( row ) );
-     else
-       return QModelIndex();
+    if (row < static_cast<int>(node->children.size()))
+        return createIndex(row, column, node->children[row]);
+    else
+        return QModelIndex();
 }
 
 QModelIndex QtObjectTreeModel::parent(const QModelIndex &index) const
 {
+    Q_D(const QtObjectTreeModel);
     if( !index.isValid() )
        return QModelIndex();
 
-     QObject *indexObject = static_cast<QObject*>( index.internalPointer() );
-     QObject *parentObject = indexObject->parent();
-
-     if( parentObject == mRoot )
-       return QModelIndex();
-
-     QObject *grandParentObject = parentObject->parent();
-
-     return createIndex( grandParentObject->children().indexOf( parentObject ), 0, parentObject );
+    return d->index(d->node(index)->parent);
 }
 
 int QtObjectTreeModel::rowCount(const QModelIndex &parent) const
 {
-    QObject *parentObject;
-
-     if( !parent.isValid() )
-       parentObject = mRoot;
-     else
-       parentObject = static_cast<QObject*>( parent.internalPointer() );
+    Q_D(const QtObjectTreeModel);
+    if (parent.column() > 0)
+        return 0;
 
-     return parentObject->children().count();
+    QtObjectTreeModelPrivate::Node* node = d->node(parent);
+    return (node != Q_NULLPTR ? static_cast<int>(node->children.size()) : 0);
 }
 
 int QtObjectTreeModel::columnCount(const QModelIndex &parent) const
@@ -117,14 +244,58 @@ int QtObjectTreeModel::columnCount(const QModelIndex &parent) const
     return 2;
 }
 
+bool QtObjectTreeModel::hasChildren(const QModelIndex &parent) const
+{
+    Q_D(const QtObjectTreeModel);
+    if (parent.column() > 0)
+        return false;
+
+    QtObjectTreeModelPrivate::Node* node = d->node(parent);
+    if (node == Q_NULLPTR)
+        return false;
+    if (node->fetched)
+        return !node->children.empty();
+    return (node->object && !node->object->children().isEmpty());
+}
+
+bool QtObjectTreeModel::canFetchMore(const QModelIndex &parent) const
+{
+    Q_D(const QtObjectTreeModel);
+    QtObjectTreeModelPrivate::Node* node = d->node(parent);
+    return (node != Q_NULLPTR && !node->fetched);
+}
+
+void QtObjectTreeModel::fetchMore(const QModelIndex &parent)
+{
+    Q_D(QtObjectTreeModel);
+    QtObjectTreeModelPrivate::Node* node = d->node(parent);
+    if (node == Q_NULLPTR || node->fetched)
+        return;
+
+    int n = 0;
+    if (node->object) {
+        const QObjectList& objects = node->object->children();
+        n = static_cast<int>(objects.size() - objects.count(Q_NULLPTR));
+    }
+    if (n == 0) {
+        node->fetched = true;
+        return;
+    }
+
+    beginInsertRows(parent.sibling(parent.row(), 0), 0, n - 1);
+    d->populate(node);
+    endInsertRows();
+}
+
 QVariant QtObjectTreeModel::data(const QModelIndex &index, int role) const
 {
+    Q_D(const QtObjectTreeModel);
     if (!index.isValid())
         return QVariant();
 
     if( role == Qt::DisplayRole || role == Qt::EditRole || role == Qt::ToolTipRole )
     {
-        QObject* object = static_cast<QObject*>( index.internalPointer() );
+        QObject* object = d->node(index)->object.data();
         switch( index.column() )
         {
         case 0:
@@ -141,7 +312,8 @@ QVariant QtObjectTreeModel::data(const QModelIndex &index, int role) const
 
 bool QtObjectTreeModel::setData(const QModelIndex &index, const QVariant &value, int role)
 {
-    if (!mEditable)
+    Q_D(QtObjectTreeModel);
+    if (!d->editable)
         return false;
 
     if (!index.isValid())
@@ -151,7 +323,7 @@ bool QtObjectTreeModel::setData(const QModelIndex &index, const QVariant &value,
         return false;
 
     if (data(index, role) != value) {
-        QObject* object = static_cast<QObject*>( index.internalPointer() );
+        QObject* object = d->node(index)->object.data();
         if (object != Q_NULLPTR) {
             object->setObjectName(value.toString());
             emit dataChanged(index, index, QVector<int>() << role);
@@ -163,34 +335,44 @@ bool QtObjectTreeModel::setData(const QModelIndex &index, const QVariant &value,
 
 Qt::ItemFlags QtObjectTreeModel::flags(const QModelIndex &index) const
 {
+    Q_D(const QtObjectTreeModel);
     if (!index.isValid())
         return Qt::NoItemFlags;
 
     Qt::ItemFlags flags = Qt::ItemIsEnabled | Qt::ItemIsSelectable;
-    return (mEditable ? flags | Qt::ItemIsEditable : flags);
+    return (d->editable ? flags | Qt::ItemIsEditable : flags);
 }
 
 bool QtObjectTreeModel::eventFilter(QObject *watched, QEvent *event)
 {
+    Q_D(QtObjectTreeModel);
     const int eventType = event->type();
-    if (watched == mRoot && (eventType == QEvent::ChildAdded || eventType == QEvent::ChildRemoved))
+    if (eventType == QEvent::ChildAdded || eventType == QEvent::ChildRemoved)
     {
-        //QChildEvent* childEvent = static_cast<QChildEvent*>(event);
-        /*if (childEvent->added()) {
-            int n = rowCount();
-            beginInsertRows(QModelIndex(), n, n);
-            endInsertRows();
+        // unfetched nodes will read actual children on fetchMore()
+        QtObjectTreeModelPrivate::Node* node = d->nodes.value(watched);
+        if (node != Q_NULLPTR && node->fetched)
+        {
+            QChildEvent* childEvent = static_cast<QChildEvent*>(event);
+            if (childEvent->added())
+                d->childAdded(node, childEvent->child());
+            else
+                d->childRemoved(node, childEvent->child());
         }
-
-        if (childEvent->removed()) {
-            int row = mRoot->children().indexOf(childEvent->child());
-            beginRemoveRows(QModelIndex(), row, row);
-            endRemoveRows();
-        }*/
-        //Q_EMIT layoutChanged();
     }
 
     return QAbstractItemModel::eventFilter(watched, event);
 }
 
+void QtObjectTreeModel::onRootDestroyed()
+{
+    Q_D(QtObjectTreeModel);
 
+    beginResetModel();
+    if (d->root) {
+        d->destroyNode(d->root);
+        d->root = Q_NULLPTR;
+    }
+    endResetModel();
+    Q_EMIT rootObjectChanged(Q_NULLPTR);
+}
@@ -4,6 +4,21 @@
 #include <QAbstractItemModel>
 #include <QtWidgetsExtra>
 
+/*!
+ * \brief The QtObjectTreeModel class
+ *
+ * Tree model of QObject hierarchy under root object.
+ *
+ * Model keeps its own table of nodes: child vectors with
+ * cached row of every node and reverse map from objects to
+ * nodes, so index(), parent() and rowCount() never walk
+ * QObject::children(). Children are populated lazily with
+ * canFetchMore()/fetchMore(). Every object present in the
+ * model is watched, so ChildAdded/ChildRemoved events are
+ * turned into precise row insertions and removals.
+ *
+ * \note only objects living in the model's thread are watched
+ */
 class QTWIDGETSEXTRA_EXPORT QtObjectTreeModel : public QAbstractItemModel
 {
     Q_OBJECT
@@ -11,6 +26,7 @@ class QTWIDGETSEXTRA_EXPORT QtObjectTreeModel : public QAbstractItemModel
 
 public:
     explicit QtObjectTreeModel(QObject *root, QObject *parent = Q_NULLPTR);
+    ~QtObjectTreeModel();
 
     void setRootObject(QObject* root);
     QObject* rootObject() const;
@@ -32,6 +48,10 @@ public:
     int rowCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE;
     int columnCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE;
 
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE;
+    bool canFetchMore(const QModelIndex &parent) const Q_DECL_OVERRIDE;
+    void fetchMore(const QModelIndex &parent) Q_DECL_OVERRIDE;
+
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const Q_DECL_OVERRIDE;
 
     // Editable:
@@ -47,11 +67,11 @@ Q_SIGNALS:
 protected:
     virtual bool eventFilter(QObject *watched, QEvent *event) Q_DECL_OVERRIDE;
 
-private:
-    QObject* mRoot;
-    bool mEditable;
-
+private Q_SLOTS:
+    void onRootDestroyed();
 
+private:
+    QT_PIMPL(QtObjectTreeModel)
 };
 
 #endif // QTOBJECTTREEMODEL_H
@@ -1,34 +1,209 @@
 #include "qtrevertibleproxymodel.h"
-#include <QMultiHash>
+#include <QPersistentModelIndex>
+#include <QHash>
+
+#include <map>
+#include <vector>
+#include <algorithm>
+
+namespace
+{
+
+struct CellKey
+{
+    int parent; // index in parents table, 0 is the root
+    int row;
+    int column;
+
+    CellKey(int p, int r, int c) : parent(p), row(r), column(c) {}
+
+    inline bool operator<(const CellKey& other) const
+    {
+        if (parent != other.parent)
+            return (parent < other.parent);
+        if (row != other.row)
+            return (row < other.row);
+        return (column < other.column);
+    }
+};
+
+typedef QMap<int, QVariant> CellValues;
+
+struct Edit
+{
+    CellKey cell;
+    int role;
+    QVariant before;
+    QVariant after;
+    bool hadBefore;
+
+    Edit(const CellKey& c, int r) : cell(c), role(r), hadBefore(false) {}
+};
+
+// Changes of more ranges than this are announced
+// with single bounding range per parent
+static const int MaxChangedRanges = 64;
+
+}
 
 class QtRevertibleProxyModelPrivate
 {
 public:
-    struct ItemData
+    typedef std::map<CellKey, CellValues> Journal;
+
+    Journal journal;
+    QVector<QPersistentModelIndex> parents; // source parents of journaled cells
+    QHash<QModelIndex, int> parentIds; // positions in parents table, rebuilt on structural changes
+    std::vector<Edit> log;
+    std::vector<size_t> checkpoints;
+    size_t position; // number of applied log entries
+    // persistent copies of journaled cells during structural source changes
+    std::vector<std::pair<QPersistentModelIndex, CellValues>> moving;
+    QtRevertibleProxyModel::CommitHook hook;
+
+    QtRevertibleProxyModelPrivate() :
+        parents(1),
+        position(0)
+    {
+    }
+
+    int findParent(const QModelIndex& parent) const
+    {
+        if (!parent.isValid())
+            return 0;
+        return parentIds.value(parent, -1);
+    }
+
+    int parentId(const QModelIndex& parent)
+    {
+        const int id = findParent(parent);
+        if (id >= 0)
+            return id;
+        parents.push_back(QPersistentModelIndex(parent));
+        parentIds.insert(parent, parents.size() - 1);
+        return (parents.size() - 1);
+    }
+
+    const CellValues* find(const QModelIndex& source) const
     {
-        QVariant value;
-        int role;
-        ItemData(const QVariant& v, int r) :
-            value(v), role(r) {
+        const int parent = findParent(source.parent());
+        if (parent < 0)
+            return Q_NULLPTR;
+        auto it = journal.find(CellKey(parent, source.row(), source.column()));
+        return (it != journal.end() ? &it->second : Q_NULLPTR);
+    }
+
+    inline QModelIndex sourceIndex(const QAbstractItemModel* model, const CellKey& key) const
+    {
+        return model->index(key.row, key.column, parents[key.parent]);
+    }
+
+    void assign(const CellKey& key, int role, const QVariant& value, bool present)
+    {
+        if (present) {
+            journal[key][role] = value;
+            return;
         }
-    };
+        auto it = journal.find(key);
+        if (it == journal.end())
+            return;
+        it->second.remove(role);
+        if (it->second.isEmpty())
+            journal.erase(it);
+    }
 
-    QHash<QPersistentModelIndex, ItemData> cache;
+    void clearHistory()
+    {
+        log.clear();
+        checkpoints.clear();
+        position = 0;
+    }
 
-    inline void cacheIndex(const QModelIndex& index, const QVariant& value, int role);
-    inline void revertModel(QAbstractItemModel* model);
+    void clearParents()
+    {
+        parents.resize(1);
+        parentIds.clear();
+    }
+
+    void clear()
+    {
+        journal.clear();
+        clearParents();
+        clearHistory();
+    }
+
+    void notify(QtRevertibleProxyModel* q, std::vector<CellKey>& cells) const;
+    void move(QtRevertibleProxyModel* q, size_t target);
 };
 
-inline void QtRevertibleProxyModelPrivate::cacheIndex(const QModelIndex &index, const QVariant &value, int role)
+void QtRevertibleProxyModelPrivate::notify(QtRevertibleProxyModel *q, std::vector<CellKey> &cells) const
 {
-    cache.insertMulti(index, ItemData(value, role));
+    if (cells.empty())
+        return;
+
+    std::sort(cells.begin(), cells.end());
+
+    // coalesce cells of consecutive rows under the same parent
+    struct Range { int parent, top, bottom, left, right; };
+    std::vector<Range> ranges;
+    for (auto it = cells.cbegin(); it != cells.cend(); ++it)
+    {
+        if (!ranges.empty()) {
+            Range& r = ranges.back();
+            if (r.parent == it->parent && it->row <= r.bottom + 1) {
+                r.bottom = qMax(r.bottom, it->row);
+                r.left = qMin(r.left, it->column);
+                r.right = qMax(r.right, it->column);
+                continue;
+            }
+        }
+        ranges.push_back({ it->parent, it->row, it->row, it->column, it->column });
+    }
+
+    if (static_cast<int>(ranges.size()) > MaxChangedRanges) {
+        std::vector<Range> bounds;
+        for (auto it = ranges.cbegin(); it != ranges.cend(); ++it) {
+            if (!bounds.empty() && bounds.back().parent == it->parent) {
+                Range& r = bounds.back();
+                r.top = qMin(r.top, it->top);
+                r.bottom = qMax(r.bottom, it->bottom);
+                r.left = qMin(r.left, it->left);
+                r.right = qMax(r.right, it->right);
+            } else {
+                bounds.push_back(*it);
+            }
+        }
+        ranges.swap(bounds);
+    }
+
+    for (auto it = ranges.cbegin(); it != ranges.cend(); ++it) {
+        const QPersistentModelIndex& parent = parents[it->parent];
+        if (it->parent != 0 && !parent.isValid())
+            continue;
+        const QModelIndex proxyParent = q->mapFromSource(parent);
+        Q_EMIT q->dataChanged(q->index(it->top, it->left, proxyParent),
+                              q->index(it->bottom, it->right, proxyParent));
+    }
 }
 
-inline void QtRevertibleProxyModelPrivate::revertModel(QAbstractItemModel *model)
+void QtRevertibleProxyModelPrivate::move(QtRevertibleProxyModel *q, size_t target)
 {
-    for (auto it = cache.begin(); it != cache.end(); ++it) {
-        model->setData(it.key(), (*it).value, (*it).role);
+    std::vector<CellKey> cells;
+    if (target < position) {
+        for (size_t i = position; i-- > target; ) {
+            const Edit& e = log[i];
+            assign(e.cell, e.role, e.before, e.hadBefore);
+            cells.push_back(e.cell);
+        }
+    } else {
+        for (size_t i = position; i < target; ++i) {
+            const Edit& e = log[i];
+            assign(e.cell, e.role, e.after, true);
+            cells.push_back(e.cell);
+        }
     }
+    position = target;
+    notify(q, cells);
 }
 
 
@@ -45,38 +220,258 @@ QtRevertibleProxyModel::~QtRevertibleProxyModel()
 bool QtRevertibleProxyModel::hasUncommitedChanges() const
 {
     Q_D(const QtRevertibleProxyModel);
-    return (!d->cache.empty());
+    return (!d->journal.empty());
 }
 
 int QtRevertibleProxyModel::cacheSize() const
 {
     Q_D(const QtRevertibleProxyModel);
-    return d->cache.size();
+    int n = 0;
+    for (auto it = d->journal.cbegin(); it != d->journal.cend(); ++it)
+        n += it->second.size();
+    return n;
+}
+
+void QtRevertibleProxyModel::setCommitHook(const QtRevertibleProxyModel::CommitHook &hook)
+{
+    Q_D(QtRevertibleProxyModel);
+    d->hook = hook;
+}
+
+QtRevertibleProxyModel::CommitHook QtRevertibleProxyModel::commitHook() const
+{
+    Q_D(const QtRevertibleProxyModel);
+    return d->hook;
+}
+
+int QtRevertibleProxyModel::checkpoint()
+{
+    Q_D(QtRevertibleProxyModel);
+    if (d->checkpoints.empty() || d->checkpoints.back() != d->position)
+        d->checkpoints.push_back(d->position);
+    return static_cast<int>(d->checkpoints.size());
+}
+
+bool QtRevertibleProxyModel::canUndo() const
+{
+    Q_D(const QtRevertibleProxyModel);
+    return (d->position > 0);
+}
+
+bool QtRevertibleProxyModel::canRedo() const
+{
+    Q_D(const QtRevertibleProxyModel);
+    return (d->position < d->log.size());
+}
+
+void QtRevertibleProxyModel::undo()
+{
+    Q_D(QtRevertibleProxyModel);
+    if (d->position == 0)
+        return;
+
+    size_t target = 0;
+    for (auto it = d->checkpoints.crbegin(); it != d->checkpoints.crend(); ++it) {
+        if (*it < d->position) {
+            target = *it;
+            break;
+        }
+    }
+    d->move(this, target);
+}
+
+void QtRevertibleProxyModel::redo()
+{
+    Q_D(QtRevertibleProxyModel);
+    if (d->position == d->log.size())
+        return;
+
+    size_t target = d->log.size();
+    for (auto it = d->checkpoints.cbegin(); it != d->checkpoints.cend(); ++it) {
+        if (*it > d->position) {
+            target = *it;
+            break;
+        }
+    }
+    d->move(this, target);
 }
 
 void QtRevertibleProxyModel::setSourceModel(QAbstractItemModel *sourceModel)
 {
+    Q_D(QtRevertibleProxyModel);
+
     submit();
+
+    QAbstractItemModel* source = this->sourceModel();
+    if (source) {
+        disconnect(source, &QAbstractItemModel::rowsAboutToBeInserted, this, &QtRevertibleProxyModel::onSourceAboutToBeChanged);
+        disconnect(source, &QAbstractItemModel::rowsInserted, this, &QtRevertibleProxyModel::onSourceChanged);
+        disconnect(source, &QAbstractItemModel::rowsAboutToBeRemoved, this, &QtRevertibleProxyModel::onSourceAboutToBeChanged);
+        disconnect(source, &QAbstractItemModel::rowsRemoved, this, &QtRevertibleProxyModel::onSourceChanged);
+        disconnect(source, &QAbstractItemModel::rowsAboutToBeMoved, this, &QtRevertibleProxyModel::onSourceAboutToBeChanged);
+        disconnect(source, &QAbstractItemModel::rowsMoved, this, &QtRevertibleProxyModel::onSourceChanged);
+        disconnect(source, &QAbstractItemModel::columnsAboutToBeInserted, this, &QtRevertibleProxyModel::onSourceAboutToBeChanged);
+        disconnect(source, &QAbstractItemModel::columnsInserted, this, &QtRevertibleProxyModel::onSourceChanged);
+        disconnect(source, &QAbstractItemModel::columnsAboutToBeRemoved, this, &QtRevertibleProxyModel::onSourceAboutToBeChanged);
+        disconnect(source, &QAbstractItemModel::columnsRemoved, this, &QtRevertibleProxyModel::onSourceChanged);
+        disconnect(source, &QAbstractItemModel::columnsAboutToBeMoved, this, &QtRevertibleProxyModel::onSourceAboutToBeChanged);
+        disconnect(source, &QAbstractItemModel::columnsMoved, this, &QtRevertibleProxyModel::onSourceChanged);
+        disconnect(source, &QAbstractItemModel::layoutAboutToBeChanged, this, &QtRevertibleProxyModel::onSourceAboutToBeChanged);
+        disconnect(source, &QAbstractItemModel::layoutChanged, this, &QtRevertibleProxyModel::onSourceChanged);
+        disconnect(source, &QAbstractItemModel::modelAboutToBeReset, this, &QtRevertibleProxyModel::onSourceAboutToBeChanged);
+        disconnect(source, &QAbstractItemModel::modelReset, this, &QtRevertibleProxyModel::onSourceChanged);
+    }
+
+    // connect before the base class: journal must be
+    // remapped before views are notified
+    if (sourceModel) {
+        connect(sourceModel, &QAbstractItemModel::rowsAboutToBeInserted, this, &QtRevertibleProxyModel::onSourceAboutToBeChanged);
+        connect(sourceModel, &QAbstractItemModel::rowsInserted, this, &QtRevertibleProxyModel::onSourceChanged);
+        connect(sourceModel, &QAbstractItemModel::rowsAboutToBeRemoved, this, &QtRevertibleProxyModel::onSourceAboutToBeChanged);
+        connect(sourceModel, &QAbstractItemModel::rowsRemoved, this, &QtRevertibleProxyModel::onSourceChanged);
+        connect(sourceModel, &QAbstractItemModel::rowsAboutToBeMoved, this, &QtRevertibleProxyModel::onSourceAboutToBeChanged);
+        connect(sourceModel, &QAbstractItemModel::rowsMoved, this, &QtRevertibleProxyModel::onSourceChanged);
+        connect(sourceModel, &QAbstractItemModel::columnsAboutToBeInserted, this, &QtRevertibleProxyModel::onSourceAboutToBeChanged);
+        connect(sourceModel, &QAbstractItemModel::columnsInserted, this, &QtRevertibleProxyModel::onSourceChanged);
+        connect(sourceModel, &QAbstractItemModel::columnsAboutToBeRemoved, this, &QtRevertibleProxyModel::onSourceAboutToBeChanged);
+        connect(sourceModel, &QAbstractItemModel::columnsRemoved, this, &QtRevertibleProxyModel::onSourceChanged);
+        connect(sourceModel, &QAbstractItemModel::columnsAboutToBeMoved, this, &QtRevertibleProxyModel::onSourceAboutToBeChanged);
+        connect(sourceModel, &QAbstractItemModel::columnsMoved, this, &QtRevertibleProxyModel::onSourceChanged);
+        connect(sourceModel, &QAbstractItemModel::layoutAboutToBeChanged, this, &QtRevertibleProxyModel::onSourceAboutToBeChanged);
+        connect(sourceModel, &QAbstractItemModel::layoutChanged, this, &QtRevertibleProxyModel::onSourceChanged);
+        connect(sourceModel, &QAbstractItemModel::modelAboutToBeReset, this, &QtRevertibleProxyModel::onSourceAboutToBeChanged);
+        connect(sourceModel, &QAbstractItemModel::modelReset, this, &QtRevertibleProxyModel::onSourceChanged);
+    }
+
+    d->clear();
     QIdentityProxyModel::setSourceModel(sourceModel);
 }
 
+QVariant QtRevertibleProxyModel::data(const QModelIndex &index, int role) const
+{
+    Q_D(const QtRevertibleProxyModel);
+    if (d->journal.empty() || !index.isValid())
+        return QIdentityProxyModel::data(index, role);
+
+    const CellValues* values = d->find(mapToSource(index));
+    if (!values)
+        return QIdentityProxyModel::data(index, role);
+
+    auto v = values->constFind(role);
+    if (v != values->cend())
+        return *v;
+
+    // edit and display roles are the same for most of the models
+    if (role == Qt::DisplayRole || role == Qt::EditRole) {
+        v = values->constFind(role == Qt::DisplayRole ? Qt::EditRole : Qt::DisplayRole);
+        if (v != values->cend())
+            return *v;
+    }
+    return QIdentityProxyModel::data(index, role);
+}
+
+QMap<int, QVariant> QtRevertibleProxyModel::itemData(const QModelIndex &index) const
+{
+    Q_D(const QtRevertibleProxyModel);
+    QMap<int, QVariant> result = QIdentityProxyModel::itemData(index);
+    if (d->journal.empty() || !index.isValid())
+        return result;
+
+    const CellValues* values = d->find(mapToSource(index));
+    if (!values)
+        return result;
+
+    for (auto it = values->cbegin(); it != values->cend(); ++it)
+        result[it.key()] = it.value();
+
+    // same substitution of edit and display roles as in data()
+    if (values->contains(Qt::EditRole) && !values->contains(Qt::DisplayRole))
+        result[Qt::DisplayRole] = values->value(Qt::EditRole);
+    else if (values->contains(Qt::DisplayRole) && !values->contains(Qt::EditRole))
+        result[Qt::EditRole] = values->value(Qt::DisplayRole);
+    return result;
+}
+
 bool QtRevertibleProxyModel::setData(const QModelIndex &index, const QVariant &value, int role)
 {
     Q_D(QtRevertibleProxyModel);
-    QModelIndex idx = mapToSource(index);
-    QVariant val = idx.data(role);
-    if (QIdentityProxyModel::setData(index, value, role)) {
-        d->cacheIndex(idx, val, role);
-        Q_EMIT changesCached(index, role);
-        return true;
+    if (!index.isValid() || !sourceModel())
+        return false;
+
+    if (!(flags(index) & (Qt::ItemIsEditable | Qt::ItemIsUserCheckable)))
+        return false;
+
+    const QModelIndex source = mapToSource(index);
+    const CellKey key(d->parentId(source.parent()), source.row(), source.column());
+
+    Edit edit(key, role);
+    auto it = d->journal.find(key);
+    if (it != d->journal.end()) {
+        auto v = it->second.constFind(role);
+        if (v != it->second.cend()) {
+            edit.before = *v;
+            edit.hadBefore = true;
+        }
     }
-    return false;
+    edit.after = value;
+    d->journal[key][role] = value;
+
+    // new edit drops everything that could be redone
+    d->log.resize(d->position, edit);
+    while (!d->checkpoints.empty() && d->checkpoints.back() > d->position)
+        d->checkpoints.pop_back();
+    d->log.push_back(edit);
+    ++d->position;
+
+    Q_EMIT dataChanged(index, index, QVector<int>() << role);
+    Q_EMIT changesCached(index, role);
+    return true;
 }
 
 bool QtRevertibleProxyModel::submit()
 {
     Q_D(QtRevertibleProxyModel);
-    d->cache.clear();
+
+    QAbstractItemModel* model = sourceModel();
+    if (d->journal.empty() || !model) {
+        d->clear();
+        Q_EMIT accepted();
+        return true;
+    }
+
+    if (d->hook)
+    {
+        ChangeList changes;
+        changes.reserve(static_cast<int>(d->journal.size()));
+        for (auto it = d->journal.cbegin(); it != d->journal.cend(); ++it) {
+            const QModelIndex index = d->sourceIndex(model, it->first);
+            if (index.isValid())
+                changes.push_back({ index, it->second });
+        }
+        if (!d->hook(model, changes))
+            return false;
+        d->clear();
+    }
+    else
+    {
+        // source may change its layout in response to written
+        // data: keep persistent indexes for the time of commit
+        std::vector<std::pair<QPersistentModelIndex, CellValues>> changes;
+        changes.reserve(d->journal.size());
+        for (auto it = d->journal.cbegin(); it != d->journal.cend(); ++it)
+            changes.emplace_back(QPersistentModelIndex(d->sourceIndex(model, it->first)), it->second);
+        d->clear();
+
+        // cells rejected by the source model stay in the journal
+        for (auto it = changes.cbegin(); it != changes.cend(); ++it) {
+            const QModelIndex index = it->first;
+            if (index.isValid() && !model->setItemData(index, it->second))
+                d->journal[CellKey(d->parentId(index.parent()), index.row(), index.column())] = it->second;
+        }
+        if (!d->journal.empty())
+            return false;
+    }
+
     Q_EMIT accepted();
     return true;
 }
@@ -84,11 +479,55 @@ bool QtRevertibleProxyModel::submit()
 void QtRevertibleProxyModel::revert()
 {
     Q_D(QtRevertibleProxyModel);
-    d->revertModel(sourceModel());
-    d->cache.clear();
+
+    std::vector<CellKey> cells;
+    cells.reserve(d->journal.size());
+    for (auto it = d->journal.cbegin(); it != d->journal.cend(); ++it)
+        cells.push_back(it->first);
+
+    d->journal.clear();
+    d->clearHistory();
+    d->notify(this, cells);
+    d->clearParents();
     Q_EMIT rejected();
 }
 
+void QtRevertibleProxyModel::onSourceAboutToBeChanged()
+{
+    Q_D(QtRevertibleProxyModel);
+    if (!d->moving.empty())
+        return;
+
+    // parents table is keyed by plain indexes, which are
+    // not valid after the change: nothing to remap, drop it
+    if (d->journal.empty()) {
+        d->clear();
+        return;
+    }
+
+    // cell positions may change: keep persistent indexes
+    // of journaled cells for the time of the change only
+    const QAbstractItemModel* model = sourceModel();
+    d->moving.reserve(d->journal.size());
+    for (auto it = d->journal.cbegin(); it != d->journal.cend(); ++it)
+        d->moving.emplace_back(QPersistentModelIndex(d->sourceIndex(model, it->first)), it->second);
+}
+
+void QtRevertibleProxyModel::onSourceChanged()
+{
+    Q_D(QtRevertibleProxyModel);
+    if (d->moving.empty())
+        return;
+
+    d->clear();
+    for (auto it = d->moving.cbegin(); it != d->moving.cend(); ++it) {
+        const QModelIndex index = it->first;
+        if (index.isValid())
+            d->journal[CellKey(d->parentId(index.parent()), index.row(), index.column())] = it->second;
+    }
+    d->moving.clear();
+}
+
 bool QtRevertibleProxyModel::insertRows(int row, int count, const QModelIndex &parent)
 {
     if (hasUncommitedChanges())
@@ -116,4 +555,3 @@ bool QtRevertibleProxyModel::removeColumns(int column, int count, const QModelIn
         return false;
     return QIdentityProxyModel::removeColumns(column, count, parent);
 }
-
@@ -2,8 +2,37 @@
 #define QTREVERTIBLEPROXYMODEL_H
 
 #include <QIdentityProxyModel>
+#include <QVector>
+#include <QMap>
 #include <QtWidgetsExtra>
 
+#include <functional>
+
+/*!
+ * \brief The QtRevertibleProxyModel class
+ *
+ * Identity proxy that keeps edits in its own change journal
+ * instead of writing them to the source model. Journal is
+ * ordered by (parent, row, column) and keeps only the last
+ * written value of every (cell, role); edited values are
+ * shown on top of the source data until submit() writes them
+ * to the source with single setItemData() call per cell (or
+ * through commit hook, if it is set), or revert() drops them
+ * with ranged dataChanged() signals.
+ *
+ * Every edit is also recorded in the edit log: checkpoint()
+ * marks current state, undo() and redo() move between the
+ * marked states. Undo history is cleared on structural
+ * changes of the source model.
+ *
+ * setData() accepts any value for editable items and never
+ * asks the source model: values are checked by the source
+ * only when submit() writes them. Cells rejected by the
+ * source stay in the journal and submit() returns false.
+ *
+ * \note values written with Qt::EditRole are also shown for
+ * Qt::DisplayRole and vice versa
+ */
 class QTWIDGETSEXTRA_EXPORT QtRevertibleProxyModel :
         public QIdentityProxyModel
 {
@@ -13,6 +42,14 @@ class QTWIDGETSEXTRA_EXPORT QtRevertibleProxyModel :
     Q_DISABLE_COPY(QtRevertibleProxyModel)
 
 public:
+    struct Change
+    {
+        QModelIndex index; // source index
+        QMap<int, QVariant> values;
+    };
+    typedef QVector<Change> ChangeList;
+    typedef std::function<bool(QAbstractItemModel*, const ChangeList&)> CommitHook;
+
     explicit QtRevertibleProxyModel(QObject *parent = Q_NULLPTR);
     virtual ~QtRevertibleProxyModel();
 
@@ -20,6 +57,16 @@ public:
 
     int cacheSize() const;
 
+    void setCommitHook(const CommitHook& hook);
+    CommitHook commitHook() const;
+
+    int checkpoint();
+    bool canUndo() const;
+    bool canRedo() const;
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const Q_DECL_OVERRIDE;
+    QMap<int, QVariant> itemData(const QModelIndex &index) const Q_DECL_OVERRIDE;
+
     // Editable:
     bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) Q_DECL_OVERRIDE;
 
@@ -39,11 +86,18 @@ public Q_SLOTS:
     virtual bool submit() Q_DECL_OVERRIDE;
     virtual void revert() Q_DECL_OVERRIDE;
 
+    void undo();
+    void redo();
+
 Q_SIGNALS:
     void changesCached(const QModelIndex&, int);
     void accepted();
     void rejected();
 
+private Q_SLOTS:
+    void onSourceAboutToBeChanged();
+    void onSourceChanged();
+
 private:
     QT_PIMPL(QtRevertibleProxyModel)
 };
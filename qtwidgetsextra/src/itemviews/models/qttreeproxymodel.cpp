@@ -1,64 +1,774 @@
 #include <vector>
+#include <memory>
+#include <functional>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
 #include <QPointer>
+#include <QTimer>
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QDateTime>
 
 #include "qttreeproxymodel.h"
 
 namespace
 {
 
-struct Group
+// QVariant::operator== compares values with type conversion
+// (QVariant(true) == QVariant(1)), which can not be matched by
+// any hash function: group keys are equal only if they have the
+// same type and equal values, and hash includes the type
+struct VariantEqual
+{
+    bool operator()(const QVariant& x, const QVariant& y) const {
+        return (x.userType() == y.userType() && x == y);
+    }
+};
+
+struct VariantHash
+{
+    size_t operator()(const QVariant& value) const {
+        const uint type = static_cast<uint>(value.userType());
+        switch (value.userType())
+        {
+        case QMetaType::Bool:
+        case QMetaType::Char:
+        case QMetaType::SChar:
+        case QMetaType::UChar:
+        case QMetaType::Short:
+        case QMetaType::UShort:
+        case QMetaType::Int:
+        case QMetaType::UInt:
+        case QMetaType::Long:
+        case QMetaType::ULong:
+        case QMetaType::LongLong:
+        case QMetaType::ULongLong:
+            return qHash(value.toLongLong(), type);
+        case QMetaType::Float:
+        case QMetaType::Double:
+            return qHash(value.toDouble(), type); // 0.0 and -0.0 hash equally
+        case QMetaType::QString:
+            return qHash(value.toString(), type);
+        case QMetaType::QByteArray:
+            return qHash(value.toByteArray(), type);
+        case QMetaType::QChar:
+            return qHash(value.toChar().unicode(), type);
+        case QMetaType::QDate:
+            return qHash(value.toDate().toJulianDay(), type);
+        case QMetaType::QTime:
+            return qHash(value.toTime().msecsSinceStartOfDay(), type);
+        case QMetaType::QDateTime:
+            // equal date-times may differ in time spec
+            return qHash(value.toDateTime().toMSecsSinceEpoch(), type);
+        default:
+            break;
+        }
+        // no hash that is known to agree with operator== for
+        // other types (maps, lists, custom types): share the bucket
+        return type;
+    }
+};
+
+struct Node;
+typedef std::unordered_map<QVariant, Node*, VariantHash, VariantEqual> NodeIndex;
+
+struct Node
 {
     QVariant key;
-    int childCount;
+    Node* parent;
+    int pos;                       // row of the node in its parent
+    int level;                     // 0 for root, depth for leaf groups
+    int firstRow;                  // first source row of the group
+    int count;                     // number of source rows in subtree
+    std::vector<Node*> children;   // nested groups
+    NodeIndex index;               // group key -> nested group
+    mutable std::vector<int> rows; // source rows in ascending order (leaf groups only)
 
-    Group(const QVariant& k)  : key(k), childCount(1) {}
+    Node(const QVariant& k, Node* p, int row)
+        : key(k), parent(p), pos(0), level(p ? p->level + 1 : 0), firstRow(row), count(0)
+    {}
 
-    bool operator ==(const QVariant& value) {
-        return key == value;
+    ~Node() {
+        qDeleteAll(children);
     }
 
-    bool operator !=(const QVariant& value) {
-        return key != value;
+    inline Node* find(const QVariant& k) const {
+        auto it = index.find(k);
+        return (it != index.end() ? it->second : Q_NULLPTR);
+    }
+
+    Node* append(const QVariant& k, int row) {
+        Node* node = new Node(k, this, row);
+        node->pos = static_cast<int>(children.size());
+        children.push_back(node);
+        index.emplace(k, node);
+        return node;
+    }
+
+    void renumber(int from = 0) {
+        for (int i = from, n = static_cast<int>(children.size()); i < n; ++i)
+            children[i]->pos = i;
+    }
+
+    // position of the first child mapped to source row >= sourceRow
+    int indexOf(int sourceRow) const {
+        return static_cast<int>(std::lower_bound(rows.begin(), rows.end(), sourceRow) - rows.begin());
     }
 };
 
+// Result of full grouping pass
+struct Grouping
+{
+    std::unique_ptr<Node> root;
+    std::vector<Node*> rowLeaves;
+};
+
+class GroupingTask : public QRunnable
+{
+public:
+    explicit GroupingTask(const std::function<void()>& f) : func(f) {}
+    void run() Q_DECL_OVERRIDE { func(); }
+private:
+    std::function<void()> func;
+};
+
+// Pending group changes above this count are applied
+// as single layout change instead of separate row moves
+static const int MaxMoveCount = 64;
+
 }
 
 class QtTreeProxyModelPrivate
 {
 public:
+    Q_DECLARE_PUBLIC(QtTreeProxyModel)
+
+    QtTreeProxyModel* q_ptr;
     QPointer<QAbstractItemModel> model;
-    std::vector<Group> groups;
-    int groupColumn, groupRole;
+    QVector<QtTreeProxyModel::GroupLevel> levels;
+    std::unique_ptr<Node> root;
+    mutable std::vector<Node*> rowLeaves; // source row -> leaf group
+    std::vector<int> pending;             // source rows with (possibly) changed group keys
+    std::unordered_set<Node*> resized;    // groups with changed size since last notification
+    int parallelThreshold;
+    QtTreeProxyModel::CachingPolicy policy;
+    mutable bool rowsMapped;
+    bool flushScheduled;
 
-    QtTreeProxyModelPrivate()
-        : model(0)
-        , groupColumn(0)
-        , groupRole(Qt::DisplayRole)
-    {}
+    QtTreeProxyModelPrivate(QtTreeProxyModel* q)
+        : q_ptr(q)
+        , model(0)
+        , root(new Node(QVariant(), Q_NULLPTR, 0))
+        , parallelThreshold(100000)
+        , policy(QtTreeProxyModel::CachingPolicy::CacheIndexes)
+        , rowsMapped(false)
+        , flushScheduled(false)
+    {
+        levels.push_back(QtTreeProxyModel::GroupLevel(0, Qt::DisplayRole));
+    }
+
+    inline int depth() const
+    {
+        return levels.size();
+    }
+
+    inline bool isLeaf(const Node* node) const
+    {
+        return (node->level == depth());
+    }
+
+    inline bool isIncremental() const
+    {
+        return (policy == QtTreeProxyModel::CachingPolicy::CacheIndexes);
+    }
+
+    inline QVariant groupKey(int sourceRow, int level) const
+    {
+        return model->index(sourceRow, levels[level].first).data(levels[level].second);
+    }
+
+    inline QVector<QVariant> groupKeys(int sourceRow) const
+    {
+        QVector<QVariant> keys(depth());
+        for (int i = 0; i < keys.size(); ++i)
+            keys[i] = groupKey(sourceRow, i);
+        return keys;
+    }
+
+    // Existing leaf group for the keys or null
+    Node* findLeaf(const QVector<QVariant>& keys) const
+    {
+        Node* node = root.get();
+        for (int i = 0; node && i < keys.size(); ++i)
+            node = node->find(keys[i]);
+        return node;
+    }
+
+    inline QModelIndex indexOf(const Node* node) const
+    {
+        return (node == root.get() ? QModelIndex() : q_ptr->createIndex(node->pos, 0, node->parent));
+    }
+
+    void clear()
+    {
+        root.reset(new Node(QVariant(), Q_NULLPTR, 0));
+        rowLeaves.clear();
+        pending.clear();
+        resized.clear();
+        rowsMapped = false;
+    }
+
+    inline void addCount(Node* node, int delta)
+    {
+        for (; node; node = node->parent) {
+            node->count += delta;
+            resized.insert(node);
+        }
+    }
+
+    void destroy(Node* node)
+    {
+        std::vector<Node*> stack(1, node);
+        while (!stack.empty()) {
+            Node* n = stack.back();
+            stack.pop_back();
+            resized.erase(n);
+            stack.insert(stack.end(), n->children.begin(), n->children.end());
+        }
+        delete node;
+    }
+
+    // Notify views about changed group sizes
+    void notifyResized()
+    {
+        Q_Q(QtTreeProxyModel);
+        const int lastColumn = q->columnCount(QModelIndex()) - 1;
+        for (auto it = resized.begin(); it != resized.end(); ++it)
+        {
+            Node* node = *it;
+            if (node == root.get() || lastColumn < 0)
+                continue;
+            Q_EMIT q->dataChanged(q->createIndex(node->pos, 0, node->parent),
+                                  q->createIndex(node->pos, lastColumn, node->parent),
+                                  QVector<int>() << QtTreeProxyModel::GroupSizeRole);
+        }
+        resized.clear();
+    }
+
+    // Group rows of key snapshot; keys are stored row by row, 'depth' keys per row
+    static void groupRange(Node* root, std::vector<Node*>& rowLeaves,
+                           const std::vector<QVariant>& keys, int depth, bool mapRows,
+                           const std::vector<int>* parts, int part)
+    {
+        const int n = static_cast<int>(keys.size()) / depth;
+        for (int i = 0; i < n; ++i)
+        {
+            if (parts && (*parts)[i] != part)
+                continue;
+
+            const QVariant* k = keys.data() + i * depth;
+            Node* node = root;
+            ++node->count;
+            for (int l = 0; l < depth; ++l) {
+                Node* child = node->find(k[l]);
+                node = (child ? child : node->append(k[l], i));
+                ++node->count;
+            }
+            if (mapRows) {
+                node->rows.push_back(i);
+                rowLeaves[i] = node;
+            }
+        }
+    }
 
-    int sourceRowForGroup(const QVariant& key, int expectedSourceRow) const
+    // Full grouping pass; does not touch the current groups
+    Grouping build() const
     {
-        // Scan the source model and find row number in it
-        // that corresponds with parent group key
-        for (int i = 0, k = 0; i < model->rowCount(); ++i)
+        Grouping result;
+        result.root.reset(new Node(QVariant(), Q_NULLPTR, 0));
+        if (!model)
+            return result;
+
+        const int n = model->rowCount();
+        const int d = depth();
+        const bool mapRows = isIncremental();
+        if (mapRows)
+            result.rowLeaves.assign(n, Q_NULLPTR);
+
+        // snapshot key columns: the source model is accessible from its own thread only
+        std::vector<QVariant> keys(static_cast<size_t>(n) * d);
+        for (int i = 0; i < n; ++i)
+            for (int l = 0; l < d; ++l)
+                keys[static_cast<size_t>(i) * d + l] = groupKey(i, l);
+
+        const int threads = QThread::idealThreadCount();
+        if (parallelThreshold <= 0 || n < parallelThreshold || threads < 2) {
+            groupRange(result.root.get(), result.rowLeaves, keys, d, mapRows, Q_NULLPTR, 0);
+            return result;
+        }
+
+        QThreadPool pool;
+        pool.setMaxThreadCount(threads);
+
+        // partition rows by hash of top-level key, so that
+        // every top-level group is built by exactly one task
+        std::vector<int> parts(n);
+        const int chunk = (n + threads - 1) / threads;
+        for (int t = 0; t < threads; ++t) {
+            const int first = t * chunk, last = qMin(n, first + chunk);
+            pool.start(new GroupingTask([&keys, &parts, first, last, d, threads]() {
+                VariantHash hash;
+                for (int i = first; i < last; ++i)
+                    parts[i] = static_cast<int>(hash(keys[static_cast<size_t>(i) * d]) % threads);
+            }));
+        }
+        pool.waitForDone();
+
+        std::vector<std::unique_ptr<Node>> roots;
+        for (int t = 0; t < threads; ++t) {
+            roots.emplace_back(new Node(QVariant(), Q_NULLPTR, 0));
+            Node* partRoot = roots.back().get();
+            pool.start(new GroupingTask([&keys, &parts, &result, partRoot, t, d, mapRows]() {
+                groupRange(partRoot, result.rowLeaves, keys, d, mapRows, &parts, t);
+            }));
+        }
+        pool.waitForDone();
+
+        // merge top-level groups in order of their first appearance
+        Node* top = result.root.get();
+        for (auto it = roots.begin(); it != roots.end(); ++it) {
+            for (auto c = (*it)->children.begin(); c != (*it)->children.end(); ++c) {
+                (*c)->parent = top;
+                top->children.push_back(*c);
+                top->index.emplace((*c)->key, *c);
+            }
+            top->count += (*it)->count;
+            (*it)->children.clear();
+        }
+        std::sort(top->children.begin(), top->children.end(),
+                  [](const Node* x, const Node* y) { return x->firstRow < y->firstRow; });
+        top->renumber();
+        return result;
+    }
+
+    void apply(Grouping& grouping)
+    {
+        clear();
+        root = std::move(grouping.root);
+        rowLeaves.swap(grouping.rowLeaves);
+        rowsMapped = isIncremental();
+    }
+
+    // Build group-to-source row maps in one pass (lazy mode)
+    void mapRows() const
+    {
+        if (rowsMapped)
+            return;
+
+        std::vector<Node*> stack(1, root.get());
+        while (!stack.empty()) {
+            Node* node = stack.back();
+            stack.pop_back();
+            node->rows.clear();
+            if (isLeaf(node))
+                node->rows.reserve(node->count);
+            stack.insert(stack.end(), node->children.begin(), node->children.end());
+        }
+
+        const int n = model->rowCount();
+        rowLeaves.assign(n, Q_NULLPTR);
+        for (int i = 0; i < n; ++i)
         {
-            const QVariant value = model->index(i, groupColumn).data(groupRole);
-            if (value == key)
+            Node* leaf = findLeaf(groupKeys(i));
+            if (leaf) {
+                leaf->rows.push_back(i);
+                rowLeaves[i] = leaf;
+            }
+        }
+        rowsMapped = true;
+    }
+
+    void releaseRows()
+    {
+        std::vector<Node*> stack(1, root.get());
+        while (!stack.empty()) {
+            Node* node = stack.back();
+            stack.pop_back();
+            std::vector<int>().swap(node->rows);
+            stack.insert(stack.end(), node->children.begin(), node->children.end());
+        }
+        std::vector<Node*>().swap(rowLeaves);
+        rowsMapped = false;
+    }
+
+    int sourceRow(const Node* leaf, int child) const
+    {
+        mapRows();
+        const std::vector<int>& rows = leaf->rows;
+        return (child >= 0 && child < static_cast<int>(rows.size()) ? rows[child] : -1);
+    }
+
+    template<class _Fn>
+    void forEachLeaf(_Fn fn)
+    {
+        std::vector<Node*> stack(1, root.get());
+        while (!stack.empty()) {
+            Node* node = stack.back();
+            stack.pop_back();
+            if (isLeaf(node))
+                fn(node);
+            else
+                stack.insert(stack.end(), node->children.begin(), node->children.end());
+        }
+    }
+
+    // Remove groups with their subtrees; groups must be detached from source rows
+    void removeNodes(std::vector<Node*>& list)
+    {
+        Q_Q(QtTreeProxyModel);
+        std::sort(list.begin(), list.end(), [](const Node* x, const Node* y) {
+            return (x->parent != y->parent ? std::less<Node*>()(x->parent, y->parent) : x->pos > y->pos);
+        });
+        for (auto it = list.begin(); it != list.end();)
+        {
+            // collect contiguous run of siblings [first, last]
+            Node* parent = (*it)->parent;
+            const int last = (*it)->pos;
+            int first = last;
+            auto next = it + 1;
+            for (; next != list.end() && (*next)->parent == parent && (*next)->pos == first - 1; ++next)
+                --first;
+
+            int count = 0;
+            q->beginRemoveRows(indexOf(parent), first, last);
+            for (int i = first; i <= last; ++i) {
+                Node* node = parent->children[i];
+                count += node->count;
+                parent->index.erase(node->key);
+                destroy(node);
+            }
+            parent->children.erase(parent->children.begin() + first, parent->children.begin() + last + 1);
+            parent->renumber(first);
+            addCount(parent, -count);
+            q->endRemoveRows();
+            it = next;
+        }
+    }
+
+    // Source rows [first, last] were inserted
+    void insertRows(int first, int last)
+    {
+        Q_Q(QtTreeProxyModel);
+        const int count = last - first + 1;
+
+        // shift mapping of existing rows, proxy rows stay the same
+        forEachLeaf([first, count](Node* leaf) {
+            for (auto r = leaf->rows.begin(); r != leaf->rows.end(); ++r)
+                if (*r >= first)
+                    *r += count;
+        });
+        rowLeaves.insert(rowLeaves.begin() + first, count, Q_NULLPTR);
+
+        std::unordered_map<Node*, std::vector<int>> children;
+        std::vector<Node*> touched;  // visible leaf groups in order of appearance
+        std::unordered_map<Node*, std::vector<Node*>> created; // visible parent -> new groups
+        std::vector<Node*> parents;  // visible parents in order of appearance
+        std::unordered_set<Node*> hidden; // topmost new groups, not yet visible
+        for (int i = first; i <= last; ++i)
+        {
+            Node* node = root.get();
+            bool visible = true;
+            for (int l = 0; l < depth(); ++l)
             {
-                if (k == expectedSourceRow)
-                    return i;
-                ++k;
+                const QVariant key = groupKey(i, l);
+                Node* child = node->find(key);
+                if (!child && visible) {
+                    child = new Node(key, node, i);
+                    node->index.emplace(key, child);
+                    std::vector<Node*>& list = created[node];
+                    if (list.empty())
+                        parents.push_back(node);
+                    child->pos = static_cast<int>(node->children.size() + list.size());
+                    list.push_back(child);
+                    hidden.insert(child);
+                } else if (!child) {
+                    child = node->append(key, i);
+                }
+                if (visible && hidden.count(child))
+                    visible = false;
+                if (!visible)
+                    ++child->count; // hidden subtree is counted right away
+                node = child;
+            }
+            rowLeaves[i] = node;
+            if (!visible) {
+                node->rows.push_back(i);
+                continue;
+            }
+            std::vector<int>& rows = children[node];
+            if (rows.empty())
+                touched.push_back(node);
+            rows.push_back(i);
+        }
+
+        // new children of the same group are always
+        // contiguous since rows after 'first' were shifted
+        for (auto it = touched.begin(); it != touched.end(); ++it)
+        {
+            Node* leaf = *it;
+            const std::vector<int>& rows = children[leaf];
+            const int pos = leaf->indexOf(first);
+            q->beginInsertRows(indexOf(leaf), pos, pos + static_cast<int>(rows.size()) - 1);
+            leaf->rows.insert(leaf->rows.begin() + pos, rows.begin(), rows.end());
+            addCount(leaf, static_cast<int>(rows.size()));
+            q->endInsertRows();
+        }
+
+        for (auto it = parents.begin(); it != parents.end(); ++it)
+        {
+            Node* parent = *it;
+            const std::vector<Node*>& list = created[parent];
+            const int pos = static_cast<int>(parent->children.size());
+            int count = 0;
+            q->beginInsertRows(indexOf(parent), pos, pos + static_cast<int>(list.size()) - 1);
+            for (auto c = list.begin(); c != list.end(); ++c) {
+                parent->children.push_back(*c);
+                count += (*c)->count;
+            }
+            addCount(parent, count);
+            q->endInsertRows();
+        }
+        notifyResized();
+    }
+
+    // Source rows [first, last] are about to be removed
+    void removeRows(int first, int last)
+    {
+        Q_Q(QtTreeProxyModel);
+        std::unordered_map<Node*, int> removed; // group -> number of removed rows in subtree
+        std::vector<Node*> touched;
+        for (int i = first; i <= last; ++i)
+        {
+            Node* leaf = rowLeaves[i];
+            if (removed[leaf] == 0)
+                touched.push_back(leaf);
+            for (Node* node = leaf; node != root.get(); node = node->parent)
+                ++removed[node];
+        }
+
+        // decide first, then modify: find topmost groups emptied by removal
+        std::vector<Node*> partial, emptied;
+        std::unordered_set<Node*> seen;
+        for (auto it = touched.begin(); it != touched.end(); ++it)
+        {
+            Node* top = *it;
+            if (removed[top] < top->count) {
+                partial.push_back(top);
+                continue;
+            }
+            while (top->parent != root.get() && removed[top->parent] == top->parent->count)
+                top = top->parent;
+            if (seen.insert(top).second)
+                emptied.push_back(top);
+        }
+
+        for (auto it = partial.begin(); it != partial.end(); ++it)
+        {
+            Node* leaf = *it;
+            const int count = removed[leaf];
+            const int pos = leaf->indexOf(first);
+            q->beginRemoveRows(indexOf(leaf), pos, pos + count - 1);
+            leaf->rows.erase(leaf->rows.begin() + pos, leaf->rows.begin() + pos + count);
+            addCount(leaf, -count);
+            q->endRemoveRows();
+        }
+        removeNodes(emptied);
+        notifyResized();
+    }
+
+    // Source rows [first, last] were removed
+    void shiftRows(int first, int last)
+    {
+        const int count = last - first + 1;
+        rowLeaves.erase(rowLeaves.begin() + first, rowLeaves.begin() + last + 1);
+        forEachLeaf([last, count](Node* leaf) {
+            for (auto r = leaf->rows.begin(); r != leaf->rows.end(); ++r)
+                if (*r > last)
+                    *r -= count;
+        });
+    }
+
+    void scheduleFlush()
+    {
+        if (flushScheduled)
+            return;
+        flushScheduled = true;
+        QTimer::singleShot(0, q_ptr, [this]() { flushPending(); });
+    }
+
+    // Move rows with changed group keys into their new groups
+    void flushPending()
+    {
+        flushScheduled = false;
+        if (pending.empty())
+            return;
+
+        std::sort(pending.begin(), pending.end());
+        pending.erase(std::unique(pending.begin(), pending.end()), pending.end());
+
+        std::vector<std::pair<int, QVector<QVariant>>> moves;
+        const int n = static_cast<int>(rowLeaves.size());
+        for (auto it = pending.begin(); it != pending.end(); ++it)
+        {
+            if (*it >= n)
+                continue;
+            QVector<QVariant> keys = groupKeys(*it);
+            if (findLeaf(keys) != rowLeaves[*it])
+                moves.emplace_back(*it, std::move(keys));
+        }
+        pending.clear();
+
+        if (moves.size() > static_cast<size_t>(MaxMoveCount))
+            relayout(moves);
+        else
+            for (auto it = moves.begin(); it != moves.end(); ++it)
+                moveRow(it->first, it->second);
+        notifyResized();
+    }
+
+    void moveRow(int sourceRow, const QVector<QVariant>& keys)
+    {
+        Q_Q(QtTreeProxyModel);
+        Node* from = rowLeaves[sourceRow];
+
+        // find target leaf, create missing groups as one inserted subtree
+        Node* to = root.get();
+        int l = 0;
+        for (; l < keys.size(); ++l) {
+            Node* child = to->find(keys[l]);
+            if (!child)
+                break;
+            to = child;
+        }
+        if (l < keys.size()) {
+            const int pos = static_cast<int>(to->children.size());
+            q->beginInsertRows(indexOf(to), pos, pos);
+            for (; l < keys.size(); ++l)
+                to = to->append(keys[l], sourceRow);
+            q->endInsertRows();
+        }
+
+        const int fromPos = from->indexOf(sourceRow);
+        const int toPos = to->indexOf(sourceRow);
+        q->beginMoveRows(indexOf(from), fromPos, fromPos, indexOf(to), toPos);
+        from->rows.erase(from->rows.begin() + fromPos);
+        addCount(from, -1);
+        to->rows.insert(to->rows.begin() + toPos, sourceRow);
+        addCount(to, 1);
+        rowLeaves[sourceRow] = to;
+        q->endMoveRows();
+
+        if (from->count == 0) {
+            Node* top = from;
+            while (top->parent != root.get() && top->parent->count == 0)
+                top = top->parent;
+            std::vector<Node*> emptied(1, top);
+            removeNodes(emptied);
+        }
+    }
+
+    // Detach empty groups, keeping them alive in 'dead'
+    void prune(Node* node, std::vector<Node*>& dead)
+    {
+        auto last = std::stable_partition(node->children.begin(), node->children.end(),
+                                          [](const Node* n) { return n->count > 0; });
+        for (auto it = last; it != node->children.end(); ++it) {
+            node->index.erase((*it)->key);
+            dead.push_back(*it);
+        }
+        node->children.erase(last, node->children.end());
+        node->renumber();
+        for (auto it = node->children.begin(); it != node->children.end(); ++it)
+            prune(*it, dead);
+    }
+
+    // Apply large batch of moves as single layout change
+    void relayout(const std::vector<std::pair<int, QVector<QVariant>>>& moves)
+    {
+        Q_Q(QtTreeProxyModel);
+        Q_EMIT q->layoutAboutToBeChanged();
+
+        // remember what every persistent index refers to:
+        // group for group items, source row for children
+        const QModelIndexList from = q->persistentIndexList();
+        std::vector<std::pair<Node*, int>> anchors;
+        anchors.reserve(from.size());
+        for (auto it = from.cbegin(); it != from.cend(); ++it) {
+            const Node* owner = reinterpret_cast<const Node*>(it->internalId());
+            if (isLeaf(owner))
+                anchors.emplace_back(Q_NULLPTR, owner->rows[it->row()]);
+            else
+                anchors.emplace_back(owner->children[it->row()], -1);
+        }
+
+        for (auto it = moves.begin(); it != moves.end(); ++it)
+        {
+            const int row = it->first;
+            Node* source = rowLeaves[row];
+            source->rows.erase(source->rows.begin() + source->indexOf(row));
+            addCount(source, -1);
+
+            Node* target = root.get();
+            for (auto k = it->second.begin(); k != it->second.end(); ++k) {
+                Node* child = target->find(*k);
+                target = (child ? child : target->append(*k, row));
+            }
+            target->rows.insert(target->rows.begin() + target->indexOf(row), row);
+            addCount(target, 1);
+            rowLeaves[row] = target;
+        }
+
+        // drop emptied groups, but keep them alive until persistent indexes are updated
+        std::vector<Node*> dead;
+        prune(root.get(), dead);
+        std::unordered_set<const Node*> gone;
+        for (auto it = dead.begin(); it != dead.end(); ++it) {
+            std::vector<Node*> stack(1, *it);
+            while (!stack.empty()) {
+                Node* n = stack.back();
+                stack.pop_back();
+                gone.insert(n);
+                resized.erase(n);
+                stack.insert(stack.end(), n->children.begin(), n->children.end());
             }
         }
-        return -1;
+
+        QModelIndexList to;
+        to.reserve(from.size());
+        for (int i = 0, n = from.size(); i < n; ++i)
+        {
+            const int column = from[i].column();
+            const Node* node = anchors[i].first;
+            if (node) {
+                to.push_back(gone.count(node) ? QModelIndex() : q->createIndex(node->pos, column, node->parent));
+            } else {
+                Node* leaf = rowLeaves[anchors[i].second];
+                to.push_back(q->createIndex(leaf->indexOf(anchors[i].second), column, leaf));
+            }
+        }
+        q->changePersistentIndexList(from, to);
+        qDeleteAll(dead);
+
+        Q_EMIT q->layoutChanged();
     }
 };
 
 
 QtTreeProxyModel::QtTreeProxyModel(QObject* parent)
     : QAbstractItemModel(parent)
-    , d_ptr(new QtTreeProxyModelPrivate)
+    , d_ptr(new QtTreeProxyModelPrivate(this))
 {
 }
 
@@ -72,13 +782,16 @@ void QtTreeProxyModel::setSourceModel(QAbstractItemModel *model)
     if (d->model == model)
         return;
 
-    beginResetModel();
-
     if (d->model)
     {
+        disconnect(d->model, &QAbstractItemModel::rowsAboutToBeInserted, this, &QtTreeProxyModel::onSourceRowsAboutToBeInserted);
         disconnect(d->model, &QAbstractItemModel::rowsInserted, this, &QtTreeProxyModel::onSourceRowsInserted);
+        disconnect(d->model, &QAbstractItemModel::rowsAboutToBeRemoved, this, &QtTreeProxyModel::onSourceRowsAboutToBeRemoved);
         disconnect(d->model, &QAbstractItemModel::rowsRemoved, this, &QtTreeProxyModel::onSourceRowsRemoved);
         disconnect(d->model, &QAbstractItemModel::dataChanged, this, &QtTreeProxyModel::onSourceDataChanged);
+        disconnect(d->model, &QAbstractItemModel::modelReset, this, &QtTreeProxyModel::onSourceReset);
+        disconnect(d->model, &QAbstractItemModel::layoutChanged, this, &QtTreeProxyModel::onSourceLayoutChanged);
+        disconnect(d->model, &QAbstractItemModel::rowsMoved, this, &QtTreeProxyModel::onSourceLayoutChanged);
         disconnect(d->model, &QAbstractItemModel::destroyed, this, &QtTreeProxyModel::onSourceDestroyed);
     }
 
@@ -86,15 +799,18 @@ void QtTreeProxyModel::setSourceModel(QAbstractItemModel *model)
 
     if (d->model)
     {
+        connect(d->model, &QAbstractItemModel::rowsAboutToBeInserted, this, &QtTreeProxyModel::onSourceRowsAboutToBeInserted);
         connect(d->model, &QAbstractItemModel::rowsInserted, this, &QtTreeProxyModel::onSourceRowsInserted);
+        connect(d->model, &QAbstractItemModel::rowsAboutToBeRemoved, this, &QtTreeProxyModel::onSourceRowsAboutToBeRemoved);
         connect(d->model, &QAbstractItemModel::rowsRemoved, this, &QtTreeProxyModel::onSourceRowsRemoved);
         connect(d->model, &QAbstractItemModel::dataChanged, this, &QtTreeProxyModel::onSourceDataChanged);
+        connect(d->model, &QAbstractItemModel::modelReset, this, &QtTreeProxyModel::onSourceReset);
+        connect(d->model, &QAbstractItemModel::layoutChanged, this, &QtTreeProxyModel::onSourceLayoutChanged);
+        connect(d->model, &QAbstractItemModel::rowsMoved, this, &QtTreeProxyModel::onSourceLayoutChanged);
         connect(d->model, &QAbstractItemModel::destroyed, this, &QtTreeProxyModel::onSourceDestroyed);
     }
 
     onSourceReset(); // update our groups
-
-    endResetModel();
 }
 
 QAbstractItemModel *QtTreeProxyModel::sourceModel() const
@@ -105,17 +821,37 @@ QAbstractItemModel *QtTreeProxyModel::sourceModel() const
 
 void QtTreeProxyModel::setGroupping(int column, int role)
 {
-    setGroupColumn(column);
-    setGroupNameRole(role);
+    setGroupLevels(QVector<GroupLevel>() << GroupLevel(column, role));
+}
+
+void QtTreeProxyModel::setGroupLevels(const QVector<GroupLevel> &levels)
+{
+    Q_D(QtTreeProxyModel);
+    if (levels.isEmpty() || d->levels == levels)
+        return;
+
+    const GroupLevel previous = d->levels.front();
+    d->levels = levels;
+    onSourceReset();
+    if (previous.first != levels.front().first)
+        Q_EMIT groupColumnChanged(levels.front().first);
+    if (previous.second != levels.front().second)
+        Q_EMIT groupNameRoleChanged(levels.front().second);
+}
+
+QVector<QtTreeProxyModel::GroupLevel> QtTreeProxyModel::groupLevels() const
+{
+    Q_D(const QtTreeProxyModel);
+    return d->levels;
 }
 
 void QtTreeProxyModel::setGroupColumn(int column)
 {
     Q_D(QtTreeProxyModel);
-    if (d->groupColumn == column)
+    if (d->levels.front().first == column)
         return;
 
-    d->groupColumn = column;
+    d->levels.front().first = column;
     onSourceReset();
     Q_EMIT groupColumnChanged(column);
 }
@@ -123,16 +859,16 @@ void QtTreeProxyModel::setGroupColumn(int column)
 int QtTreeProxyModel::groupColumn() const
 {
     Q_D(const QtTreeProxyModel);
-    return d->groupColumn;
+    return d->levels.front().first;
 }
 
 void QtTreeProxyModel::setGroupNameRole(int role)
 {
     Q_D(QtTreeProxyModel);
-    if (d->groupRole == role)
+    if (d->levels.front().second == role)
         return;
 
-    d->groupRole = role;
+    d->levels.front().second = role;
     onSourceReset();
     Q_EMIT groupNameRoleChanged(role);
 }
@@ -140,45 +876,115 @@ void QtTreeProxyModel::setGroupNameRole(int role)
 int QtTreeProxyModel::groupNameRole() const
 {
     Q_D(const QtTreeProxyModel);
-    return d->groupRole;
+    return d->levels.front().second;
+}
+
+void QtTreeProxyModel::setCachingPolicy(QtTreeProxyModel::CachingPolicy policy)
+{
+    Q_D(QtTreeProxyModel);
+    if (d->policy == policy)
+        return;
+
+    d->flushPending();
+    d->policy = policy;
+    if (d->policy == CachingPolicy::NoCaching)
+        d->releaseRows();
+    else if (d->model)
+        d->mapRows();
+}
+
+QtTreeProxyModel::CachingPolicy QtTreeProxyModel::cachingPolicy() const
+{
+    Q_D(const QtTreeProxyModel);
+    return d->policy;
+}
+
+void QtTreeProxyModel::setParallelThreshold(int rowCount)
+{
+    Q_D(QtTreeProxyModel);
+    d->parallelThreshold = rowCount;
+}
+
+int QtTreeProxyModel::parallelThreshold() const
+{
+    Q_D(const QtTreeProxyModel);
+    return d->parallelThreshold;
+}
+
+int QtTreeProxyModel::groupSize(const QModelIndex &index) const
+{
+    Q_D(const QtTreeProxyModel);
+    if (!index.isValid())
+        return d->root->count;
+
+    const Node* owner = reinterpret_cast<const Node*>(index.internalId());
+    return (d->isLeaf(owner) ? 0 : owner->children[index.row()]->count);
+}
+
+QModelIndex QtTreeProxyModel::mapToSource(const QModelIndex &proxyIndex) const
+{
+    Q_D(const QtTreeProxyModel);
+    if (!proxyIndex.isValid() || !d->model)
+        return QModelIndex();
+
+    const Node* owner = reinterpret_cast<const Node*>(proxyIndex.internalId());
+    if (!d->isLeaf(owner))
+        return QModelIndex(); // group item
+
+    const int row = d->sourceRow(owner, proxyIndex.row());
+    return (row == -1 ? QModelIndex() : d->model->index(row, proxyIndex.column()));
 }
 
 QModelIndex QtTreeProxyModel::index(int row, int column, const QModelIndex &parent) const
 {
+    Q_D(const QtTreeProxyModel);
+    if (!hasIndex(row, column, parent))
+        return QModelIndex();
+
     // Here is a tricky part:
-    // - if we have a parent set internal id to it row
-    // - otherwise set internal id to -1 sentinel
-    // It's important that the -1 sentinel allows to
-    // distinguish child/parent items
-    if (parent.isValid())
-        return createIndex(row, column, quintptr(parent.row()));
-    else
-        return createIndex(row, column, quintptr(-1));
+    // internal id of every item is the group that owns it
+    // (root for top-level groups). Group pointer stays valid
+    // when groups before it are inserted or removed
+    if (!parent.isValid())
+        return createIndex(row, column, d->root.get());
+
+    const Node* owner = reinterpret_cast<const Node*>(parent.internalId());
+    if (d->isLeaf(owner))
+        return QModelIndex(); // source row items have no children
+    return createIndex(row, column, owner->children[parent.row()]);
 }
 
 QModelIndex QtTreeProxyModel::parent(const QModelIndex &child) const
 {
+    Q_D(const QtTreeProxyModel);
     if (!child.isValid())
         return QModelIndex();
 
     // Here is a tricky part:
-    // - if internal id equals -1 then the child is top level item: return the invalid model index
-    // - if internal id is something other than -1 than the child is some child so we need to set
-    // column of parent to 0 when creating the parent index, to escape selection issues
-
-    if (child.internalId() == -1)
+    // - if the owner is root then the child is top level item: return the invalid model index
+    // - otherwise we need to set column of parent to 0 when creating
+    // the parent index, to escape selection issues
+    const Node* owner = reinterpret_cast<const Node*>(child.internalId());
+    if (owner == d->root.get())
         return QModelIndex();
     else
-        return createIndex(child.internalId(), 0, quintptr(-1));
+        return createIndex(owner->pos, 0, owner->parent);
 }
 
 int QtTreeProxyModel::rowCount(const QModelIndex &parent) const
 {
     Q_D(const QtTreeProxyModel);
-    if (parent.isValid())
-        return (parent.internalId() == -1 ? d->groups[parent.row()].childCount : 0);
-    else
-        return d->groups.size();
+    if (!parent.isValid())
+        return static_cast<int>(d->root->children.size());
+
+    const Node* owner = reinterpret_cast<const Node*>(parent.internalId());
+    if (d->isLeaf(owner))
+        return 0; // source row item
+    if (parent.row() >= static_cast<int>(owner->children.size()))
+        return 0;
+
+    const Node* node = owner->children[parent.row()];
+    return (d->isLeaf(node) ? node->count : static_cast<int>(node->children.size()));
 }
 
 int QtTreeProxyModel::columnCount(const QModelIndex &parent) const
@@ -193,25 +999,27 @@ QVariant QtTreeProxyModel::data(const QModelIndex &proxyIndex, int role) const
     if (!proxyIndex.isValid() || !d->model)
         return QVariant();
 
-    const int id = proxyIndex.internalId();
+    const Node* owner = reinterpret_cast<const Node*>(proxyIndex.internalId());
     const int r = proxyIndex.row();
     const int c = proxyIndex.column();
-    if (id == -1) // top-level item
+    if (!d->isLeaf(owner)) // group item
     {
-        if (c != d->groupColumn)
+        if (r >= static_cast<int>(owner->children.size()))
+            return QVariant();
+        const Node* node = owner->children[r];
+        if (role == GroupSizeRole)
+            return node->count;
+
+        if (c != d->levels[node->level - 1].first)
             return QVariant();
 
         if (role != Qt::DisplayRole)
             return QVariant();
 
-        return d->groups[r].key;
+        return node->key;
     }
 
-    const QModelIndex parent = proxyIndex.parent();
-    if (!parent.isValid())
-        return QVariant();
-
-    const int row = d->sourceRowForGroup(d->groups[parent.row()].key, r);
+    const int row = d->sourceRow(owner, r);
     if (row == -1)
         return QVariant();
     else
@@ -227,72 +1035,114 @@ QVariant QtTreeProxyModel::headerData(int section, Qt::Orientation orientation,
         return QAbstractItemModel::headerData(section, orientation, role);
 }
 
-void QtTreeProxyModel::onSourceRowsInserted(const QModelIndex &parent, int first, int last)
+void QtTreeProxyModel::onSourceRowsAboutToBeInserted(const QModelIndex &parent, int, int)
 {
     Q_D(QtTreeProxyModel);
-    if (!d->model)
+    if (parent.isValid() || !d->isIncremental())
         return;
 
-    // populate groups from source model
-    for (int i = first; i <= last; ++i)
-    {
-        QVariant value = d->model->index(i, d->groupColumn).data(d->groupRole);
-        auto it = std::find(d->groups.begin(), d->groups.end(), value);
-        if (it == d->groups.end())
-            d->groups.emplace_back(value);
-        else
-            ++it->childCount;
-    }
+    d->flushPending(); // pending rows are not yet shifted
 }
 
-void QtTreeProxyModel::onSourceRowsRemoved(const QModelIndex &parent, int first, int last)
+void QtTreeProxyModel::onSourceRowsInserted(const QModelIndex &parent, int first, int last)
 {
     Q_D(QtTreeProxyModel);
+    if (parent.isValid())
+        return; // only flat source models are supported
 
-    // populate groups from source model
-    for (int i = first; i <= last; ++i)
-    {
-        QVariant value = d->model->index(i, d->groupColumn).data(d->groupRole);
-        auto it = std::find(d->groups.begin(), d->groups.end(), value);
-        if (it != d->groups.end())
-            --it->childCount;
+    if (d->isIncremental())
+        d->insertRows(first, last);
+    else
+        onSourceReset();
+}
 
-        if (it->childCount == 0)
-            d->groups.erase(it);
-    }
+void QtTreeProxyModel::onSourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+{
+    Q_D(QtTreeProxyModel);
+    if (parent.isValid() || !d->isIncremental())
+        return;
+
+    // remove children while source rows are still accessible
+    d->flushPending();
+    d->removeRows(first, last);
 }
 
-void QtTreeProxyModel::onSourceDataChanged(const QModelIndex &, const QModelIndex &, const QVector<int> &roles)
+void QtTreeProxyModel::onSourceRowsRemoved(const QModelIndex &parent, int first, int last)
 {
     Q_D(QtTreeProxyModel);
-    if (std::find(roles.begin(), roles.end(), d->groupRole))
-        onSourceReset(); // update all groups
+    if (parent.isValid())
+        return; // only flat source models are supported
+
+    if (d->isIncremental())
+        d->shiftRows(first, last);
+    else
+        onSourceReset();
 }
 
-void QtTreeProxyModel::onSourceReset()
+void QtTreeProxyModel::onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles)
 {
     Q_D(QtTreeProxyModel);
-    d->groups.clear();
+    if (!d->model || topLeft.parent().isValid())
+        return;
 
-    if (!d->model)
+    bool keyChanged = false;
+    for (auto it = d->levels.cbegin(); it != d->levels.cend() && !keyChanged; ++it) {
+        keyChanged = (topLeft.column() <= it->first && bottomRight.column() >= it->first &&
+                      (roles.isEmpty() || roles.contains(it->second)));
+    }
+    if (keyChanged && !d->isIncremental()) {
+        onSourceReset(); // update all groups
         return;
+    }
 
-    // populate groups from source model
-    for (int i = 0; i < d->model->rowCount(); ++i)
+    // forward change as one range per group
+    d->mapRows();
+    std::unordered_map<Node*, std::pair<int, int>> spans;
+    const int top = topLeft.row(), bottom = bottomRight.row();
+    for (int i = top; i <= bottom; ++i)
     {
-        QVariant value = sourceModel()->index(i, d->groupColumn).data(d->groupRole);
-        auto it = std::find(d->groups.begin(), d->groups.end(), value);
-        if (it == d->groups.end())
-            d->groups.emplace_back(value);
+        Node* leaf = d->rowLeaves[i];
+        if (!leaf)
+            continue;
+        const int pos = leaf->indexOf(i);
+        auto it = spans.find(leaf);
+        if (it == spans.end())
+            spans.emplace(leaf, std::make_pair(pos, pos));
         else
-            ++it->childCount;
+            it->second.second = pos; // rows are visited in ascending order
+    }
+    for (auto it = spans.begin(); it != spans.end(); ++it) {
+        Q_EMIT dataChanged(createIndex(it->second.first, topLeft.column(), it->first),
+                           createIndex(it->second.second, bottomRight.column(), it->first), roles);
     }
+
+    if (keyChanged) {
+        // coalesce key changes until control returns to event loop
+        for (int i = top; i <= bottom; ++i)
+            d->pending.push_back(i);
+        d->scheduleFlush();
+    }
+}
+
+void QtTreeProxyModel::onSourceLayoutChanged()
+{
+    onSourceReset();
+}
+
+void QtTreeProxyModel::onSourceReset()
+{
+    Q_D(QtTreeProxyModel);
+    // build new groups aside, then swap them in with single reset
+    Grouping grouping = d->build();
+    beginResetModel();
+    d->apply(grouping);
+    endResetModel();
 }
 
 void QtTreeProxyModel::onSourceDestroyed()
 {
     Q_D(QtTreeProxyModel);
     beginResetModel();
-    d->groups.clear();
+    d->clear();
     endResetModel();
 }
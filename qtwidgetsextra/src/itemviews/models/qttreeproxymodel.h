@@ -2,6 +2,8 @@
 #define QTTREEPROXYMODEL_H
 
 #include <QAbstractItemModel>
+#include <QVector>
+#include <QPair>
 #include <QtWidgetsExtra>
 
 class QTWIDGETSEXTRA_EXPORT QtTreeProxyModel : public QAbstractItemModel
@@ -9,12 +11,28 @@ class QTWIDGETSEXTRA_EXPORT QtTreeProxyModel : public QAbstractItemModel
     Q_OBJECT
     Q_PROPERTY(int groupColumn READ groupColumn WRITE setGroupColumn NOTIFY groupColumnChanged)
     Q_PROPERTY(int groupNameRole READ groupNameRole WRITE setGroupNameRole NOTIFY groupNameRoleChanged)
+    Q_PROPERTY(int parallelThreshold READ parallelThreshold WRITE setParallelThreshold)
 
 public:
+    /*!
+     * \brief Grouping level as (column, role) pair
+     */
+    typedef QPair<int, int> GroupLevel;
+
+    enum
+    {
+        GroupSizeRole = Qt::UserRole + 1 //!< number of source rows in group (int)
+    };
+
+    /*!
+     * \brief The CachingPolicy enum
+     *
+     * Controls lifetime of the group-to-source row maps.
+     */
     enum class CachingPolicy
     {
-        NoCaching,
-        CacheIndexes
+        NoCaching,   //!< row maps are built lazily on first access and dropped on every source change
+        CacheIndexes //!< row maps are built together with groups and updated incrementally
     };
 
     explicit QtTreeProxyModel(QObject* parent = Q_NULLPTR);
@@ -25,12 +43,36 @@ public:
 
     void setGroupping(int column, int role);
 
+    /*!
+     * \brief Set nested grouping levels.
+     * First level forms top-level groups, every next
+     * level splits groups of the previous one, e.g.
+     * region -> desk -> instrument.
+     */
+    void setGroupLevels(const QVector<GroupLevel>& levels);
+    QVector<GroupLevel> groupLevels() const;
+
     void setGroupColumn(int column);
     int groupColumn() const;
 
     void setGroupNameRole(int role);
     int groupNameRole() const;
 
+    void setCachingPolicy(CachingPolicy policy);
+    CachingPolicy cachingPolicy() const;
+
+    /*!
+     * \brief Set minimal source row count for parallel grouping.
+     * Full regrouping of larger models snapshots group keys
+     * and builds groups on worker threads; 0 disables it.
+     */
+    void setParallelThreshold(int rowCount);
+    int parallelThreshold() const;
+
+    int groupSize(const QModelIndex& index) const;
+
+    QModelIndex mapToSource(const QModelIndex& proxyIndex) const;
+
     // QAbstractItemModel interface
 public:
     QModelIndex index(int row, int column, const QModelIndex &parent) const Q_DECL_OVERRIDE;
@@ -41,8 +83,11 @@ public:
     QVariant headerData(int section, Qt::Orientation orientation, int role) const Q_DECL_OVERRIDE;
 
 private Q_SLOTS:
+    void onSourceRowsAboutToBeInserted(const QModelIndex &parent, int first, int last);
     void onSourceRowsInserted(const QModelIndex &parent, int first, int last);
+    void onSourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
     void onSourceRowsRemoved(const QModelIndex &parent, int first, int last);
+    void onSourceLayoutChanged();
     void onSourceDataChanged(const QModelIndex &, const QModelIndex &, const QVector<int> &roles);
     void onSourceReset();
     void onSourceDestroyed();
@@ -1,4 +1,7 @@
 #include "qtmessagelogmodel.h"
+#include <QTimer>
+#include <algorithm>
+#include <atomic>
 #include <vector>
 
 struct LogRecord
@@ -19,28 +22,127 @@ struct LogRecord
 };
 
 
+//
+// Intrusive multiple-producers single-consumer queue
+// (D. Vyukov): push() is wait-free and may be called
+// from any thread, pop() is called from model thread only
+//
+struct LogNode
+{
+    std::atomic<LogNode*> next;
+    LogRecord record;
+
+    LogNode() : next(Q_NULLPTR) {}
+    explicit LogNode(LogRecord&& r) : next(Q_NULLPTR), record(std::move(r)) {}
+};
+
+class LogQueue
+{
+public:
+    LogQueue() : head(&stub), tail(&stub) {}
+
+    ~LogQueue()
+    {
+        while (LogNode* node = pop())
+            delete node;
+    }
+
+    void push(LogNode* node)
+    {
+        node->next.store(Q_NULLPTR, std::memory_order_relaxed);
+        LogNode* prev = head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    // returns Q_NULLPTR if queue is empty or next node is
+    // being pushed right now; caller owns returned node
+    LogNode* pop()
+    {
+        LogNode* t = tail;
+        LogNode* next = t->next.load(std::memory_order_acquire);
+        if (t == &stub) {
+            if (next == Q_NULLPTR)
+                return Q_NULLPTR;
+            tail = next;
+            t = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+
+        if (next != Q_NULLPTR) {
+            tail = next;
+            return t;
+        }
+
+        if (t != head.load(std::memory_order_acquire))
+            return Q_NULLPTR; // producer is between exchange and link
+
+        push(&stub);
+        next = t->next.load(std::memory_order_acquire);
+        if (next != Q_NULLPTR) {
+            tail = next;
+            return t;
+        }
+        return Q_NULLPTR;
+    }
+
+private:
+    std::atomic<LogNode*> head; // producers side
+    LogNode* tail;              // consumer side
+    LogNode stub;
+};
+
+
 
 class QtMessageLogModelPrivate
 {
 public:
-    std::vector<LogRecord> recordCache;
-    int current;
+    LogQueue queue;
+    std::atomic<bool> drainScheduled;
+    QTimer* drainTimer;
+
+    // ring buffer: row 0 is at records[first]
+    std::vector<LogRecord> records;
+    int first;
+    int count;
     int maxSize;
 
-    QtMessageLogModelPrivate(int size) : current(0), maxSize(size) {
-        recordCache.reserve(size);
+    QtMessageLogModelPrivate(int size) :
+        drainScheduled(false), drainTimer(Q_NULLPTR), first(0), count(0), maxSize(qMax(1, size)) {
+    }
+
+    inline const LogRecord& record(int row) const {
+        return records[(first + row) % records.size()];
     }
 
+    void append(LogRecord&& r);
+
     bool validate(const QModelIndex& index) const;
     QVariant display(int row, int column) const;
     QVariant value(int row, int column) const;
     QVariant tooltip(int row, int column) const;
 };
 
+void QtMessageLogModelPrivate::append(LogRecord &&r)
+{
+    const int size = static_cast<int>(records.size());
+    if (count < size) {
+        // reuse slot of rotated record
+        records[(first + count) % size] = std::move(r);
+    } else {
+        // grow: ring must be linear to append
+        if (first != 0) {
+            std::rotate(records.begin(), records.begin() + first, records.end());
+            first = 0;
+        }
+        records.push_back(std::move(r));
+    }
+    ++count;
+}
+
 bool QtMessageLogModelPrivate::validate(const QModelIndex &index) const
 {
     int row = index.row();
-    if (row < 0 || row >= (int)recordCache.size())
+    if (row < 0 || row >= count)
         return false;
 
     int column = index.column();
@@ -51,7 +153,7 @@ bool QtMessageLogModelPrivate::validate(const QModelIndex &index) const
 
 QVariant QtMessageLogModelPrivate::display(int row, int column) const
 {
-    const LogRecord& r = recordCache[row];
+    const LogRecord& r = record(row);
     switch(column)
     {
     case QtMessageLogModel::SectionLevel:
@@ -81,13 +183,18 @@ QVariant QtMessageLogModelPrivate::tooltip(int row, int column) const
 
 
 QtMessageLogModel::QtMessageLogModel(QObject *parent) :
-    QAbstractTableModel(parent), d_ptr(new QtMessageLogModelPrivate(2048))
+    QtMessageLogModel(2048, parent)
 {
 }
 
 QtMessageLogModel::QtMessageLogModel(uint maxSize, QObject *parent):
     QAbstractTableModel(parent), d_ptr(new QtMessageLogModelPrivate(maxSize))
 {
+    Q_D(QtMessageLogModel);
+    d->drainTimer = new QTimer(this);
+    d->drainTimer->setSingleShot(true);
+    d->drainTimer->setInterval(40);
+    connect(d->drainTimer, &QTimer::timeout, this, &QtMessageLogModel::flush);
 }
 
 QtMessageLogModel::~QtMessageLogModel()
@@ -124,7 +231,7 @@ int QtMessageLogModel::rowCount(const QModelIndex &parent) const
         return 0;
 
     Q_D(const QtMessageLogModel);
-    return d->recordCache.size();
+    return d->count;
 }
 
 int QtMessageLogModel::columnCount(const QModelIndex &parent) const
@@ -165,7 +272,7 @@ QVariant QtMessageLogModel::data(const QModelIndex &index, int role) const
 void QtMessageLogModel::setRotationLimit(uint limit)
 {
     Q_D(QtMessageLogModel);
-    if (limit > 0 && limit > (uint)d->recordCache.size()) {
+    if (limit > 0 && limit > (uint)d->count) {
         d->maxSize = limit;
     }
 }
@@ -176,40 +283,83 @@ uint QtMessageLogModel::rotationLimit() const
     return d->maxSize;
 }
 
+void QtMessageLogModel::setDrainInterval(int msec)
+{
+    Q_D(QtMessageLogModel);
+    d->drainTimer->setInterval(qMax(0, msec));
+}
+
+int QtMessageLogModel::drainInterval() const
+{
+    Q_D(const QtMessageLogModel);
+    return d->drainTimer->interval();
+}
+
+// Thread-safe: message is queued and inserted into the
+// model on next drain in the model thread
 void QtMessageLogModel::message(int level, int code, const QString& category, const QString& message, const QDateTime& timestamp)
 {
     Q_D(QtMessageLogModel);
-    static const QModelIndex invalid;
-
-    if (d->current < (int)d->recordCache.size()) {
-        LogRecord& r = d->recordCache[d->current];
-        r.level = level;
-        r.code = code;
-        r.category = category;
-        r.message = message;
-        r.timestamp = timestamp;
-        Q_EMIT dataChanged(index(d->current, 0), index(d->current, MaxSection-1));
-        ++d->current;
-    }
-    else {
-        beginInsertRows(invalid, d->current, d->current);
-        d->recordCache.emplace_back(level, code, category, message, timestamp);
-        endInsertRows();
-        d->current = d->recordCache.size();
-    }
-
-    if (d->current >= d->maxSize) {
-        d->current = 0;
-        Q_EMIT overflowed();
+    d->queue.push(new LogNode(LogRecord(level, code, category, message, timestamp)));
+
+    // first message of batch starts drain timer in model thread
+    if (!d->drainScheduled.exchange(true, std::memory_order_acq_rel)) {
+        QMetaObject::invokeMethod(d->drainTimer, "start", Qt::QueuedConnection);
     }
 }
 
+// Moves queued messages into the model
+void QtMessageLogModel::flush()
+{
+    Q_D(QtMessageLogModel);
+    // reset before draining: messages queued from now on schedule next
+    // drain; RMW acquires links pushed by producers that saw the flag set
+    d->drainScheduled.exchange(false, std::memory_order_acq_rel);
+    d->drainTimer->stop();
+
+    std::vector<LogRecord> batch;
+    while (LogNode* node = d->queue.pop()) {
+        batch.push_back(std::move(node->record));
+        delete node;
+    }
+    if (batch.empty())
+        return;
+
+    // messages that would be rotated out within batch are dropped
+    if (static_cast<int>(batch.size()) > d->maxSize)
+        batch.erase(batch.begin(), batch.end() - d->maxSize);
+
+    const int n = static_cast<int>(batch.size());
+    const int removed = qMax(0, d->count + n - d->maxSize);
+    if (removed > 0) {
+        beginRemoveRows(QModelIndex(), 0, removed - 1);
+        d->first = (d->first + removed) % static_cast<int>(d->records.size());
+        d->count -= removed;
+        endRemoveRows();
+    }
+
+    beginInsertRows(QModelIndex(), d->count, d->count + n - 1);
+    for (auto it = batch.begin(); it != batch.end(); ++it)
+        d->append(std::move(*it));
+    endInsertRows();
+
+    if (removed > 0)
+        Q_EMIT overflowed();
+}
+
 void QtMessageLogModel::clear()
 {
     Q_D(QtMessageLogModel);
+    // drop queued messages too
+    d->drainScheduled.store(false, std::memory_order_release);
+    d->drainTimer->stop();
+    while (LogNode* node = d->queue.pop())
+        delete node;
+
     beginResetModel();
-    d->recordCache.clear();
-    d->current = 0;
+    d->records.clear();
+    d->first = 0;
+    d->count = 0;
     endResetModel();
 }
 
@@ -6,6 +6,17 @@
 
 #include <QtWidgetsExtra>
 
+/*!
+ * \brief The QtMessageLogModel class
+ *
+ * Table model of log messages. message() may be called
+ * from any thread and never blocks: messages are posted
+ * to lock-free queue and moved into the model by timer
+ * on the model thread, every drainInterval() ms. Each
+ * batch is inserted as one range of rows at the bottom;
+ * when rotationLimit() is reached, the oldest messages
+ * are removed as one range from the top.
+ */
 class QTWIDGETSEXTRA_EXPORT QtMessageLogModel : public QAbstractTableModel
 {
     Q_OBJECT
@@ -37,6 +48,9 @@ public:
     void setRotationLimit(uint limit);
     uint rotationLimit() const;
 
+    void setDrainInterval(int msec);
+    int drainInterval() const;
+
     void message(int level, int code, const QString& category, const QString& message, const QDateTime& timestamp = QDateTime::currentDateTime());
 
     inline void message(int level, int code, const QString &category, const QString &message) {
@@ -45,6 +59,7 @@ public:
 
 public Q_SLOTS:
     void clear();
+    void flush();
 
 Q_SIGNALS:
     void overflowed();